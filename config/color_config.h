@@ -21,10 +21,17 @@
 #define ROCK_COLOR_BASE_A 255
 #define ROCK_COLOR_VARIATION 6
 
+#define WATER_COLOR_BASE_R 40
+#define WATER_COLOR_BASE_G 110
+#define WATER_COLOR_BASE_B 220
+#define WATER_COLOR_BASE_A 255
+#define WATER_COLOR_VARIATION 8
+
 #define BASE_COLOR(TYPE) (SDL_Color){TYPE##_COLOR_BASE_R, TYPE##_COLOR_BASE_G, TYPE##_COLOR_BASE_B, TYPE##_COLOR_BASE_A}
 
 #define EMPTY_BASE_COLOR BASE_COLOR(EMPTY)
 #define SAND_BASE_COLOR BASE_COLOR(SAND)
 #define ROCK_BASE_COLOR BASE_COLOR(ROCK)
+#define WATER_BASE_COLOR BASE_COLOR(WATER)
 
 #endif
\ No newline at end of file
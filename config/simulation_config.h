@@ -5,14 +5,32 @@
 
 /* PARTICLE */
 #define PARTICLE_SIZE 5
+#define WATER_DISPERSION 8 /* cells water can flow sideways in one tick, at most MATERIAL_MAX_DISPERSION */
 
 /* GRID */
 #define GRID_WIDTH (DISPLAY_WIDTH / PARTICLE_SIZE)
 #define GRID_HEIGHT (DISPLAY_HEIGHT / PARTICLE_SIZE)
 
+#define GRID_ALIGNMENT 64 /* cache line; plane rows and planes start on it */
+
+/* CHUNK */
+#define GRID_CHUNK_SIZE 32
+
 /* SIMULATION */
 #define SIMULATION_TICKS_PER_SECOND 60
 #define SIMULATION_TICK_RATE (1.0 / SIMULATION_TICKS_PER_SECOND)
+#define SIMULATION_WORKER_THREADS 0 /* 0 keeps the serial scan, otherwise extra threads for the checkerboard update */
+#define SIMULATION_MAX_TICKS_PER_FRAME 4 /* catch-up ticks run back to back at most */
+#define SIMULATION_FRAME_BUDGET 0.012 /* seconds of stepping before a frame stops starting ticks */
+#define SIMULATION_MAX_BACKLOG_TICKS 30 /* owed ticks kept for later frames; older ones are dropped */
+#define SIMULATION_COMMAND_QUEUE_SIZE 256 /* power of two; brush and reset commands waiting for the simulation thread */
+
+/* HISTORY */
+#define HISTORY_MEMORY_BUDGET (64 * 1024 * 1024) /* bytes of saved chunks undo and redo may keep */
+#define HISTORY_MAX_ENTRIES 100
+
+/* WORKERS */
+#define WORKERS_MAX_THREADS 64
 
 /* BRUSH */
 #define DEFAULT_BRUSH_RADIUS 2
@@ -1,6 +1,5 @@
 #include <SDL3/SDL.h>
 
-#include "config/simulation_config.h"
 #include "display/display.h"
 
 static void display_destroy_resources(Display* display) {
@@ -26,6 +25,8 @@ bool display_initialize(Display* display, const DisplayConfig* config) {
     const char *title = config->title;
     int width = config->width;
     int height = config->height;
+    int texture_width = config->texture_width;
+    int texture_height = config->texture_height;
     SDL_WindowFlags window_flags = config->window_flags;
     SDL_InitFlags init_flags = config->init_flags;
     SDL_RendererLogicalPresentation presentation = config->presentation;
@@ -44,7 +45,7 @@ bool display_initialize(Display* display, const DisplayConfig* config) {
     }
 
     display->texture = SDL_CreateTexture(display->renderer, SDL_PIXELFORMAT_RGBA32,
-                                         SDL_TEXTUREACCESS_STREAMING, GRID_WIDTH, GRID_HEIGHT);
+                                         SDL_TEXTUREACCESS_STREAMING, texture_width, texture_height);
 
     if (!display->texture)
         goto failed;
@@ -8,6 +8,8 @@ typedef struct display_config {
     const char* title;
     int width;
     int height;
+    int texture_width;
+    int texture_height;
     SDL_WindowFlags window_flags;
     SDL_InitFlags init_flags;
     SDL_RendererLogicalPresentation presentation;
@@ -1,230 +1,1668 @@
 #include <SDL3/SDL.h>
 #include <stdbool.h>
 
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define GRID_USE_SSE2
+#endif
+
 #include "config/color_config.h"
 #include "config/simulation_config.h"
 #include "particle/particle.h"
 #include "grid/grid.h"
 
-bool grid_initialize(Grid* grid) { 
+static GridRect grid_chunk_bounds(const Grid* grid, int chunk_x, int chunk_y) {
+    return (GridRect){
+        chunk_x * GRID_CHUNK_SIZE,
+        chunk_y * GRID_CHUNK_SIZE,
+        SDL_min((chunk_x + 1) * GRID_CHUNK_SIZE, grid->width) - 1,
+        SDL_min((chunk_y + 1) * GRID_CHUNK_SIZE, grid->height) - 1
+    };
+}
+
+static void grid_reset_chunks(Grid* grid) {
+    for (int cy = 0; cy < grid->chunks_y; cy++) {
+        for (int cx = 0; cx < grid->chunks_x; cx++) {
+            GridRect bounds = grid_chunk_bounds(grid, cx, cy);
+            GridChunk* chunk = grid_chunk_at(grid, cx, cy);
+            *chunk = (GridChunk){.dirty = bounds, .next_dirty = bounds, .last_dirty = bounds, .active = true};
+            chunk->counts[EMPTY] = (Uint16)((bounds.max_x - bounds.min_x + 1) * (bounds.max_y - bounds.min_y + 1));
+            grid->paint[cy * grid->chunks_x + cx] = bounds;
+        }
+    }
+
+    SDL_memset(grid->counts, 0, sizeof(grid->counts));
+    grid->counts[EMPTY] = grid->width * grid->height;
+}
+
+/* Marks the region for the next tick and for painting, and for the rest of this tick when `now`. */
+static void grid_wake(Grid* grid, GridRect region, bool now) {
+    region = grid_rect_intersect(region, (GridRect){0, 0, grid->width - 1, grid->height - 1});
+    if (grid_rect_is_empty(region))
+        return;
+
+    for (int cy = region.min_y / GRID_CHUNK_SIZE; cy <= region.max_y / GRID_CHUNK_SIZE; cy++) {
+        for (int cx = region.min_x / GRID_CHUNK_SIZE; cx <= region.max_x / GRID_CHUNK_SIZE; cx++) {
+            GridChunk* chunk = grid_chunk_at(grid, cx, cy);
+            GridRect area = grid_rect_intersect(region, grid_chunk_bounds(grid, cx, cy));
+
+            SDL_LockSpinlock(&chunk->lock);
+            if (now) {
+                grid_rect_extend(&chunk->dirty, area);
+                chunk->active = true;
+            }
+            grid_rect_extend(&chunk->next_dirty, area);
+            grid_rect_extend(&grid->paint[cy * grid->chunks_x + cx], area);
+            SDL_UnlockSpinlock(&chunk->lock);
+        }
+    }
+}
+
+void grid_wake_region(Grid* grid, GridRect region) {
+    if (!grid)
+        return;
+
+    grid_wake(grid, region, true);
+}
+
+static GridRect grid_neighborhood(Coordinates a, Coordinates b) {
+    return (GridRect){SDL_min(a.x, b.x) - 1, SDL_min(a.y, b.y) - 1, SDL_max(a.x, b.x) + 1, SDL_max(a.y, b.y) + 1};
+}
+
+static void grid_wake_neighborhood(Grid* grid, Coordinates a, Coordinates b) {
+    grid_wake_region(grid, grid_neighborhood(a, b));
+}
+
+void grid_set_seed(Grid* grid, Uint64 seed) {
+    if (!grid)
+        return;
+
+    grid->seed = seed;
+    random_seed(&grid->random, seed);
+}
+
+bool grid_is_chunk_active(Grid* grid, Coordinates coordinates) {
+    if (!grid || !grid_is_in_bounds(grid, coordinates))
+        return false;
+    return grid_chunk_at(grid, coordinates.x / GRID_CHUNK_SIZE, coordinates.y / GRID_CHUNK_SIZE)->active;
+}
+
+/* EMPTY is the only empty id, so comparing against it matches the MATERIAL_EMPTY flag */
+_Static_assert(EMPTY == 0 && PARTICLE_FIRST_MOVING > EMPTY, "the row kernel expects one empty id, first");
+_Static_assert(PARTICLE_LAST_SOLID == PARTICLE_FIRST_MOVING - 1, "every id between empty and the movers is solid");
+_Static_assert(PARTICLE_FIRST_MOVING <= PARTICLE_LAST_POWDER && PARTICLE_LAST_POWDER < PARTICLE_TYPE_COUNT,
+               "powders must be a range of the moving ids");
+_Static_assert(PARTICLE_LAST_POWDER < PARTICLE_FIRST_LIQUID && PARTICLE_FIRST_LIQUID <= PARTICLE_LAST_LIQUID &&
+               PARTICLE_LAST_LIQUID < PARTICLE_TYPE_COUNT, "liquids must be a range of the moving ids after powders");
+
+#if defined(__AVX2__)
+/* 0xFF lanes where first <= byte <= last, as one unsigned compare of byte - first. */
+static inline __m256i grid_in_range_256(__m256i bytes, Uint8 first, Uint8 last) {
+    __m256i offset = _mm256_sub_epi8(bytes, _mm256_set1_epi8((char)first));
+    return _mm256_cmpeq_epi8(_mm256_min_epu8(offset, _mm256_set1_epi8((char)(last - first))), offset);
+}
+
+/* 0xFF lanes holding an empty or liquid id. */
+static inline __m256i grid_open_256(const Uint8* types) {
+    __m256i bytes = _mm256_loadu_si256((const __m256i*)types);
+    return _mm256_or_si256(_mm256_cmpeq_epi8(bytes, _mm256_set1_epi8(EMPTY)),
+                           grid_in_range_256(bytes, PARTICLE_FIRST_LIQUID, PARTICLE_LAST_LIQUID));
+}
+#elif defined(GRID_USE_SSE2)
+static inline __m128i grid_in_range_128(__m128i bytes, Uint8 first, Uint8 last) {
+    __m128i offset = _mm_sub_epi8(bytes, _mm_set1_epi8((char)first));
+    return _mm_cmpeq_epi8(_mm_min_epu8(offset, _mm_set1_epi8((char)(last - first))), offset);
+}
+
+static inline __m128i grid_open_128(const Uint8* types) {
+    __m128i bytes = _mm_loadu_si128((const __m128i*)types);
+    return _mm_or_si128(_mm_cmpeq_epi8(bytes, _mm_set1_epi8(EMPTY)),
+                        grid_in_range_128(bytes, PARTICLE_FIRST_LIQUID, PARTICLE_LAST_LIQUID));
+}
+#endif
+
+/* Cells per row block; one bit each in a Uint32 mask. */
+#define GRID_ROW_BLOCK 32
+_Static_assert(GRID_ROW_BLOCK <= GRID_ALIGNMENT, "row block loads must stay inside the plane padding");
+
+/*
+ * The first `count` of `size` bytes from `bytes`: `bytes` itself when all are
+ * wanted, otherwise a copy in `block` with border bytes after them. Chunks next
+ * door may be writing the cells past a chunk's own, so a short block is never
+ * loaded straight from the plane, masked or not.
+ */
+static const Uint8* grid_row_block(const Uint8* bytes, int count, Uint8* block, int size) {
+    if (count >= size)
+        return bytes;
+
+    SDL_memcpy(block, bytes, (size_t)count);
+    SDL_memset(block + count, GRID_BORDER_TYPE, (size_t)(size - count));
+    return block;
+}
+
+/* Bit i set when first <= bytes[i] <= last, for the first `count` cells of a row block of any byte plane. */
+static Uint32 grid_row_in_range(const Uint8* bytes, int count, Uint8 first, Uint8 last) {
+    Uint8 block[GRID_ROW_BLOCK];
+    bytes = grid_row_block(bytes, count, block, GRID_ROW_BLOCK);
+    Uint32 in_block = count < GRID_ROW_BLOCK ? (1u << count) - 1 : ~0u;
+#if defined(__AVX2__)
+    __m256i cells = _mm256_loadu_si256((const __m256i*)bytes);
+    return (Uint32)_mm256_movemask_epi8(grid_in_range_256(cells, first, last)) & in_block;
+#elif defined(GRID_USE_SSE2)
+    Uint32 bits = 0;
+    for (int offset = 0; offset < GRID_ROW_BLOCK; offset += 16) {
+        __m128i cells = _mm_loadu_si128((const __m128i*)(bytes + offset));
+        bits |= (Uint32)_mm_movemask_epi8(grid_in_range_128(cells, first, last)) << offset;
+    }
+    return bits & in_block;
+#else
+    Uint32 bits = 0;
+    for (int i = 0; i < GRID_ROW_BLOCK; i++)
+        bits |= (Uint32)(bytes[i] >= first && bytes[i] <= last) << i;
+    return bits & in_block;
+#endif
+}
+
+/* Bitboard bits of the 64 cells from `types` on; the border counts as occupied and solid. */
+static void grid_classify_word(const Uint8* types, Uint64* occupied, Uint64* solid) {
+#if defined(__AVX2__)
+    Uint64 empty = 0;
+    Uint64 blocking = 0;
+    for (int offset = 0; offset < 64; offset += 32) {
+        __m256i bytes = _mm256_loadu_si256((const __m256i*)(types + offset));
+        __m256i is_solid = _mm256_or_si256(grid_in_range_256(bytes, EMPTY + 1, PARTICLE_LAST_SOLID),
+                                           _mm256_cmpeq_epi8(bytes, _mm256_set1_epi8((char)GRID_BORDER_TYPE)));
+        empty |= (Uint64)(Uint32)_mm256_movemask_epi8(_mm256_cmpeq_epi8(bytes, _mm256_set1_epi8(EMPTY))) << offset;
+        blocking |= (Uint64)(Uint32)_mm256_movemask_epi8(is_solid) << offset;
+    }
+    *occupied = ~empty;
+    *solid = blocking;
+#elif defined(GRID_USE_SSE2)
+    Uint64 empty = 0;
+    Uint64 blocking = 0;
+    for (int offset = 0; offset < 64; offset += 16) {
+        __m128i bytes = _mm_loadu_si128((const __m128i*)(types + offset));
+        __m128i is_solid = _mm_or_si128(grid_in_range_128(bytes, EMPTY + 1, PARTICLE_LAST_SOLID),
+                                        _mm_cmpeq_epi8(bytes, _mm_set1_epi8((char)GRID_BORDER_TYPE)));
+        empty |= (Uint64)(Uint32)_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_set1_epi8(EMPTY))) << offset;
+        blocking |= (Uint64)(Uint32)_mm_movemask_epi8(is_solid) << offset;
+    }
+    *occupied = ~empty;
+    *solid = blocking;
+#else
+    *occupied = 0;
+    *solid = 0;
+    for (int i = 0; i < 64; i++) {
+        if (types[i] != EMPTY)
+            *occupied |= (Uint64)1 << i;
+        if (types[i] == GRID_BORDER_TYPE || particle_type_has(types[i], MATERIAL_SOLID))
+            *solid |= (Uint64)1 << i;
+    }
+#endif
+}
+
+/* Recomputes whole words, so the cells around a change must already hold their final types. */
+static void grid_sync_words(Grid* grid, int y, int first_word, int last_word) {
+    const Uint8* types = &grid->types[grid_index(grid, 0, y)];
+    Uint64* occupied = grid->occupied + y * grid->bit_stride;
+    Uint64* solid = grid->solid + y * grid->bit_stride;
+    for (int word = first_word; word <= last_word; word++)
+        grid_classify_word(types + 64 * word, &occupied[word], &solid[word]);
+}
+
+void grid_sync_bitboards(Grid* grid, GridRect region) {
+    if (!grid || !grid->arena)
+        return;
+
+    region = grid_rect_intersect(region, (GridRect){0, 0, grid->width - 1, grid->height - 1});
+    if (grid_rect_is_empty(region))
+        return;
+
+    for (int y = region.min_y; y <= region.max_y; y++)
+        grid_sync_words(grid, y, region.min_x / 64, region.max_x / 64);
+}
+
+static int grid_popcount(Uint64 bits) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_popcountll(bits);
+#else
+    bits -= (bits >> 1) & 0x5555555555555555ULL;
+    bits = (bits & 0x3333333333333333ULL) + ((bits >> 2) & 0x3333333333333333ULL);
+    bits = (bits + (bits >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    return (int)((bits * 0x0101010101010101ULL) >> 56);
+#endif
+}
+
+GridCellCounts grid_count_cells(const Grid* grid, GridRect region) {
+    GridCellCounts counts = {0};
+    if (!grid || !grid->arena)
+        return counts;
+
+    region = grid_rect_intersect(region, (GridRect){0, 0, grid->width - 1, grid->height - 1});
+    if (grid_rect_is_empty(region))
+        return counts;
+
+    int first_word = region.min_x / 64;
+    int last_word = region.max_x / 64;
+    Uint64 first_mask = ~(Uint64)0 << (region.min_x % 64);
+    Uint64 last_mask = ~(Uint64)0 >> (63 - region.max_x % 64);
+    for (int y = region.min_y; y <= region.max_y; y++) {
+        const Uint64* occupied = grid_bitboard_row(grid, grid->occupied, y);
+        const Uint64* solid = grid_bitboard_row(grid, grid->solid, y);
+        for (int word = first_word; word <= last_word; word++) {
+            Uint64 mask = ~(Uint64)0;
+            if (word == first_word)
+                mask &= first_mask;
+            if (word == last_word)
+                mask &= last_mask;
+            counts.occupied += grid_popcount(occupied[word] & mask);
+            counts.solid += grid_popcount(solid[word] & mask);
+        }
+    }
+    return counts;
+}
+
+/* Adds the cells of each material in row y from min_x to max_x to `counts`, a row block at a time. */
+static void grid_count_span(const Grid* grid, int y, int min_x, int max_x, int* counts) {
+    const Uint8* types = &grid->types[grid_index(grid, 0, y)];
+    int materials = 0;
+    for (int x = min_x; x <= max_x; x += GRID_ROW_BLOCK) {
+        int count = max_x - x + 1;
+        for (int type = EMPTY + 1; type < PARTICLE_TYPE_COUNT; type++) {
+            int found = grid_popcount(grid_row_in_range(&types[x], count, (Uint8)type, (Uint8)type));
+            counts[type] += found;
+            materials += found;
+        }
+    }
+
+    /* Cells in bounds only ever hold material ids, so the rest are empty */
+    counts[EMPTY] += max_x - min_x + 1 - materials;
+}
+
+/*
+ * Same as grid_count_span over a whole chunk, but with one load per row and the
+ * per-material sums kept in byte lanes, a chunk's height being small enough
+ * that none of them overflows. Loads past the chunk's width only ever reach
+ * padding columns, whose border type matches no material.
+ */
+_Static_assert(GRID_CHUNK_SIZE == GRID_ROW_BLOCK && 2 * GRID_CHUNK_SIZE < 256,
+               "chunk rows must be one row block and per-lane sums must fit a byte");
+
+static void grid_count_chunk(const Grid* grid, GridRect bounds, int* counts) {
+    const Uint8* types = &grid->types[grid_index(grid, bounds.min_x, bounds.min_y)];
+    int rows = bounds.max_y - bounds.min_y + 1;
+    int materials = 0;
+#if defined(__AVX2__)
+    __m256i sums[PARTICLE_TYPE_COUNT];
+    for (int type = EMPTY + 1; type < PARTICLE_TYPE_COUNT; type++)
+        sums[type] = _mm256_setzero_si256();
+    for (int y = 0; y < rows; y++) {
+        __m256i cells = _mm256_loadu_si256((const __m256i*)(types + y * grid->stride));
+        for (int type = EMPTY + 1; type < PARTICLE_TYPE_COUNT; type++)
+            sums[type] = _mm256_sub_epi8(sums[type], _mm256_cmpeq_epi8(cells, _mm256_set1_epi8((char)type)));
+    }
+    for (int type = EMPTY + 1; type < PARTICLE_TYPE_COUNT; type++) {
+        __m256i total = _mm256_sad_epu8(sums[type], _mm256_setzero_si256());
+        counts[type] = (int)(_mm256_extract_epi64(total, 0) + _mm256_extract_epi64(total, 1) +
+                             _mm256_extract_epi64(total, 2) + _mm256_extract_epi64(total, 3));
+        materials += counts[type];
+    }
+#elif defined(GRID_USE_SSE2)
+    __m128i sums[PARTICLE_TYPE_COUNT];
+    for (int type = EMPTY + 1; type < PARTICLE_TYPE_COUNT; type++)
+        sums[type] = _mm_setzero_si128();
+    for (int y = 0; y < rows; y++) {
+        __m128i low = _mm_loadu_si128((const __m128i*)(types + y * grid->stride));
+        __m128i high = _mm_loadu_si128((const __m128i*)(types + y * grid->stride + 16));
+        for (int type = EMPTY + 1; type < PARTICLE_TYPE_COUNT; type++) {
+            __m128i id = _mm_set1_epi8((char)type);
+            sums[type] = _mm_sub_epi8(sums[type], _mm_cmpeq_epi8(low, id));
+            sums[type] = _mm_sub_epi8(sums[type], _mm_cmpeq_epi8(high, id));
+        }
+    }
+    for (int type = EMPTY + 1; type < PARTICLE_TYPE_COUNT; type++) {
+        __m128i total = _mm_sad_epu8(sums[type], _mm_setzero_si128());
+        counts[type] = _mm_cvtsi128_si32(total) + _mm_cvtsi128_si32(_mm_srli_si128(total, 8));
+        materials += counts[type];
+    }
+#else
+    int width = bounds.max_x - bounds.min_x + 1;
+    for (int y = 0; y < rows; y++) {
+        for (int x = 0; x < width; x++) {
+            Uint8 type = types[y * grid->stride + x];
+            if (type != EMPTY) {
+                counts[type]++;
+                materials++;
+            }
+        }
+    }
+#endif
+    counts[EMPTY] = rows * (bounds.max_x - bounds.min_x + 1) - materials;
+}
+
+static void grid_recount_chunk(Grid* grid, int chunk_x, int chunk_y) {
+    GridChunk* chunk = grid_chunk_at(grid, chunk_x, chunk_y);
+    int counts[PARTICLE_TYPE_COUNT] = {0};
+    grid_count_chunk(grid, grid_chunk_bounds(grid, chunk_x, chunk_y), counts);
+
+    for (int type = 0; type < PARTICLE_TYPE_COUNT; type++) {
+        grid->counts[type] += counts[type] - chunk->counts[type];
+        chunk->counts[type] = (Uint16)counts[type];
+    }
+}
+
+/* Moves the cell at (x, y) from `old_type`'s counts to `new_type`'s. */
+static void grid_count_change(Grid* grid, int x, int y, Uint8 old_type, Uint8 new_type) {
+    GridChunk* chunk = grid_chunk_at(grid, x / GRID_CHUNK_SIZE, y / GRID_CHUNK_SIZE);
+    chunk->counts[old_type]--;
+    chunk->counts[new_type]++;
+    grid->counts[old_type]--;
+    grid->counts[new_type]++;
+}
+
+void grid_sync_counts(Grid* grid, GridRect region) {
+    if (!grid || !grid->arena)
+        return;
+
+    region = grid_rect_intersect(region, (GridRect){0, 0, grid->width - 1, grid->height - 1});
+    if (grid_rect_is_empty(region))
+        return;
+
+    for (int cy = region.min_y / GRID_CHUNK_SIZE; cy <= region.max_y / GRID_CHUNK_SIZE; cy++) {
+        for (int cx = region.min_x / GRID_CHUNK_SIZE; cx <= region.max_x / GRID_CHUNK_SIZE; cx++)
+            grid_recount_chunk(grid, cx, cy);
+    }
+}
+
+int grid_get_material_count(const Grid* grid, ParticleType type) {
+    if (!grid || !grid->arena || (unsigned)type >= PARTICLE_TYPE_COUNT)
+        return 0;
+    return grid->counts[type];
+}
+
+GridMaterialCounts grid_count_materials(const Grid* grid, GridRect region) {
+    GridMaterialCounts result = {0};
+    if (!grid || !grid->arena)
+        return result;
+
+    region = grid_rect_intersect(region, (GridRect){0, 0, grid->width - 1, grid->height - 1});
+    if (grid_rect_is_empty(region))
+        return result;
+
+    for (int cy = region.min_y / GRID_CHUNK_SIZE; cy <= region.max_y / GRID_CHUNK_SIZE; cy++) {
+        for (int cx = region.min_x / GRID_CHUNK_SIZE; cx <= region.max_x / GRID_CHUNK_SIZE; cx++) {
+            GridRect bounds = grid_chunk_bounds(grid, cx, cy);
+            GridRect area = grid_rect_intersect(region, bounds);
+            if (SDL_memcmp(&area, &bounds, sizeof(GridRect)) == 0) {
+                const GridChunk* chunk = grid_chunk_at(grid, cx, cy);
+                for (int type = 0; type < PARTICLE_TYPE_COUNT; type++)
+                    result.counts[type] += chunk->counts[type];
+                continue;
+            }
+
+            for (int y = area.min_y; y <= area.max_y; y++)
+                grid_count_span(grid, y, area.min_x, area.max_x, result.counts);
+        }
+    }
+    return result;
+}
+
+static size_t grid_align(size_t size) {
+    return (size + GRID_ALIGNMENT - 1) / GRID_ALIGNMENT * GRID_ALIGNMENT;
+}
+
+/*
+ * A leading aligned block keeps the top-left diagonal neighbor inside the plane,
+ * a trailing one lets the row kernel load a whole block past the bottom row.
+ */
+static size_t grid_plane_cells(size_t stride, int height) {
+    return GRID_ALIGNMENT + ((size_t)height + 2) * stride + GRID_ALIGNMENT;
+}
+
+bool grid_initialize(Grid* grid, int width, int height) { 
     if (!grid) 
         return false;
+
+    *grid = (Grid){0};
+    if (width <= 0 || height <= 0)
+        return false;
+
+    size_t stride = grid_align((size_t)width + 1);
+    size_t lead = GRID_ALIGNMENT;
+    size_t plane_cells = grid_plane_cells(stride, height);
+    if (plane_cells > (size_t)SDL_MAX_SINT32) {
+        SDL_Log("Grid of %dx%d is too large.", width, height);
+        return false;
+    }
+
+    int chunks_x = (width + GRID_CHUNK_SIZE - 1) / GRID_CHUNK_SIZE;
+    int chunks_y = (height + GRID_CHUNK_SIZE - 1) / GRID_CHUNK_SIZE;
+
+    size_t types_offset = 0;
+    size_t colors_offset = types_offset + grid_align(plane_cells);
+    size_t bitboard_words = ((size_t)height + 2) * (stride / 64);
+    size_t moved_words = (size_t)height * (stride / GRID_MOVED_BITS);
+    size_t occupied_offset = colors_offset + grid_align(plane_cells * sizeof(SDL_Color));
+    size_t solid_offset = occupied_offset + grid_align(bitboard_words * sizeof(Uint64));
+    size_t moved_offset = solid_offset + grid_align(bitboard_words * sizeof(Uint64));
+    size_t intents_offset = moved_offset + grid_align(moved_words * sizeof(Uint16));
+    size_t claims_offset = intents_offset + grid_align(plane_cells);
+    size_t chunks_offset = claims_offset + grid_align(plane_cells);
+    size_t paint_offset = chunks_offset + grid_align((size_t)chunks_x * chunks_y * sizeof(GridChunk));
+    size_t stroke_offset = paint_offset + grid_align((size_t)chunks_x * chunks_y * sizeof(GridRect));
+    size_t arena_size = stroke_offset + grid_align((size_t)height * 2 * sizeof(int));
+
+    Uint8* arena = SDL_aligned_alloc(GRID_ALIGNMENT, arena_size);
+    if (!arena) {
+        SDL_Log("Couldn't allocate %zu bytes for a %dx%d grid.", arena_size, width, height);
+        return false;
+    }
+
+    size_t origin = lead + stride; /* must match grid_reset */
+    grid->width = width;
+    grid->height = height;
+    grid->stride = (int)stride;
+    grid->chunks_x = chunks_x;
+    grid->chunks_y = chunks_y;
+    grid->arena = arena;
+    grid->arena_size = arena_size;
+    grid->types = arena + types_offset + origin;
+    grid->colors = (SDL_Color*)(arena + colors_offset) + origin;
+    grid->bit_stride = (int)(stride / 64);
+    grid->occupied = (Uint64*)(arena + occupied_offset) + grid->bit_stride; /* row 0, past the padding row */
+    grid->solid = (Uint64*)(arena + solid_offset) + grid->bit_stride;
+    grid->moved = (Uint16*)(arena + moved_offset);
+    grid->intents = arena + intents_offset + origin;
+    grid->claims = arena + claims_offset + origin;
+    grid->chunks = (GridChunk*)(arena + chunks_offset);
+    grid->paint = (GridRect*)(arena + paint_offset);
+    grid->stroke_rows = (int*)(arena + stroke_offset);
+
+    margolus_build_rules(&grid->margolus);
     
-    if (!grid_reset(grid))
+    if (!grid_reset(grid)) {
+        grid_destroy(grid);
         return false;
+    }
 
+    /* Left dirty by grid_reset, so the first render uploads the whole grid */
     grid->update_left_to_right = true;
-    grid->dirty = false;
-    grid->current_gen = 0;
+    grid->tick_count = 0;
+    grid_set_seed(grid, 0);
 
     return true;
 }
 
+void grid_destroy(Grid* grid) {
+    if (!grid)
+        return;
+
+    if (grid->arena)
+        SDL_aligned_free(grid->arena);
+
+    *grid = (Grid){0};
+}
+
 bool grid_reset(Grid* grid) {
-    if (!grid) 
+    if (!grid || !grid->arena) 
         return false;
 
-    for (int y = 0; y < GRID_HEIGHT; y++) {
-        for (int x = 0; x < GRID_WIDTH; x++) {
-            grid->particles[y][x] = (Particle){.type = EMPTY, .color = EMPTY_BASE_COLOR, .update_gen = 0};
-        }
-    }
+    /* Planes start one aligned lead block and one padding row before cell (0, 0) */
+    int origin = GRID_ALIGNMENT + grid->stride;
+    int plane_cells = (int)grid_plane_cells((size_t)grid->stride, grid->height);
+
+    SDL_memset(grid->types - origin, GRID_BORDER_TYPE, (size_t)plane_cells);
+    SDL_memset(grid->moved, 0, (size_t)grid->height * (size_t)grid->stride / GRID_MOVED_BITS * sizeof(Uint16));
+    SDL_memset(grid->intents - origin, 0, (size_t)plane_cells);
+    SDL_memset(grid->claims - origin, 0, (size_t)plane_cells);
+    for (int i = 0; i < plane_cells; i++)
+        grid->colors[i - origin] = EMPTY_BASE_COLOR;
+
+    for (int y = 0; y < grid->height; y++)
+        SDL_memset(&grid->types[grid_index(grid, 0, y)], EMPTY, (size_t)grid->width);
+
+    /* The only time the padding rows get their bits */
+    for (int y = -1; y <= grid->height; y++)
+        grid_sync_words(grid, y, 0, grid->bit_stride - 1);
 
+    grid_reset_chunks(grid);
     grid->dirty = true;
 
     return true;
 }
 
+/* Per-thread view of a running tick. */
+typedef struct grid_tick {
+    Grid* grid;
+    Random* random;
+    GridRect wake; /* moves of the current row block, woken together */
+} GridTick;
+
+static void grid_move_cell(Grid* grid, int from, int to) {
+    Uint8 temporary_type = grid->types[from];
+    grid->types[from] = grid->types[to];
+    grid->types[to] = temporary_type;
+
+    SDL_Color temporary_color = grid->colors[from];
+    grid->colors[from] = grid->colors[to];
+    grid->colors[to] = temporary_color;
+}
+
+/* The stride is a multiple of GRID_MOVED_BITS, so a cell's moved bit is at its plane index. */
+static bool grid_has_moved(const Grid* grid, int index) {
+    return (grid->moved[(Uint32)index / GRID_MOVED_BITS] >> ((Uint32)index % GRID_MOVED_BITS)) & 1;
+}
+
+static void grid_set_moved(Grid* grid, int index, bool moved) {
+    Uint16* word = &grid->moved[(Uint32)index / GRID_MOVED_BITS];
+    Uint16 bit = (Uint16)(1u << ((Uint32)index % GRID_MOVED_BITS));
+    *word = (Uint16)((*word & ~bit) | (moved ? bit : 0));
+}
+
+/*
+ * Moves made by a tick mark the mover as done. It hadn't moved before, so its
+ * old cell only needs a bit when what it displaced had one.
+ */
+static void grid_tick_move_cell(Grid* grid, int from, int to) {
+    grid_move_cell(grid, from, to);
+    Uint16* word = &grid->moved[(Uint32)to / GRID_MOVED_BITS];
+    Uint16 bit = (Uint16)(1u << ((Uint32)to % GRID_MOVED_BITS));
+    if (*word & bit)
+        grid_set_moved(grid, from, true);
+    *word |= bit;
+}
+
+static void grid_move_particle(Grid* grid, Coordinates source, Coordinates destination) {
+    int from = grid_index(grid, source.x, source.y);
+    int to = grid_index(grid, destination.x, destination.y);
+    grid_count_change(grid, source.x, source.y, grid->types[from], grid->types[to]);
+    grid_count_change(grid, destination.x, destination.y, grid->types[to], grid->types[from]);
+    grid_move_cell(grid, from, to);
+    grid_sync_words(grid, source.y, source.x / 64, source.x / 64);
+    grid_sync_words(grid, destination.y, destination.x / 64, destination.x / 64);
+    grid_wake_neighborhood(grid, source, destination);
+}
+
+static void grid_tick_move(GridTick* tick, Coordinates source, Coordinates destination) {
+    Grid* grid = tick->grid;
+    grid_tick_move_cell(grid, grid_index(grid, source.x, source.y), grid_index(grid, destination.x, destination.y));
+    grid_rect_extend(&tick->wake, grid_neighborhood(source, destination));
+}
+
 void grid_swap(Grid* grid, Coordinates source, Coordinates destination) {
-    if (!grid || !grid_is_in_bounds(source) || !grid_is_in_bounds(destination))
+    if (!grid || !grid_is_in_bounds(grid, source) || !grid_is_in_bounds(grid, destination))
         return;
 
-    Particle temporary_particle = grid->particles[source.y][source.x];
-    grid->particles[source.y][source.x] = grid->particles[destination.y][destination.x];
-    grid->particles[destination.y][destination.x] = temporary_particle;
-
-    grid->particles[destination.y][destination.x].update_gen = grid->current_gen;
+    grid_move_particle(grid, source, destination);
     grid->dirty = true;
 }
 
-static void particle_update_sand(Grid* grid, Coordinates coordinates) {
-    if (coordinates.y + 1 >= GRID_HEIGHT)
-        return;
+/*
+ * Falls straight down, else slides diagonally past a non-solid side. Returns
+ * whether it moved. Neighbors are read straight from the padded type plane,
+ * no bounds checks needed.
+ */
+static bool grid_fall(GridTick* tick, Coordinates coordinates) {
+    Grid* grid = tick->grid;
+    const Uint8* cell = &grid->types[grid_index(grid, coordinates.x, coordinates.y)];
+    const Uint8* cell_below = cell + grid->stride;
 
     Coordinates below = {coordinates.x, coordinates.y + 1};
-    Coordinates left = {coordinates.x - 1, coordinates.y};
-    Coordinates right = {coordinates.x + 1, coordinates.y};
     Coordinates below_left = {coordinates.x - 1, coordinates.y + 1};
     Coordinates below_right = {coordinates.x + 1, coordinates.y + 1};
 
-    bool is_below_empty = grid_is_particle_empty(grid, below);
-    bool is_below_left_empty = grid_is_particle_empty(grid, below_left);
-    bool is_below_right_empty = grid_is_particle_empty(grid, below_right);
-    bool can_go_below_left = is_below_left_empty && !grid_is_particle_solid(grid, left);
-    bool can_go_below_right = is_below_right_empty && !grid_is_particle_solid(grid, right);
+    bool can_go_below = particle_can_displace(cell[0], cell_below[0]);
+    bool can_go_below_left =
+        particle_can_displace(cell[0], cell_below[-1]) && !particle_type_has(cell[-1], MATERIAL_SOLID);
+    bool can_go_below_right =
+        particle_can_displace(cell[0], cell_below[1]) && !particle_type_has(cell[1], MATERIAL_SOLID);
 
-    if (is_below_empty) {
-        grid_swap(grid, coordinates, below);
-        return;
+    if (can_go_below) {
+        grid_tick_move(tick, coordinates, below);
+        return true;
     }
 
     if (!can_go_below_left && !can_go_below_right) {
-        return;
+        return false;
     }
 
     if (can_go_below_left && can_go_below_right) {
-        bool go_left = SDL_rand(2);
-        grid_swap(grid, coordinates, go_left ? below_left : below_right);
+        bool go_left = random_bit(tick->random);
+        grid_tick_move(tick, coordinates, go_left ? below_left : below_right);
+        return true;
+    }
+
+    grid_tick_move(tick, coordinates, can_go_below_left ? below_left : below_right);
+    return true;
+}
+
+static void particle_update_powder(GridTick* tick, Coordinates coordinates) {
+    grid_fall(tick, coordinates);
+}
+
+/* How far along the row a liquid at `cell` can flow in `step` direction, stopping above the first drop. */
+static int grid_liquid_reach(const Grid* grid, const Uint8* cell, int step, int dispersion) {
+    int reach = 0;
+    for (int i = 1; i <= dispersion; i++) {
+        const Uint8* next = cell + i * step;
+        if (!particle_can_displace(cell[0], next[0]))
+            break;
+        reach = i;
+        if (particle_can_displace(cell[0], next[grid->stride]))
+            break;
+    }
+    return reach;
+}
+
+/*
+ * Falls like a powder, else flows sideways to the farthest cell it can reach
+ * this tick, so a pool levels in a few ticks rather than one cell per tick.
+ * The scan reads the row as earlier cells of this tick left it, exactly as a
+ * sweep would.
+ */
+static void particle_update_liquid(GridTick* tick, Coordinates coordinates) {
+    if (grid_fall(tick, coordinates))
+        return;
+
+    Grid* grid = tick->grid;
+    const Uint8* cell = &grid->types[grid_index(grid, coordinates.x, coordinates.y)];
+    int dispersion = SDL_min(PARTICLE_MATERIALS[cell[0]].dispersion, MATERIAL_MAX_DISPERSION);
+    int left = grid_liquid_reach(grid, cell, -1, dispersion);
+    int right = grid_liquid_reach(grid, cell, 1, dispersion);
+    if (!left && !right)
+        return;
+
+    bool go_left = left && (!right || random_bit(tick->random));
+    int x = go_left ? coordinates.x - left : coordinates.x + right;
+    grid_tick_move(tick, coordinates, (Coordinates){x, coordinates.y});
+}
+
+typedef void (*GridKernel)(GridTick* tick, Coordinates coordinates);
+
+/* Indexed by a material's kernel id. */
+static const GridKernel GRID_KERNELS[MATERIAL_KERNEL_COUNT] = {
+    [MATERIAL_KERNEL_POWDER] = particle_update_powder,
+    [MATERIAL_KERNEL_LIQUID] = particle_update_liquid,
+};
+
+static void grid_update_particle(GridTick* tick, Coordinates coordinates) {
+    Grid* grid = tick->grid;
+    int index = grid_index(grid, coordinates.x, coordinates.y);
+    if (grid_has_moved(grid, index))
         return;
+
+    GridKernel kernel = GRID_KERNELS[PARTICLE_MATERIALS[grid->types[index]].kernel];
+    if (kernel)
+        kernel(tick, coordinates);
+}
+
+
+/* One bit per cell of a row block, lowest bit first. */
+typedef struct grid_row_masks {
+    Uint32 moving;      /* cells with a kernel */
+    Uint32 powder;      /* the powders among them */
+    Uint32 below_empty; /* the cell below is empty */
+    Uint32 open;        /* the cell below or a diagonal below is empty or liquid */
+} GridRowMasks;
+
+/*
+ * Classifies the first `count` cells of the row block at (x, y) by type id
+ * range, which particle.h keeps in step with the material flags. Only those
+ * cells and the ones below and diagonally below them are read; bits past
+ * `count` come from border bytes, and callers mask them off.
+ */
+static GridRowMasks grid_row_masks(const Grid* grid, int x, int y, int count) {
+    Uint8 cell_block[GRID_ROW_BLOCK];
+    Uint8 below_block[GRID_ROW_BLOCK + 2];
+    const Uint8* types = grid_row_block(&grid->types[grid_index(grid, x, y)], count, cell_block, GRID_ROW_BLOCK);
+    const Uint8* below =
+        grid_row_block(&grid->types[grid_index(grid, x - 1, y + 1)], count + 2, below_block, GRID_ROW_BLOCK + 2) + 1;
+    GridRowMasks masks;
+
+#if defined(__AVX2__)
+    __m256i empty = _mm256_set1_epi8(EMPTY);
+    __m256i cells = _mm256_loadu_si256((const __m256i*)types);
+    __m256i is_moving = grid_in_range_256(cells, PARTICLE_FIRST_MOVING, PARTICLE_TYPE_COUNT - 1);
+    __m256i is_powder = grid_in_range_256(cells, PARTICLE_FIRST_MOVING, PARTICLE_LAST_POWDER);
+    __m256i is_below_empty = _mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)below), empty);
+    __m256i is_open = _mm256_or_si256(grid_open_256(below),
+                                      _mm256_or_si256(grid_open_256(below - 1), grid_open_256(below + 1)));
+    masks.moving = (Uint32)_mm256_movemask_epi8(is_moving);
+    masks.powder = (Uint32)_mm256_movemask_epi8(is_powder);
+    masks.below_empty = (Uint32)_mm256_movemask_epi8(is_below_empty);
+    masks.open = (Uint32)_mm256_movemask_epi8(is_open);
+#elif defined(GRID_USE_SSE2)
+    masks = (GridRowMasks){0};
+    __m128i empty = _mm_set1_epi8(EMPTY);
+    for (int offset = 0; offset < GRID_ROW_BLOCK; offset += 16) {
+        __m128i cells = _mm_loadu_si128((const __m128i*)(types + offset));
+        __m128i is_moving = grid_in_range_128(cells, PARTICLE_FIRST_MOVING, PARTICLE_TYPE_COUNT - 1);
+        __m128i is_powder = grid_in_range_128(cells, PARTICLE_FIRST_MOVING, PARTICLE_LAST_POWDER);
+        __m128i is_below_empty = _mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)(below + offset)), empty);
+        __m128i is_open = _mm_or_si128(grid_open_128(below + offset), _mm_or_si128(grid_open_128(below + offset - 1),
+                                                                                  grid_open_128(below + offset + 1)));
+        masks.moving |= (Uint32)_mm_movemask_epi8(is_moving) << offset;
+        masks.powder |= (Uint32)_mm_movemask_epi8(is_powder) << offset;
+        masks.below_empty |= (Uint32)_mm_movemask_epi8(is_below_empty) << offset;
+        masks.open |= (Uint32)_mm_movemask_epi8(is_open) << offset;
+    }
+#else
+    masks = (GridRowMasks){0};
+    for (int i = 0; i < GRID_ROW_BLOCK; i++) {
+        masks.moving |= (Uint32)particle_type_has(types[i], MATERIAL_MOVES) << i;
+        masks.powder |= (Uint32)particle_type_has(types[i], MATERIAL_POWDER) << i;
+        masks.below_empty |= (Uint32)particle_type_has(below[i], MATERIAL_EMPTY) << i;
+        masks.open |= (Uint32)(particle_type_has(below[i - 1], MATERIAL_EMPTY | MATERIAL_LIQUID) ||
+                               particle_type_has(below[i], MATERIAL_EMPTY | MATERIAL_LIQUID) ||
+                               particle_type_has(below[i + 1], MATERIAL_EMPTY | MATERIAL_LIQUID)) << i;
+    }
+#endif
+
+    return masks;
+}
+
+/*
+ * Moved bits of `count` cells from (x, y), lowest bit first. Only words under
+ * those cells are read, since the chunks next door may be writing theirs.
+ */
+static Uint32 grid_row_moved(const Grid* grid, int x, int y, int count) {
+    Uint32 index = (Uint32)grid_index(grid, x, y);
+    const Uint16* words = grid->moved;
+    Uint64 bits = 0;
+    for (Uint32 word = (index + (Uint32)count - 1) / GRID_MOVED_BITS + 1; word-- > index / GRID_MOVED_BITS;)
+        bits = bits << GRID_MOVED_BITS | words[word];
+    return (Uint32)(bits >> (index % GRID_MOVED_BITS));
+}
+
+/* Next set bit in scan order. */
+static int grid_row_next_bit(Uint32 bits, bool left_to_right) {
+    return SDL_MostSignificantBitIndex32(left_to_right ? bits & (~bits + 1) : bits);
+}
+
+/* Drops every marked powder cell of the block one row, without looking at neighbors. */
+static void grid_row_fall(GridTick* tick, int x, int y, Uint32 falls) {
+    Grid* grid = tick->grid;
+    int first = grid_row_next_bit(falls, true);
+    int last = grid_row_next_bit(falls, false);
+
+    for (Uint32 bits = falls; bits; bits &= bits - 1) {
+        int from = grid_index(grid, x + grid_row_next_bit(bits, true), y);
+        grid_move_cell(grid, from, from + grid->stride);
     }
 
-    if (can_go_below_left) {
-        grid_swap(grid, coordinates, below_left);
+    /* Empty cells never carry a moved bit, so only the grains' new cells need one */
+    Uint32 index = (Uint32)grid_index(grid, x, y + 1);
+    Uint64 moved = (Uint64)falls << (index % GRID_MOVED_BITS);
+    for (Uint32 word = index / GRID_MOVED_BITS; moved; word++, moved >>= GRID_MOVED_BITS)
+        grid->moved[word] |= (Uint16)moved;
+
+    grid_rect_extend(&tick->wake, (GridRect){x + first - 1, y - 1, x + last + 1, y + 2});
+}
+
+/*
+ * Updates `count` cells from (x, y) in scan order. Within a row, cells below
+ * only fill up and powders never turn solid, so a grain with no empty or
+ * liquid cell below it at the start of the block never moves, and a fall
+ * into an empty cell found there still happens unless the cell scanned just
+ * before it slides diagonally into the same spot first. Only sliding or
+ * sinking grains and the falls right behind them go through the scalar rule;
+ * all other falls resolve in bulk. A block holding any other material runs
+ * entirely through the scalar rules, since a liquid flowing along the row
+ * can take a spot a later grain would have reached.
+ */
+static void grid_update_row_block(GridTick* tick, int x, int y, int count) {
+    Grid* grid = tick->grid;
+    bool left_to_right = grid->update_left_to_right;
+
+    GridRowMasks masks = grid_row_masks(grid, x, y, count);
+    Uint32 in_block = count < GRID_ROW_BLOCK ? (1u << count) - 1 : ~0u;
+    Uint32 moving = masks.moving & in_block;
+    if (!moving)
         return;
+
+    Uint32 unmoved = ~grid_row_moved(grid, x, y, count);
+    moving &= unmoved;
+    Uint32 powder = masks.powder & in_block & unmoved;
+    Uint32 others = moving & ~powder;
+    Uint32 falls = powder & masks.below_empty;
+    Uint32 slides = powder & ~masks.below_empty & masks.open;
+    Uint32 contested = others ? falls : falls & (left_to_right ? slides << 1 : slides >> 1);
+    for (Uint32 next; (next = falls & ~contested & (left_to_right ? contested << 1 : contested >> 1));)
+        contested |= next;
+
+    Uint32 bulk = falls & ~contested;
+    if (bulk)
+        grid_row_fall(tick, x, y, bulk);
+
+    for (Uint32 bits = slides | contested | others; bits;) {
+        int bit = grid_row_next_bit(bits, left_to_right);
+        bits &= ~(1u << bit);
+        grid_update_particle(tick, (Coordinates){x + bit, y});
+    }
+
+    /*
+     * Nothing inside the block reads chunk rects, and they are bounding boxes,
+     * so one wake per block marks the same cells as one per move.
+     */
+    if (!grid_rect_is_empty(tick->wake)) {
+        grid_wake_region(grid, tick->wake);
+        tick->wake = GRID_RECT_EMPTY;
     }
+}
+
+/*
+ * Bounds are re-read between blocks: a move can wake cells further along the
+ * scan, and those still get visited this tick exactly as in a full sweep.
+ */
+static void grid_update_chunk_row(GridTick* tick, GridChunk* chunk, int y) {
+    if (tick->grid->update_left_to_right) {
+        for (int x = chunk->dirty.min_x; x <= chunk->dirty.max_x;) {
+            int count = SDL_min(chunk->dirty.max_x - x + 1, GRID_ROW_BLOCK);
+            grid_update_row_block(tick, x, y, count);
+            x += count;
+        }
+    } else {
+        for (int x = chunk->dirty.max_x; x >= chunk->dirty.min_x;) {
+            int count = SDL_min(x - chunk->dirty.min_x + 1, GRID_ROW_BLOCK);
+            grid_update_row_block(tick, x - count + 1, y, count);
+            x -= count;
+        }
+    }
+}
+
+static void grid_begin_tick(Grid* grid) {
+    for (int i = 0; i < grid->chunks_x * grid->chunks_y; i++) {
+        GridChunk* chunk = &grid->chunks[i];
+        chunk->last_dirty = chunk->dirty;
+        chunk->dirty = chunk->next_dirty;
+        chunk->next_dirty = GRID_RECT_EMPTY;
+        chunk->active = !grid_rect_is_empty(chunk->dirty);
+    }
+}
 
-    if (can_go_below_right) {
-        grid_swap(grid, coordinates, below_right);
+/* Clears the words under a chunk's woken rect, which hold every bit a tick set in that chunk. */
+static void grid_clear_moved(Grid* grid, GridRect region) {
+    for (int y = region.min_y; y <= region.max_y; y++) {
+        Uint16* row = &grid->moved[grid_index(grid, 0, y) / GRID_MOVED_BITS];
+        for (int word = region.min_x / GRID_MOVED_BITS; word <= region.max_x / GRID_MOVED_BITS; word++)
+            row[word] = 0;
+    }
+}
+
+static void grid_end_tick(Grid* grid) {
+    /*
+     * Only moves wake cells while a tick runs, so anything woken means pixels
+     * changed, and every moved cell is inside what got woken. Syncing here rather
+     * than per move keeps chunks that share a bitboard word off each other's toes,
+     * and a move across a chunk border from changing two chunks' counts at once.
+     */
+    for (int i = 0; i < grid->chunks_x * grid->chunks_y; i++) {
+        GridRect woken = grid->chunks[i].next_dirty;
+        if (!grid_rect_is_empty(woken)) {
+            grid_sync_bitboards(grid, woken);
+            grid_clear_moved(grid, woken);
+            grid_recount_chunk(grid, i % grid->chunks_x, i / grid->chunks_x);
+            grid->dirty = true;
+        }
+    }
+
+    grid->update_left_to_right = !grid->update_left_to_right;
+    grid->tick_count++;
+}
+
+void grid_update(Grid* grid) {
+    if (!grid) 
         return;
+
+    grid_begin_tick(grid);
+
+    /* One stream per tick, so a run only depends on the seed and the edits made */
+    Random random;
+    random_seed_stream(&random, grid->seed, grid->tick_count);
+
+    /* Same bottom-up, alternating scan as a full sweep, restricted to dirty rects */
+    GridTick tick = {.grid = grid, .random = &random, .wake = GRID_RECT_EMPTY};
+    for (int y = grid->height - 1; y >= 0; y--) {
+        GridChunk* chunk_row = grid_chunk_at(grid, 0, y / GRID_CHUNK_SIZE);
+
+        for (int i = 0; i < grid->chunks_x; i++) {
+            GridChunk* chunk = &chunk_row[grid->update_left_to_right ? i : grid->chunks_x - 1 - i];
+            if (!chunk->active || y < chunk->dirty.min_y || y > chunk->dirty.max_y)
+                continue;
+
+            grid_update_chunk_row(&tick, chunk, y);
+        }
+    }
+
+    grid_end_tick(grid);
+}
+
+/*
+ * Chunks of one checkerboard phase are a whole chunk apart, while a particle
+ * moves at most one cell down and MATERIAL_MAX_DISPERSION cells sideways per
+ * step, looking one cell past that, so no two of them touch the same cell.
+ * Wake-ups can still meet in the chunk between them, hence the chunk spinlock.
+ */
+_Static_assert(2 * (MATERIAL_MAX_DISPERSION + 1) <= GRID_CHUNK_SIZE,
+               "checkerboard phases need chunks wider than two liquid reaches");
+/* Moves stay within half a chunk of their own, so the moved words they write do too */
+_Static_assert(GRID_MOVED_BITS == GRID_CHUNK_SIZE / 2 && GRID_ALIGNMENT % GRID_MOVED_BITS == 0,
+               "moved words must split chunk rows in two");
+
+typedef struct grid_phase {
+    Grid* grid;
+    int first_x;
+    int first_y;
+    int chunks_per_row;
+} GridPhase;
+
+/* Index into grid->chunks of the phase's `index`th chunk. */
+static int grid_phase_chunk(const GridPhase* phase, int index) {
+    int cx = phase->first_x + 2 * (index % phase->chunks_per_row);
+    int cy = phase->first_y + 2 * (index / phase->chunks_per_row);
+    return cy * phase->grid->chunks_x + cx;
+}
+
+/* Runs `job` over the chunks of each checkerboard phase in turn, with the phase as its data. */
+static void grid_run_phases(Grid* grid, WorkerPool* workers, WorkerJob job) {
+    /* Odd chunk rows first, so half of the chunk borders see the lower chunk move first */
+    static const int phases[4][2] = {{0, 1}, {1, 1}, {0, 0}, {1, 0}};
+    for (int i = 0; i < 4; i++) {
+        int first_x = grid->update_left_to_right ? phases[i][0] : 1 - phases[i][0];
+        int first_y = phases[i][1];
+        int chunks_per_row = (grid->chunks_x - first_x + 1) / 2;
+        int chunk_rows = (grid->chunks_y - first_y + 1) / 2;
+
+        GridPhase phase = {.grid = grid, .first_x = first_x, .first_y = first_y, .chunks_per_row = chunks_per_row};
+        workers_run(workers, job, &phase, chunks_per_row * chunk_rows);
     }
 }
 
-static void grid_update_particle(Grid* grid, Coordinates coordinates) {
-    if (!grid || !grid_is_in_bounds(coordinates))
+static void grid_update_phase_chunk(void* data, int index) {
+    GridPhase* phase = data;
+    Grid* grid = phase->grid;
+    int chunk_index = grid_phase_chunk(phase, index);
+
+    GridChunk* chunk = &grid->chunks[chunk_index];
+    if (!chunk->active)
         return;
 
-    Particle* p = &grid->particles[coordinates.y][coordinates.x];
-    if (p->update_gen == grid->current_gen)
+    /* Seeded by chunk and tick, so results don't depend on which thread runs it */
+    Uint64 chunk_count = (Uint64)grid->chunks_x * (Uint64)grid->chunks_y;
+    Random random;
+    random_seed_stream(&random, grid->seed, grid->tick_count * chunk_count + (Uint64)chunk_index);
+    GridTick tick = {.grid = grid, .random = &random, .wake = GRID_RECT_EMPTY};
+
+    for (int y = chunk->dirty.max_y; y >= chunk->dirty.min_y; y--)
+        grid_update_chunk_row(&tick, chunk, y);
+}
+
+void grid_update_parallel(Grid* grid, WorkerPool* workers) {
+    if (!grid)
+        return;
+    if (grid->deterministic) {
+        grid_update(grid);
         return;
+    }
 
-    switch (p->type) {
-        case SAND: particle_update_sand(grid, coordinates); break;
-        default: break;
+    grid_begin_tick(grid);
+    grid_run_phases(grid, workers, grid_update_phase_chunk);
+    grid_end_tick(grid);
+}
+
+/* Bit i set when cell (x + i, y) holds a material with a kernel; loads may run into padding. */
+static Uint32 grid_row_movers(const Grid* grid, int x, int y, int count) {
+    return grid_row_in_range(&grid->types[grid_index(grid, x, y)], count, PARTICLE_FIRST_MOVING,
+                             PARTICLE_TYPE_COUNT - 1);
+}
+
+/* Steps the block with its top left cell at (x, y); whether anything in it moved. */
+static bool grid_margolus_block(Grid* grid, int x, int y) {
+    int top_left = grid_index(grid, x, y);
+    int cells[4] = {top_left, top_left + 1, top_left + grid->stride, top_left + grid->stride + 1};
+    Uint8* types = grid->types;
+    Uint8 move = grid->margolus.moves[margolus_state(&grid->margolus, types[cells[0]], types[cells[1]],
+                                                     types[cells[2]], types[cells[3]])];
+    if (move == MARGOLUS_IDENTITY)
+        return false;
+
+    Uint8 old_types[4];
+    SDL_Color old_colors[4];
+    for (int i = 0; i < 4; i++) {
+        old_types[i] = types[cells[i]];
+        old_colors[i] = grid->colors[cells[i]];
     }
+    for (int i = 0; i < 4; i++) {
+        types[cells[i]] = old_types[margolus_source(move, i)];
+        grid->colors[cells[i]] = old_colors[margolus_source(move, i)];
+    }
+    return true;
 }
 
-void grid_update(Grid* grid) {
-    if (!grid) 
+/* Smallest block origin at or after `min` for this tick's offset; chunks at the edge also own the one at -1. */
+static int grid_margolus_first(int min, int offset) {
+    return min == 0 ? -offset : min + ((min + offset) & 1);
+}
+
+typedef struct grid_margolus_pass {
+    Grid* grid;
+    int offset; /* blocks start at (-offset, -offset) */
+} GridMargolusPass;
+
+/*
+ * A chunk owns the blocks whose top left cell it holds, and steps those that
+ * touch a cell changed during either of the last two ticks: the one before
+ * woke the blocks of the other offset, the one before that left blocks of
+ * this offset in a state they haven't been stepped from yet. Wakes only ever
+ * go to the next tick, so no chunk reads what another one writes.
+ */
+static void grid_margolus_chunk(void* data, int index) {
+    GridMargolusPass* pass = data;
+    Grid* grid = pass->grid;
+    GridChunk* chunk = &grid->chunks[index];
+
+    GridRect region = chunk->dirty;
+    grid_rect_extend(&region, chunk->last_dirty);
+    if (grid_rect_is_empty(region))
         return;
 
-    grid->current_gen++;
+    int first_x = grid_margolus_first(region.min_x, pass->offset);
+    for (int y = grid_margolus_first(region.min_y, pass->offset); y <= region.max_y; y += 2) {
+        GridRect wake = GRID_RECT_EMPTY;
+        for (int x = first_x; x <= region.max_x; x += GRID_ROW_BLOCK) {
+            /*
+             * Blocks start on even bits; one without a mover never changes. When
+             * the last block starts on the region's last column, the chunk owns
+             * its right cells too, otherwise they are a neighbor's to write.
+             */
+            int count = region.max_x - x + 1;
+            int cells = SDL_min(count + (count & 1), GRID_ROW_BLOCK);
+            Uint32 movers = grid_row_movers(grid, x, y, cells) | grid_row_movers(grid, x, y + 1, cells);
+            Uint32 blocks = (movers | movers >> 1) & 0x55555555u;
+            if (count < GRID_ROW_BLOCK)
+                blocks &= (1u << count) - 1;
 
-    for (int y = GRID_HEIGHT - 1; y >= 0; y--) {
-        if (grid->update_left_to_right) {
-            for (int x = 0; x < GRID_WIDTH; x++) {
-                grid_update_particle(grid, (Coordinates){x, y});
+            for (; blocks; blocks &= blocks - 1) {
+                int block_x = x + grid_row_next_bit(blocks, true);
+                if (grid_margolus_block(grid, block_x, y))
+                    grid_rect_extend(&wake, (GridRect){block_x - 1, y - 1, block_x + 1, y + 1});
             }
-        } else {
-            for (int x = GRID_WIDTH - 1; x >= 0; x--) {
-                grid_update_particle(grid, (Coordinates){x, y});
+        }
+        if (!grid_rect_is_empty(wake))
+            grid_wake(grid, wake, false);
+    }
+}
+
+void grid_update_margolus(Grid* grid, WorkerPool* workers) {
+    if (!grid)
+        return;
+
+    grid_begin_tick(grid);
+
+    GridMargolusPass pass = {.grid = grid, .offset = (int)(grid->tick_count & 1)};
+    workers_run(workers, grid_margolus_chunk, &pass, grid->chunks_x * grid->chunks_y);
+
+    grid_end_tick(grid);
+}
+
+/*
+ * Buffered engine. Targets are picked from the type plane alone, which nothing
+ * writes until every mover has picked, so it serves as the front buffer; the
+ * disjoint swaps that follow build the back buffer in place, leaving every
+ * cell nobody moved into or out of as it was without copying it.
+ *
+ * An intent byte holds a mover's target offset, dx + GRID_INTENT_DX_BIAS in
+ * the low five bits and dy above them; 0 means it stays put.
+ */
+#define GRID_INTENT_DX_BIAS 16
+_Static_assert(MATERIAL_MAX_DISPERSION < GRID_INTENT_DX_BIAS, "a liquid's reach must fit the intent byte");
+
+static Uint8 grid_intent(int dx, int dy) {
+    return (Uint8)((dy << 5) | (dx + GRID_INTENT_DX_BIAS));
+}
+
+static int grid_intent_dx(Uint8 intent) {
+    return (intent & 31) - GRID_INTENT_DX_BIAS;
+}
+
+static int grid_intent_dy(Uint8 intent) {
+    return intent >> 5;
+}
+
+/* Bit `bit` of this tick's hash for the cell at `index`. */
+static bool grid_cell_hash_bit(const Grid* grid, int index, int bit) {
+    return (random_hash(grid->seed, grid->tick_count, (Uint64)(Uint32)index) >> bit) & 1;
+}
+
+/* Same choices as grid_fall and particle_update_liquid, with ties broken by the mover's cell. */
+static Uint8 grid_pick_intent(const Grid* grid, int index) {
+    const Uint8* cell = &grid->types[index];
+    const Uint8* cell_below = cell + grid->stride;
+    if (particle_can_displace(cell[0], cell_below[0]))
+        return grid_intent(0, 1);
+
+    bool left = particle_can_displace(cell[0], cell_below[-1]) && !particle_type_has(cell[-1], MATERIAL_SOLID);
+    bool right = particle_can_displace(cell[0], cell_below[1]) && !particle_type_has(cell[1], MATERIAL_SOLID);
+    if (left || right)
+        return grid_intent(left && (!right || grid_cell_hash_bit(grid, index, 1)) ? -1 : 1, 1);
+
+    if (!particle_type_has(cell[0], MATERIAL_LIQUID))
+        return 0;
+
+    int dispersion = SDL_min(PARTICLE_MATERIALS[cell[0]].dispersion, MATERIAL_MAX_DISPERSION);
+    int reach_left = grid_liquid_reach(grid, cell, -1, dispersion);
+    int reach_right = grid_liquid_reach(grid, cell, 1, dispersion);
+    if (!reach_left && !reach_right)
+        return 0;
+    bool go_left = reach_left && (!reach_right || grid_cell_hash_bit(grid, index, 1));
+    return grid_intent(go_left ? -reach_left : reach_right, 0);
+}
+
+/*
+ * Rank of a claim on `target`: falls beat diagonal slides, which beat flows,
+ * and nearer flows beat farther ones. The target's own hash bit says which
+ * side wins a tie, so no two claims on one cell rank the same. Never 0.
+ */
+static Uint8 grid_claim_rank(const Grid* grid, Uint8 intent, int target) {
+    int dx = grid_intent_dx(intent);
+    if (dx == 0)
+        return 255;
+
+    int side = (dx > 0) == grid_cell_hash_bit(grid, target, 0);
+    int base = grid_intent_dy(intent) ? 200 : 100 - 2 * SDL_abs(dx);
+    return (Uint8)(base + side);
+}
+
+/*
+ * Pass one, in checkerboard phases: every mover in the dirty rect records its
+ * intent and raises its target's claim to its rank. Only types are read and
+ * taking the maximum doesn't care about order, so phases only keep two chunks
+ * from writing the same claim at once.
+ */
+static void grid_buffered_claim_chunk(void* data, int index) {
+    GridPhase* phase = data;
+    Grid* grid = phase->grid;
+    GridChunk* chunk = &grid->chunks[grid_phase_chunk(phase, index)];
+    if (!chunk->active)
+        return;
+
+    GridRect dirty = chunk->dirty;
+    for (int y = dirty.min_y; y <= dirty.max_y; y++) {
+        for (int x = dirty.min_x; x <= dirty.max_x; x += GRID_ROW_BLOCK) {
+            Uint32 movers = grid_row_movers(grid, x, y, dirty.max_x - x + 1);
+
+            for (; movers; movers &= movers - 1) {
+                int source = grid_index(grid, x + grid_row_next_bit(movers, true), y);
+                Uint8 intent = grid_pick_intent(grid, source);
+                if (!intent)
+                    continue;
+
+                int target = source + grid_intent_dy(intent) * grid->stride + grid_intent_dx(intent);
+                Uint8 rank = grid_claim_rank(grid, intent, target);
+                grid->intents[source] = intent;
+                grid->claims[target] = SDL_max(grid->claims[target], rank);
             }
         }
     }
+}
 
-    grid->update_left_to_right = !grid->update_left_to_right;
+/* Bit i set when cell (x + i, y) recorded an intent, for the first `count` cells of the block. */
+static Uint32 grid_buffered_sources(const Grid* grid, int x, int y, int count) {
+    return grid_row_in_range(&grid->intents[grid_index(grid, x, y)], count, 1, 0xFF);
 }
 
-void grid_render(Grid* grid, Display *display) {
-    if (!grid || !display || !display->renderer || !display->texture) 
+/*
+ * Pass two, every chunk at once: a mover whose claim ranks first swaps into its
+ * target unless that holds a mover leaving too. Each target has one winner and
+ * no winner's own cell is a target, so the swaps never share a cell, and the
+ * scan reads intents rather than types, which other chunks' swaps may write.
+ * Losers wake their own cell to try again next tick.
+ */
+static void grid_buffered_apply_chunk(void* data, int index) {
+    Grid* grid = data;
+    GridChunk* chunk = &grid->chunks[index];
+    if (!chunk->active)
         return;
 
-    if (!grid->dirty) {
-        SDL_RenderTexture(display->renderer, display->texture, NULL, NULL);
+    GridRect dirty = chunk->dirty;
+    for (int y = dirty.min_y; y <= dirty.max_y; y++) {
+        GridRect wake = GRID_RECT_EMPTY;
+        for (int x = dirty.min_x; x <= dirty.max_x; x += GRID_ROW_BLOCK) {
+            Uint32 sources = grid_buffered_sources(grid, x, y, dirty.max_x - x + 1);
+            for (; sources; sources &= sources - 1) {
+                Coordinates from = {x + grid_row_next_bit(sources, true), y};
+                int source = grid_index(grid, from.x, from.y);
+                Uint8 intent = grid->intents[source];
+                Coordinates to = {from.x + grid_intent_dx(intent), y + grid_intent_dy(intent)};
+                int target = grid_index(grid, to.x, to.y);
+                if (grid->claims[target] == grid_claim_rank(grid, intent, target) && !grid->intents[target]) {
+                    grid_move_cell(grid, source, target);
+                    grid_rect_extend(&wake, grid_neighborhood(from, to));
+                } else {
+                    grid_rect_extend(&wake, (GridRect){from.x, y, from.x, y});
+                }
+            }
+        }
+        if (!grid_rect_is_empty(wake))
+            grid_wake(grid, wake, false);
+    }
+}
+
+/* Pass three, in phases again since movers of neighboring chunks may share a target. */
+static void grid_buffered_clear_chunk(void* data, int index) {
+    GridPhase* phase = data;
+    Grid* grid = phase->grid;
+    GridChunk* chunk = &grid->chunks[grid_phase_chunk(phase, index)];
+    if (!chunk->active)
         return;
+
+    GridRect dirty = chunk->dirty;
+    for (int y = dirty.min_y; y <= dirty.max_y; y++) {
+        for (int x = dirty.min_x; x <= dirty.max_x; x += GRID_ROW_BLOCK) {
+            Uint32 sources = grid_buffered_sources(grid, x, y, dirty.max_x - x + 1);
+            for (; sources; sources &= sources - 1) {
+                int source = grid_index(grid, x + grid_row_next_bit(sources, true), y);
+                Uint8 intent = grid->intents[source];
+                grid->claims[source + grid_intent_dy(intent) * grid->stride + grid_intent_dx(intent)] = 0;
+                grid->intents[source] = 0;
+            }
+        }
     }
+}
 
-    int pitch;
-    void *pixels;
-    if (!SDL_LockTexture(display->texture, NULL, &pixels, &pitch)) {
-        SDL_Log("Couldn't lock texture: %s", SDL_GetError());
+void grid_update_buffered(Grid* grid, WorkerPool* workers) {
+    if (!grid)
         return;
+
+    grid_begin_tick(grid);
+    grid_run_phases(grid, workers, grid_buffered_claim_chunk);
+    workers_run(workers, grid_buffered_apply_chunk, grid, grid->chunks_x * grid->chunks_y);
+    grid_run_phases(grid, workers, grid_buffered_clear_chunk);
+    grid_end_tick(grid);
+}
+
+/* The color plane is already RGBA32 at the row stride, so SDL reads it in place. */
+_Static_assert(sizeof(SDL_Color) == 4, "SDL_Color must match an RGBA32 pixel");
+
+static bool grid_upload_rect(const Grid* grid, SDL_Texture* texture, const SDL_Color* colors, GridRect rect) {
+    SDL_Rect area = {rect.min_x, rect.min_y, rect.max_x - rect.min_x + 1, rect.max_y - rect.min_y + 1};
+    const SDL_Color* pixels = &colors[grid_index(grid, area.x, area.y)];
+
+    if (!SDL_UpdateTexture(texture, &area, pixels, grid->stride * (int)sizeof(SDL_Color))) {
+        SDL_Log("Couldn't update texture: %s", SDL_GetError());
+        return false;
     }
+    return true;
+}
+
+/* Grows `pending` by a span of the next chunk row when they line up, else uploads it. */
+static bool grid_upload_span(const Grid* grid, SDL_Texture* texture, const SDL_Color* colors, GridRect* pending,
+                             GridRect span) {
+    if (grid_rect_is_empty(span))
+        return true;
+
+    if (!grid_rect_is_empty(*pending) && pending->min_x == span.min_x && pending->max_x == span.max_x &&
+        pending->max_y + 1 == span.min_y) {
+        pending->max_y = span.max_y;
+        return true;
+    }
+
+    bool uploaded = grid_rect_is_empty(*pending) || grid_upload_rect(grid, texture, colors, *pending);
+    *pending = span;
+    return uploaded;
+}
 
-    for (int y = 0; y < GRID_HEIGHT; y++) {
-        Uint32* row = (Uint32*)((Uint8*)pixels + y * pitch);
-        for (int x = 0; x < GRID_WIDTH; x++) {
-            SDL_Color color = grid->particles[y][x].color;
-            Uint32 packed;
-            memcpy(&packed, &color, sizeof(Uint32));
-            row[x] = packed;
+bool grid_upload_paint(const Grid* grid, SDL_Texture* texture, const SDL_Color* colors, const GridRect* paint) {
+    if (!grid || !texture || !colors || !paint)
+        return false;
+
+    /* Runs of painted chunks in a chunk row form one span; equal spans stack down */
+    GridRect pending = GRID_RECT_EMPTY;
+    bool uploaded = true;
+    for (int cy = 0; cy < grid->chunks_y && uploaded; cy++) {
+        GridRect span = GRID_RECT_EMPTY;
+        for (int cx = 0; cx < grid->chunks_x && uploaded; cx++) {
+            GridRect rect = paint[cy * grid->chunks_x + cx];
+            if (grid_rect_is_empty(rect)) {
+                uploaded = grid_upload_span(grid, texture, colors, &pending, span);
+                span = GRID_RECT_EMPTY;
+            } else {
+                grid_rect_extend(&span, rect);
+            }
         }
+        uploaded = uploaded && grid_upload_span(grid, texture, colors, &pending, span);
+    }
+    if (uploaded && !grid_rect_is_empty(pending))
+        uploaded = grid_upload_rect(grid, texture, colors, pending);
+
+    return uploaded;
+}
+
+void grid_render(Grid* grid, Display *display) {
+    if (!grid || !display || !display->renderer || !display->texture) 
+        return;
+
+    /* On failure everything stays painted and is uploaded again next frame */
+    if (grid->dirty && grid_upload_paint(grid, display->texture, grid->colors, grid->paint)) {
+        for (int i = 0; i < grid->chunks_x * grid->chunks_y; i++)
+            grid->paint[i] = GRID_RECT_EMPTY;
+        grid->dirty = false;
     }
 
-    SDL_UnlockTexture(display->texture);
     SDL_RenderTexture(display->renderer, display->texture, NULL, NULL);
 }
 
 bool grid_set_particle(Grid* grid, Coordinates coordinates, const Particle* particle) {
-    if (!grid || !particle || !grid_is_in_bounds(coordinates)) 
+    if (!grid || !particle || !grid_is_in_bounds(grid, coordinates) || (unsigned)particle->type >= PARTICLE_TYPE_COUNT)
         return false;
 
-    grid->particles[coordinates.y][coordinates.x] = *particle;
+    int index = grid_index(grid, coordinates.x, coordinates.y);
+    grid_count_change(grid, coordinates.x, coordinates.y, grid->types[index], (Uint8)particle->type);
+    grid->types[index] = (Uint8)particle->type;
+    grid->colors[index] = particle->color;
+    grid_sync_words(grid, coordinates.y, coordinates.x / 64, coordinates.x / 64);
+    grid_wake_neighborhood(grid, coordinates, coordinates);
     grid->dirty = true;
     return true;
 }
 
 bool grid_place_particle(Grid* grid, Coordinates coordinates, ParticleType type) {
-    if (!grid || !grid_is_in_bounds(coordinates)) 
+    if (!grid || !grid_is_in_bounds(grid, coordinates)) 
+        return false;
+    return grid_set_particle(grid, coordinates, &(Particle){.type = type, .color = particle_get_random_color_by_type(type, &grid->random)});
+}
+
+bool grid_get_particle(Grid* grid, Coordinates coordinates, Particle* particle) {
+    if (!grid || !particle || !grid_is_in_bounds(grid, coordinates)) 
         return false;
-    return grid_set_particle(grid, coordinates, &(Particle){.type = type, .color = particle_get_random_color_by_type(type), .update_gen = 0});
+
+    int index = grid_index(grid, coordinates.x, coordinates.y);
+    *particle = (Particle){
+        .type = (ParticleType)grid->types[index],
+        .color = grid->colors[index]
+    };
+    return true;
 }
 
-const Particle* grid_get_particle(Grid* grid, Coordinates coordinates) {
-    if (!grid || !grid_is_in_bounds(coordinates)) 
-        return NULL;
-    return &grid->particles[coordinates.y][coordinates.x];
+ParticleType grid_get_particle_type(Grid* grid, Coordinates coordinates) {
+    if (!grid || !grid_is_in_bounds(grid, coordinates))
+        return EMPTY;
+    return (ParticleType)grid->types[grid_index(grid, coordinates.x, coordinates.y)];
 }
 
 bool grid_is_particle_empty(Grid* grid, Coordinates coordinates) {
-    if (!grid || !grid_is_in_bounds(coordinates)) 
+    if (!grid || !grid_is_in_bounds(grid, coordinates)) 
         return false;
-    return particle_is_empty(grid_get_particle(grid, coordinates));
+    return particle_is_type_empty((ParticleType)grid->types[grid_index(grid, coordinates.x, coordinates.y)]);
 }
 
 bool grid_is_particle_solid(Grid* grid, Coordinates coordinates) {
-    if (!grid || !grid_is_in_bounds(coordinates))
+    if (!grid || !grid_is_in_bounds(grid, coordinates))
+        return false;
+    return particle_is_type_solid((ParticleType)grid->types[grid_index(grid, coordinates.x, coordinates.y)]);
+}
+
+bool grid_is_in_bounds(Grid* grid, Coordinates coordinates) {
+    if (!grid)
         return false;
-    return particle_is_solid(grid_get_particle(grid, coordinates));
+    return (coordinates.x >= 0 && coordinates.x < grid->width && coordinates.y >= 0 && coordinates.y < grid->height);
 }
 
-bool grid_is_in_bounds(Coordinates coordinates) {
-    return (coordinates.x >= 0 && coordinates.x < GRID_WIDTH && coordinates.y >= 0 && coordinates.y < GRID_HEIGHT);
+/* Empty erases anything else; particles only go over lower priority ones. */
+static bool grid_brush_replaces(ParticleType type, ParticleType existing) {
+    if (type == existing)
+        return false;
+    const Material* material = particle_get_material(type);
+    return (material->flags & MATERIAL_EMPTY) || material->priority > particle_get_material(existing)->priority;
 }
 
-static int particle_type_priority(ParticleType type) {
-    switch (type) {
-        case SAND: return 1;
-        case ROCK: return 2;
-        default: return 0;
+/* Widest dx with dx * dx + dy * dy <= radius * radius, by radius and |dy|. */
+_Static_assert(MAX_BRUSH_RADIUS == 20, "GRID_BRUSH_SPANS has a row per brush radius");
+static const Uint8 GRID_BRUSH_SPANS[MAX_BRUSH_RADIUS + 1][MAX_BRUSH_RADIUS + 1] = {
+    {0},
+    {1, 0},
+    {2, 1, 0},
+    {3, 2, 2, 0},
+    {4, 3, 3, 2, 0},
+    {5, 4, 4, 4, 3, 0},
+    {6, 5, 5, 5, 4, 3, 0},
+    {7, 6, 6, 6, 5, 4, 3, 0},
+    {8, 7, 7, 7, 6, 6, 5, 3, 0},
+    {9, 8, 8, 8, 8, 7, 6, 5, 4, 0},
+    {10, 9, 9, 9, 9, 8, 8, 7, 6, 4, 0},
+    {11, 10, 10, 10, 10, 9, 9, 8, 7, 6, 4, 0},
+    {12, 11, 11, 11, 11, 10, 10, 9, 8, 7, 6, 4, 0},
+    {13, 12, 12, 12, 12, 12, 11, 10, 10, 9, 8, 6, 5, 0},
+    {14, 13, 13, 13, 13, 13, 12, 12, 11, 10, 9, 8, 7, 5, 0},
+    {15, 14, 14, 14, 14, 14, 13, 13, 12, 12, 11, 10, 9, 7, 5, 0},
+    {16, 15, 15, 15, 15, 15, 14, 14, 13, 13, 12, 11, 10, 9, 7, 5, 0},
+    {17, 16, 16, 16, 16, 16, 15, 15, 15, 14, 13, 12, 12, 10, 9, 8, 5, 0},
+    {18, 17, 17, 17, 17, 17, 16, 16, 16, 15, 14, 14, 13, 12, 11, 9, 8, 5, 0},
+    {19, 18, 18, 18, 18, 18, 18, 17, 17, 16, 16, 15, 14, 13, 12, 11, 10, 8, 6, 0},
+    {20, 19, 19, 19, 19, 19, 19, 18, 18, 17, 17, 16, 16, 15, 14, 13, 12, 10, 8, 6, 0},
+};
+
+/* Widens the row spans of the stroke by one disc, dropping rows outside the grid. */
+static void grid_stroke_stamp(Grid* grid, Coordinates center, int radius) {
+    const Uint8* half_widths = GRID_BRUSH_SPANS[radius];
+    int min_y = SDL_max(center.y - radius, 0);
+    int max_y = SDL_min(center.y + radius, grid->height - 1);
+    for (int y = min_y; y <= max_y; y++) {
+        int* row = &grid->stroke_rows[2 * y];
+        int half_width = half_widths[SDL_abs(y - center.y)];
+        row[0] = SDL_min(row[0], center.x - half_width);
+        row[1] = SDL_max(row[1], center.x + half_width);
     }
 }
 
-static bool grid_can_place_particle(Grid* grid, Coordinates pos, ParticleType type) {
-    if (!grid || !grid_is_in_bounds(pos))
-        return false;
+/*
+ * Writes `type` over row y from min_x to max_x with fresh colors, drawing the
+ * same ones grid_place_particle would; the caller syncs and wakes.
+ */
+static void grid_write_span(Grid* grid, int y, int min_x, int max_x, ParticleType type) {
+    if (grid->edit_hook)
+        grid->edit_hook(grid->edit_hook_data, grid, (GridRect){min_x, y, max_x, y});
 
-    ParticleType existing_particle_type = grid_get_particle(grid, pos)->type;
-    if (type == existing_particle_type)
-        return false;
+    int row = grid_index(grid, 0, y);
+    SDL_memset(&grid->types[row + min_x], (int)type, (size_t)(max_x - min_x + 1));
 
-    if (type == EMPTY)
-        return true;
-    
-    return particle_type_priority(type) > particle_type_priority(existing_particle_type); 
+    particle_fill_random_colors(type, &grid->colors[row + min_x], max_x - min_x + 1, &grid->random);
+}
+
+/* Writes the runs of a clipped row span the brush may replace, a run at a time, and wakes what changed. */
+static void grid_stroke_fill_row(Grid* grid, int y, int min_x, int max_x, ParticleType type) {
+    const Uint8* types = &grid->types[grid_index(grid, 0, y)];
+    int end = SDL_min(max_x, grid->width - 1);
+
+    int first = -1;
+    int last = -1;
+    for (int x = SDL_max(min_x, 0); x <= end; x++) {
+        if (!grid_brush_replaces(type, (ParticleType)types[x]))
+            continue;
+
+        int run = x;
+        for (; x <= end && grid_brush_replaces(type, (ParticleType)types[x]); x++)
+            grid_count_change(grid, x, y, types[x], (Uint8)type);
+        grid_write_span(grid, y, run, x - 1, type);
+        if (first < 0)
+            first = run;
+        last = x - 1;
+    }
+
+    if (first >= 0) {
+        grid_sync_words(grid, y, first / 64, last / 64);
+        grid_wake_region(grid, (GridRect){first - 1, y - 1, last + 1, y + 1});
+        grid->dirty = true;
+    }
+}
+
+void grid_apply_stroke(Grid* grid, Coordinates from, Coordinates to, int radius, ParticleType type) {
+    if (!grid || !grid_is_in_bounds(grid, from) || !grid_is_in_bounds(grid, to) || radius < 0)
+        return;
+
+    radius = SDL_min(radius, MAX_BRUSH_RADIUS);
+    int min_y = SDL_max(SDL_min(from.y, to.y) - radius, 0);
+    int max_y = SDL_min(SDL_max(from.y, to.y) + radius, grid->height - 1);
+    for (int y = min_y; y <= max_y; y++) {
+        grid->stroke_rows[2 * y] = SDL_MAX_SINT32;
+        grid->stroke_rows[2 * y + 1] = -1;
+    }
+
+    /* Bresenham steps move at most one cell each way, so every row's union stays one span */
+    int dx = SDL_abs(to.x - from.x);
+    int dy = -SDL_abs(to.y - from.y);
+    int step_x = from.x < to.x ? 1 : -1;
+    int step_y = from.y < to.y ? 1 : -1;
+    int error = dx + dy;
+    Coordinates point = from;
+    for (;;) {
+        grid_stroke_stamp(grid, point, radius);
+        if (point.x == to.x && point.y == to.y)
+            break;
+
+        int doubled = 2 * error;
+        if (doubled >= dy) {
+            error += dy;
+            point.x += step_x;
+        }
+        if (doubled <= dx) {
+            error += dx;
+            point.y += step_y;
+        }
+    }
+
+    for (int y = min_y; y <= max_y; y++)
+        grid_stroke_fill_row(grid, y, grid->stroke_rows[2 * y], grid->stroke_rows[2 * y + 1], type);
 }
 
 void grid_apply_brush(Grid* grid, Coordinates center, int radius, ParticleType type) {
-    if (!grid || !grid_is_in_bounds(center) || radius < 0)
+    grid_apply_stroke(grid, center, center, radius, type);
+}
+
+/* Brings bitboards and counts in line with cells written inside `region` and wakes around it. */
+static void grid_finish_edit(Grid* grid, GridRect region) {
+    grid_sync_bitboards(grid, region);
+    grid_sync_counts(grid, region);
+    grid_wake_region(grid, (GridRect){region.min_x - 1, region.min_y - 1, region.max_x + 1, region.max_y + 1});
+    grid->dirty = true;
+}
+
+void grid_fill_rect(Grid* grid, GridRect region, ParticleType type) {
+    if (!grid || !grid->arena || (unsigned)type >= PARTICLE_TYPE_COUNT)
         return;
 
-    for (int dy = -radius; dy <= radius; dy++) {
-        for (int dx = -radius; dx <= radius; dx++) {
-            if (dx * dx + dy * dy > radius * radius)
-                continue;
+    region = grid_rect_intersect(region, (GridRect){0, 0, grid->width - 1, grid->height - 1});
+    if (grid_rect_is_empty(region))
+        return;
+
+    for (int y = region.min_y; y <= region.max_y; y++)
+        grid_write_span(grid, y, region.min_x, region.max_x, type);
+    grid_finish_edit(grid, region);
+}
+
+void grid_copy_region(Grid* destination, Coordinates at, const Grid* source, GridRect region) {
+    if (!destination || !destination->arena || !source || !source->arena)
+        return;
+
+    /*
+     * Take the offset before clipping, so a region starting off the source doesn't
+     * shift the copy; then clip to the source, then the shifted rect to the
+     * destination, and carry that back
+     */
+    int dx = at.x - region.min_x;
+    int dy = at.y - region.min_y;
+    region = grid_rect_intersect(region, (GridRect){0, 0, source->width - 1, source->height - 1});
+    if (grid_rect_is_empty(region))
+        return;
+    GridRect target = grid_rect_intersect(
+        (GridRect){region.min_x + dx, region.min_y + dy, region.max_x + dx, region.max_y + dy},
+        (GridRect){0, 0, destination->width - 1, destination->height - 1});
+    if (grid_rect_is_empty(target))
+        return;
+
+    if (destination->edit_hook)
+        destination->edit_hook(destination->edit_hook_data, destination, target);
+
+    /* Within one grid, rows moving down are copied bottom up so none is overwritten before it is read */
+    int rows = target.max_y - target.min_y + 1;
+    size_t width = (size_t)(target.max_x - target.min_x + 1);
+    bool bottom_up = destination == source && dy > 0;
+    for (int i = 0; i < rows; i++) {
+        int y = bottom_up ? target.max_y - i : target.min_y + i;
+        int to = grid_index(destination, target.min_x, y);
+        int from = grid_index(source, target.min_x - dx, y - dy);
+        SDL_memmove(&destination->types[to], &source->types[from], width);
+        SDL_memmove(&destination->colors[to], &source->colors[from], width * sizeof(SDL_Color));
+    }
+    grid_finish_edit(destination, target);
+}
+
+/* Cells still to grow a span from. */
+typedef struct grid_flood_stack {
+    Coordinates* seeds;
+    int count;
+    int capacity;
+} GridFloodStack;
+
+static bool grid_flood_push(GridFloodStack* stack, Coordinates seed) {
+    if (stack->count == stack->capacity) {
+        int capacity = stack->capacity ? 2 * stack->capacity : 256;
+        Coordinates* seeds = SDL_realloc(stack->seeds, (size_t)capacity * sizeof(Coordinates));
+        if (!seeds)
+            return false;
+        stack->seeds = seeds;
+        stack->capacity = capacity;
+    }
+    stack->seeds[stack->count++] = seed;
+    return true;
+}
+
+/*
+ * Grows each seed into the widest span of the old type on its row, fills it
+ * and pushes one seed per run of the old type right above and below it. The
+ * padding ring never holds a material, so no scan needs a bounds check.
+ */
+bool grid_flood_fill(Grid* grid, Coordinates seed, ParticleType type) {
+    if (!grid || !grid_is_in_bounds(grid, seed) || (unsigned)type >= PARTICLE_TYPE_COUNT)
+        return false;
+
+    Uint8 old_type = grid->types[grid_index(grid, seed.x, seed.y)];
+    if (old_type == type)
+        return true;
+
+    GridFloodStack stack = {0};
+    GridRect filled = GRID_RECT_EMPTY;
+    bool pushed = grid_flood_push(&stack, seed);
+    while (pushed && stack.count > 0) {
+        Coordinates cell = stack.seeds[--stack.count];
+        const Uint8* types = &grid->types[grid_index(grid, 0, cell.y)];
+        if (types[cell.x] != old_type)
+            continue;
+
+        int min_x = cell.x;
+        int max_x = cell.x;
+        while (types[min_x - 1] == old_type)
+            min_x--;
+        while (types[max_x + 1] == old_type)
+            max_x++;
+        grid_write_span(grid, cell.y, min_x, max_x, type);
+        grid_rect_extend(&filled, (GridRect){min_x, cell.y, max_x, cell.y});
 
-            Coordinates pos = {center.x + dx, center.y + dy};
-            if (grid_can_place_particle(grid, pos, type)) 
-                grid_place_particle(grid, pos, type);
+        for (int y = cell.y - 1; y <= cell.y + 1 && pushed; y += 2) {
+            const Uint8* row = &grid->types[grid_index(grid, 0, y)];
+            for (int x = min_x; x <= max_x && pushed; x++) {
+                if (row[x] == old_type && (x == min_x || row[x - 1] != old_type))
+                    pushed = grid_flood_push(&stack, (Coordinates){x, y});
+            }
         }
     }
-}
\ No newline at end of file
+    SDL_free(stack.seeds);
+
+    if (!grid_rect_is_empty(filled))
+        grid_finish_edit(grid, filled);
+    if (!pushed)
+        SDL_Log("Couldn't grow the flood fill, it was left partly done.");
+    return pushed;
+}
@@ -5,31 +5,246 @@
 
 #include "config/simulation_config.h"
 #include "display/display.h"
+#include "margolus/margolus.h"
 #include "particle/particle.h"
+#include "random/random.h"
 #include "types.h"
+#include "workers/workers.h"
 
+/* Inclusive cell bounds; empty when min_x > max_x. */
+typedef struct grid_rect {
+    int min_x;
+    int min_y;
+    int max_x;
+    int max_y;
+} GridRect;
+
+static const GridRect GRID_RECT_EMPTY = {SDL_MAX_SINT32, SDL_MAX_SINT32, -1, -1};
+
+static inline bool grid_rect_is_empty(GridRect rect) {
+    return rect.min_x > rect.max_x || rect.min_y > rect.max_y;
+}
+
+static inline void grid_rect_extend(GridRect* rect, GridRect other) {
+    rect->min_x = SDL_min(rect->min_x, other.min_x);
+    rect->min_y = SDL_min(rect->min_y, other.min_y);
+    rect->max_x = SDL_max(rect->max_x, other.max_x);
+    rect->max_y = SDL_max(rect->max_y, other.max_y);
+}
+
+static inline GridRect grid_rect_intersect(GridRect a, GridRect b) {
+    return (GridRect){SDL_max(a.min_x, b.min_x), SDL_max(a.min_y, b.min_y),
+                      SDL_min(a.max_x, b.max_x), SDL_min(a.max_y, b.max_y)};
+}
+
+/*
+ * A chunk only gets visited by grid_update while it is active. `dirty` holds the
+ * cells to visit this tick and may still grow while the tick runs, `next_dirty`
+ * collects the cells woken up for the following tick. The lock also guards the
+ * chunk's entry in the grid's paint array.
+ *
+ * `counts` follow every edit right away; a tick recounts the chunks it woke
+ * once it ends, since moves across chunk borders may race within it.
+ */
+typedef struct grid_chunk {
+    GridRect dirty;
+    GridRect next_dirty;
+    GridRect last_dirty; /* `dirty` of the previous tick, for grid_update_margolus */
+    Uint16 counts[PARTICLE_TYPE_COUNT]; /* cells of each material */
+    bool active;
+    SDL_SpinLock lock;
+} GridChunk;
+
+/*
+ * One moved bit per cell, GRID_MOVED_BITS to a word, so a word covers half a
+ * chunk row and chunks of one checkerboard phase never write the same word.
+ */
+#define GRID_MOVED_BITS 16
+
+/* Type stored in the padding ring around the grid: never empty, never solid. */
+#define GRID_BORDER_TYPE 0xFF
+
+/* Hears about each span a brush or region edit is about to write, before it changes; ticks never call it. */
+struct grid;
+typedef void (*GridEditHook)(void* data, const struct grid* grid, GridRect region);
+
+/*
+ * Cells are stored as separate planes so the update loop only has to pull in
+ * the one-byte type plane; colors are touched when something moves or renders.
+ * The color plane doubles as the RGBA32 pixel buffer: grid_render hands its
+ * rows to the texture as they are, with a pitch of stride * sizeof(SDL_Color).
+ *
+ * All planes share one cache-line-aligned arena and one row stride. Each plane
+ * has a padding row above and below the grid and at least one padding column
+ * to the right, which also serves as the left neighbor of the next row, so
+ * every neighbor of an in-bounds cell is a valid index holding GRID_BORDER_TYPE.
+ *
+ * The occupied and solid bitboards mirror the type plane from the top padding
+ * row to the bottom one at one bit per cell, 64 cells to a word; rows are
+ * bit_stride words, so no word straddles two rows. `occupied` marks cells that
+ * aren't empty, `solid` ones that block grains, and padding counts as both.
+ * Edits keep them in sync right away, ticks once at their end.
+ *
+ * `moved` marks the cells a tick has moved a particle into, so nothing moves
+ * twice in one tick; it shares the cell index, has no padding rows, and every
+ * bit is clear again once the tick ends.
+ *
+ * `intents` and `claims` are laid out like the type plane and only used by
+ * grid_update_buffered: a mover's chosen target, and the rank of the best claim
+ * on each target. Both are zero again once the tick ends.
+ */
 typedef struct grid {
-    Particle particles[GRID_HEIGHT][GRID_WIDTH];
+    int width;
+    int height;
+    int stride;
+    int chunks_x;
+    int chunks_y;
+    void* arena;
+    size_t arena_size;
+    Uint8* types;
+    SDL_Color* colors;
+    Uint64* occupied;
+    Uint64* solid;
+    int bit_stride; /* words per bitboard row */
+    Uint16* moved;
+    Uint8* intents;
+    Uint8* claims;
+    int counts[PARTICLE_TYPE_COUNT]; /* cells of each material in the whole grid, kept with the chunks' */
+    GridChunk* chunks;
+    GridRect* paint; /* per chunk: cells grid_render still has to upload */
+    int* stroke_rows; /* per row: min and max x of the stroke being applied */
+    MargolusRules margolus;
     bool update_left_to_right;
+    bool deterministic; /* grid_update_parallel runs grid_update's scan, so it matches it bit for bit */
     bool dirty;
-    Uint8 current_gen;
+    Uint64 seed;
+    Uint64 tick_count;
+    Random random; /* placement colors; updates draw from per-tick streams of `seed` */
+    GridEditHook edit_hook; /* NULL for none */
+    void* edit_hook_data;
 } Grid;
 
+static inline int grid_index(const Grid* grid, int x, int y) {
+    return y * grid->stride + x;
+}
+
+/* Row y of a bitboard; bit i of word w is the cell at x = 64 * w + i. */
+static inline const Uint64* grid_bitboard_row(const Grid* grid, const Uint64* bitboard, int y) {
+    return bitboard + y * grid->bit_stride;
+}
+
+/* Cells of word `word` in row y holding a mover right above an empty cell. */
+static inline Uint64 grid_falling_bits(const Grid* grid, int word, int y) {
+    Uint64 movers = grid_bitboard_row(grid, grid->occupied, y)[word] & ~grid_bitboard_row(grid, grid->solid, y)[word];
+    return movers & ~grid_bitboard_row(grid, grid->occupied, y + 1)[word];
+}
+
+static inline GridChunk* grid_chunk_at(const Grid* grid, int chunk_x, int chunk_y) {
+    return &grid->chunks[chunk_y * grid->chunks_x + chunk_x];
+}
+
 bool grid_reset(Grid* grid);
-bool grid_initialize(Grid *grid);
+bool grid_initialize(Grid *grid, int width, int height);
+void grid_destroy(Grid* grid);
 
 void grid_update(Grid* grid);
+/*
+ * Updates active chunks in four checkerboard phases spread over the pool.
+ * Tie-breaks come from per-chunk streams seeded by grid_set_seed, so the result
+ * is identical for any thread count, including running inline with no pool.
+ * Phases visit cells in another order than grid_update and draw from other
+ * streams, so the two runs differ; with `deterministic` set this runs
+ * grid_update instead, for runs that must match the serial one exactly.
+ */
+void grid_update_parallel(Grid* grid, WorkerPool* workers);
+/*
+ * Alternate engine: steps 2x2 Margolus blocks through a lookup table instead
+ * of scanning cells, so no result depends on visit order and no particle can
+ * move twice. Blocks are independent, so every chunk runs at once on the pool,
+ * or inline with no pool. Liquids flow one cell per tick here.
+ */
+void grid_update_margolus(Grid* grid, WorkerPool* workers);
+/*
+ * Alternate engine with the scan's rules, stepped as if from a front buffer to
+ * a back one: every mover picks a target from the types as the last tick left
+ * them, movers that pick the same cell are ranked, and only then do winners
+ * move. Nothing depends on visit order or on update_left_to_right, ties come
+ * from stateless hashes of seed, tick and cell, and the result is identical
+ * for any thread count. Chains don't move in one tick here: no mover takes a
+ * cell that is being vacated in the same tick.
+ */
+void grid_update_buffered(Grid* grid, WorkerPool* workers);
+/* Seeds placement colors and every update stream; same seed and edits, same run. */
+void grid_set_seed(Grid* grid, Uint64 seed);
 
+/* Uploads only the painted chunk rects, merging neighbors into as few updates as it can. */
 void grid_render(Grid* grid, Display* display);
+/*
+ * Uploads one rect per chunk of `colors`, a plane laid out like the grid's color
+ * plane, the same way grid_render does. False as soon as an update fails.
+ */
+bool grid_upload_paint(const Grid* grid, SDL_Texture* texture, const SDL_Color* colors, const GridRect* paint);
+
+typedef struct grid_cell_counts {
+    int occupied;
+    int solid;
+} GridCellCounts;
+
+/* Occupied and solid cells in `region`, clipped to the grid, counted a word at a time. */
+GridCellCounts grid_count_cells(const Grid* grid, GridRect region);
+/* Rebuilds the bitboards over `region` from the type plane, for code that writes types directly. */
+void grid_sync_bitboards(Grid* grid, GridRect region);
+
+typedef struct grid_material_counts {
+    int counts[PARTICLE_TYPE_COUNT];
+} GridMaterialCounts;
+
+/* Cells of `type` in the whole grid, kept up to date rather than counted. */
+int grid_get_material_count(const Grid* grid, ParticleType type);
+/*
+ * Cells of each material in `region`, clipped to the grid. Chunks the region
+ * covers whole add their counts, only the cells along its edges are scanned.
+ */
+GridMaterialCounts grid_count_materials(const Grid* grid, GridRect region);
+/* Recounts every chunk `region` touches, for code that writes types directly. */
+void grid_sync_counts(Grid* grid, GridRect region);
 
 void grid_swap(Grid* grid, Coordinates source, Coordinates destination);
+void grid_wake_region(Grid* grid, GridRect region);
+bool grid_is_chunk_active(Grid* grid, Coordinates coordinates);
 
-const Particle* grid_get_particle(Grid* grid, Coordinates coordinates);
+bool grid_get_particle(Grid* grid, Coordinates coordinates, Particle* particle);
+ParticleType grid_get_particle_type(Grid* grid, Coordinates coordinates);
 bool grid_place_particle(Grid* grid, Coordinates coordinates, ParticleType type);
 bool grid_set_particle(Grid* grid, Coordinates coordinates, const Particle* particle);
+/* A stroke from `center` to itself; radii above MAX_BRUSH_RADIUS are clamped to it. */
 void grid_apply_brush(Grid* grid, Coordinates center, int radius, ParticleType type);
+/*
+ * Fills the capsule swept by a brush moving from `from` to `to`, exactly the
+ * cells a stamp at every step of the line between them would cover, one row
+ * span at a time. Both ends must be in bounds.
+ */
+void grid_apply_stroke(Grid* grid, Coordinates from, Coordinates to, int radius, ParticleType type);
+
+/*
+ * Region edits clip once, write whole row spans, then sync the bitboards and
+ * counts and wake what changed in one go. Unlike the brush they overwrite
+ * whatever is there, and new cells get their material's color variation.
+ */
+void grid_fill_rect(Grid* grid, GridRect region, ParticleType type);
+/*
+ * Copies the types and colors of `region` in `source` so its top left cell
+ * lands on `at` in `destination`, clipped to both grids. Both may be the same
+ * grid, with the two rects overlapping.
+ */
+void grid_copy_region(Grid* destination, Coordinates at, const Grid* source, GridRect region);
+/*
+ * Scanline fill of the cells 4-connected to `seed` that share its type. False
+ * on bad arguments, or when out of memory with the fill left partly done.
+ */
+bool grid_flood_fill(Grid* grid, Coordinates seed, ParticleType type);
 
-bool grid_is_in_bounds(Coordinates coordinates);
+bool grid_is_in_bounds(Grid* grid, Coordinates coordinates);
 bool grid_is_particle_empty(Grid* grid, Coordinates coordinates);
 bool grid_is_particle_solid(Grid* grid, Coordinates coordinates);
 
@@ -0,0 +1,324 @@
+/*
+ * Headless runner: builds a scene, loads a snapshot or replays a recorded
+ * journal, steps it as
+ * fast as possible and reports simulation throughput. No window, renderer or
+ * video subsystem is created.
+ */
+
+#include <SDL3/SDL.h>
+#include <stdio.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#endif
+
+#include "config/simulation_config.h"
+#include "grid/grid.h"
+#include "history/history.h"
+#include "journal/journal.h"
+#include "scenario/scenario.h"
+#include "snapshot/snapshot.h"
+#include "workers/workers.h"
+
+#define HEADLESS_DEFAULT_TICKS 1000
+#define HEADLESS_DEFAULT_SEED 1
+
+typedef enum headless_engine {
+    HEADLESS_ENGINE_SCAN,
+    HEADLESS_ENGINE_MARGOLUS,
+    HEADLESS_ENGINE_BUFFERED,
+} HeadlessEngine;
+
+typedef struct headless_options {
+    int width;
+    int height;
+    int ticks;
+    int warmup_ticks;
+    int threads; /* < 0 keeps the serial scan */
+    bool deterministic;
+    HeadlessEngine engine;
+    Uint64 seed;
+    ScenarioKind scenario;
+    const char* replay_path;
+    const char* load_path;
+    const char* save_path;
+} HeadlessOptions;
+
+typedef struct headless_timing {
+    Uint64 total;
+    Uint64 slowest;
+    Uint64 slowest_tick;
+    int ticks;
+} HeadlessTiming;
+
+static void headless_print_usage(void) {
+    fprintf(stderr,
+            "Usage: falling_sand_headless [options]\n"
+            "  --size WIDTHxHEIGHT   grid size (default %dx%d)\n"
+            "  --scenario NAME       empty, settled, pile, avalanche, noise, flood (default avalanche)\n"
+            "  --ticks N             measured ticks (default %d)\n"
+            "  --warmup N            unmeasured ticks run first (default 0)\n"
+            "  --seed N              scene and tie-break seed (default %d)\n"
+            "  --threads N           checkerboard update with N extra threads; omit for the serial scan\n"
+            "  --deterministic on    run the serial scan's order even with --threads, for checksums\n"
+            "                        that match a serial run\n"
+            "  --engine NAME         scan, margolus or buffered (default scan); the last two use\n"
+            "                        --threads too\n"
+            "  --replay FILE         replay a journal recorded with falling_sand --record; size, seed\n"
+            "                        and update mode come from the journal\n"
+            "  --load FILE           start from a snapshot instead of a scenario; size and seed come\n"
+            "                        from the snapshot\n"
+            "  --save FILE           write a snapshot of the final world\n",
+            GRID_WIDTH, GRID_HEIGHT, HEADLESS_DEFAULT_TICKS, HEADLESS_DEFAULT_SEED);
+}
+
+static bool headless_parse_options(int argc, char* argv[], HeadlessOptions* options) {
+    *options = (HeadlessOptions){
+        .width = GRID_WIDTH,
+        .height = GRID_HEIGHT,
+        .ticks = HEADLESS_DEFAULT_TICKS,
+        .warmup_ticks = 0,
+        .threads = -1,
+        .seed = HEADLESS_DEFAULT_SEED,
+        .scenario = SCENARIO_AVALANCHE,
+    };
+
+    for (int i = 1; i < argc; i++) {
+        const char* option = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : NULL;
+        if (!value)
+            return false;
+        i++;
+
+        if (SDL_strcmp(option, "--size") == 0) {
+            if (SDL_sscanf(value, "%dx%d", &options->width, &options->height) != 2)
+                return false;
+        } else if (SDL_strcmp(option, "--scenario") == 0) {
+            if (!scenario_find(value, &options->scenario))
+                return false;
+        } else if (SDL_strcmp(option, "--ticks") == 0) {
+            options->ticks = SDL_atoi(value);
+        } else if (SDL_strcmp(option, "--warmup") == 0) {
+            options->warmup_ticks = SDL_atoi(value);
+        } else if (SDL_strcmp(option, "--seed") == 0) {
+            options->seed = SDL_strtoull(value, NULL, 10);
+        } else if (SDL_strcmp(option, "--threads") == 0) {
+            options->threads = SDL_atoi(value);
+        } else if (SDL_strcmp(option, "--deterministic") == 0) {
+            if (SDL_strcmp(value, "on") == 0)
+                options->deterministic = true;
+            else if (SDL_strcmp(value, "off") != 0)
+                return false;
+        } else if (SDL_strcmp(option, "--engine") == 0) {
+            if (SDL_strcmp(value, "scan") == 0)
+                options->engine = HEADLESS_ENGINE_SCAN;
+            else if (SDL_strcmp(value, "margolus") == 0)
+                options->engine = HEADLESS_ENGINE_MARGOLUS;
+            else if (SDL_strcmp(value, "buffered") == 0)
+                options->engine = HEADLESS_ENGINE_BUFFERED;
+            else
+                return false;
+        } else if (SDL_strcmp(option, "--replay") == 0) {
+            options->replay_path = value;
+        } else if (SDL_strcmp(option, "--load") == 0) {
+            options->load_path = value;
+        } else if (SDL_strcmp(option, "--save") == 0) {
+            options->save_path = value;
+        } else {
+            return false;
+        }
+    }
+
+    return options->width > 0 && options->height > 0 && options->ticks > 0 && options->warmup_ticks >= 0 &&
+           options->threads <= WORKERS_MAX_THREADS && !(options->replay_path && options->load_path);
+}
+
+/* Peak resident set size in bytes, or 0 where the platform doesn't say. */
+static Uint64 headless_peak_rss(void) {
+#if defined(__APPLE__)
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0)
+        return (Uint64)usage.ru_maxrss;
+#elif defined(__unix__)
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0)
+        return (Uint64)usage.ru_maxrss * 1024;
+#endif
+    return 0;
+}
+
+static void headless_step(Grid* grid, WorkerPool* workers, const HeadlessOptions* options, HeadlessTiming* timing) {
+    Uint64 start = SDL_GetPerformanceCounter();
+    if (options->engine == HEADLESS_ENGINE_MARGOLUS)
+        grid_update_margolus(grid, workers);
+    else if (options->engine == HEADLESS_ENGINE_BUFFERED)
+        grid_update_buffered(grid, workers);
+    else if (options->threads < 0)
+        grid_update(grid);
+    else
+        grid_update_parallel(grid, workers);
+    Uint64 elapsed = SDL_GetPerformanceCounter() - start;
+
+    if (!timing)
+        return;
+
+    if (elapsed > timing->slowest) {
+        timing->slowest = elapsed;
+        timing->slowest_tick = grid->tick_count - 1;
+    }
+    timing->total += elapsed;
+    timing->ticks++;
+}
+
+/* FNV-1a over the type and color planes, to tell whether two runs ended in the same world. */
+static Uint64 headless_checksum(const Grid* grid) {
+    Uint64 hash = 0xCBF29CE484222325ull;
+    for (int y = 0; y < grid->height; y++) {
+        const Uint8* types = &grid->types[grid_index(grid, 0, y)];
+        const Uint8* colors = (const Uint8*)&grid->colors[grid_index(grid, 0, y)];
+        for (int x = 0; x < grid->width; x++)
+            hash = (hash ^ types[x]) * 0x100000001B3ull;
+        for (int i = 0; i < grid->width * (int)sizeof(SDL_Color); i++)
+            hash = (hash ^ colors[i]) * 0x100000001B3ull;
+    }
+    return hash;
+}
+
+/* Steps up to each event's tick and applies it, until the END event. */
+static bool headless_replay(Grid* grid, History* history, WorkerPool* workers, Journal* journal,
+                            const HeadlessOptions* options, HeadlessTiming* timing, int* events) {
+    JournalEvent event;
+    while (journal_read_event(journal, &event)) {
+        while (grid->tick_count < event.tick)
+            headless_step(grid, workers, options, timing);
+
+        if (event.kind == JOURNAL_EVENT_END)
+            return true;
+
+        journal_apply_event(grid, history, &event);
+        (*events)++;
+    }
+
+    SDL_Log("Journal is truncated or corrupt after tick %llu.", (unsigned long long)grid->tick_count);
+    return false;
+}
+
+int main(int argc, char* argv[]) {
+    HeadlessOptions options;
+    if (!headless_parse_options(argc, argv, &options)) {
+        headless_print_usage();
+        return 1;
+    }
+
+    Journal journal = {0};
+    Snapshot snapshot = {0};
+    if (options.load_path) {
+        if (!snapshot_open(&snapshot, options.load_path))
+            return 1;
+
+        options.width = snapshot.header.width;
+        options.height = snapshot.header.height;
+        options.seed = snapshot.header.seed;
+    } else if (options.replay_path) {
+        JournalHeader header;
+        if (!journal_open_read(&journal, options.replay_path, &header))
+            return 1;
+
+        options.width = header.width;
+        options.height = header.height;
+        options.seed = header.seed;
+        if (header.flags & JOURNAL_FLAG_PARALLEL)
+            options.threads = SDL_max(options.threads, 0);
+        else
+            options.threads = -1;
+        options.engine = HEADLESS_ENGINE_SCAN;
+    }
+
+    int status = 1;
+    Grid grid = {0};
+    History history = {0};
+    WorkerPool workers = {0};
+    if (!grid_initialize(&grid, options.width, options.height)) {
+        SDL_Log("Couldn't initialize Grid.");
+        goto failed;
+    }
+    grid.deterministic = options.deterministic;
+
+    if (!workers_initialize(&workers, SDL_max(options.threads, 0))) {
+        SDL_Log("Couldn't initialize WorkerPool.");
+        goto failed;
+    }
+
+    HeadlessTiming timing = {0};
+    int events = 0;
+    if (options.replay_path) {
+        grid_set_seed(&grid, options.seed);
+        /* Same history budget as the interactive build, so undo and redo replay the same */
+        if (!history_initialize(&history, &grid, HISTORY_MEMORY_BUDGET, HISTORY_MAX_ENTRIES) ||
+            !headless_replay(&grid, &history, &workers, &journal, &options, &timing, &events))
+            goto failed;
+        printf("replay     %s %dx%d seed %llu, %d events\n", options.replay_path, options.width, options.height,
+               (unsigned long long)options.seed, events);
+    } else {
+        if (options.load_path) {
+            Uint64 start = SDL_GetPerformanceCounter();
+            if (!snapshot_load(&snapshot, &grid, &workers))
+                goto failed;
+            snapshot_close(&snapshot);
+            double load_ms = (double)(SDL_GetPerformanceCounter() - start) * 1e3 / (double)SDL_GetPerformanceFrequency();
+            printf("snapshot   %s %dx%d tick %llu, loaded in %.3f ms\n", options.load_path, options.width,
+                   options.height, (unsigned long long)grid.tick_count, load_ms);
+        } else {
+            scenario_generate(&grid, options.scenario, options.seed);
+            printf("scenario   %s %dx%d seed %llu\n", scenario_get_name(options.scenario), options.width,
+                   options.height, (unsigned long long)options.seed);
+        }
+        for (int i = 0; i < options.warmup_ticks; i++)
+            headless_step(&grid, &workers, &options, NULL);
+        for (int i = 0; i < options.ticks; i++)
+            headless_step(&grid, &workers, &options, &timing);
+    }
+
+    double frequency = (double)SDL_GetPerformanceFrequency();
+    double seconds = (double)timing.total / frequency;
+    double cells = (double)options.width * (double)options.height * (double)SDL_max(timing.ticks, 1);
+
+    static const char* engine_names[] = {
+        [HEADLESS_ENGINE_MARGOLUS] = "margolus",
+        [HEADLESS_ENGINE_BUFFERED] = "buffered",
+    };
+    const char* update = options.engine != HEADLESS_ENGINE_SCAN               ? engine_names[options.engine]
+                         : options.threads < 0 || options.deterministic ? "serial"
+                                                                        : "checkerboard";
+    printf("update     %s\n", update);
+    printf("threads    %d\n", SDL_max(options.threads, 0));
+    printf("ticks      %d in %.3f s\n", timing.ticks, seconds);
+    printf("ticks/s    %.1f\n", seconds > 0.0 ? timing.ticks / seconds : 0.0);
+    printf("ns/cell    %.3f\n", seconds * 1e9 / cells);
+    printf("slowest    tick %llu, %.3f ms\n", (unsigned long long)timing.slowest_tick,
+           (double)timing.slowest * 1e3 / frequency);
+    printf("checksum   %016llx\n", (unsigned long long)headless_checksum(&grid));
+
+    Uint64 peak_rss = headless_peak_rss();
+    if (peak_rss)
+        printf("peak RSS   %.1f MiB\n", (double)peak_rss / (1024.0 * 1024.0));
+    else
+        printf("peak RSS   n/a\n");
+
+    if (options.save_path) {
+        if (!snapshot_save(&grid, options.save_path))
+            goto failed;
+        printf("saved      %s\n", options.save_path);
+    }
+
+    status = 0;
+
+failed:
+    snapshot_close(&snapshot);
+    if (journal.io)
+        journal_close(&journal, 0);
+    history_destroy(&history);
+    workers_destroy(&workers);
+    grid_destroy(&grid);
+    return status;
+}
@@ -0,0 +1,348 @@
+#include "history/history.h"
+
+static GridRect history_chunk_bounds(const Grid* grid, int index) {
+    int chunk_x = index % grid->chunks_x;
+    int chunk_y = index / grid->chunks_x;
+    return (GridRect){
+        chunk_x * GRID_CHUNK_SIZE,
+        chunk_y * GRID_CHUNK_SIZE,
+        SDL_min((chunk_x + 1) * GRID_CHUNK_SIZE, grid->width) - 1,
+        SDL_min((chunk_y + 1) * GRID_CHUNK_SIZE, grid->height) - 1
+    };
+}
+
+static bool history_fits(const History* history, const Grid* grid) {
+    return history && history->entries && grid && grid->arena &&
+           grid->chunks_x == history->chunks_x && grid->chunks_x * grid->chunks_y == history->chunk_count;
+}
+
+bool history_initialize(History* history, const Grid* grid, size_t budget, int max_entries) {
+    if (!history || !grid || !grid->arena || max_entries <= 0)
+        return false;
+
+    *history = (History){
+        .max_entries = max_entries,
+        .budget = budget,
+        .chunk_count = grid->chunks_x * grid->chunks_y,
+        .chunks_x = grid->chunks_x,
+    };
+
+    history->entries = SDL_calloc((size_t)max_entries, sizeof(HistoryEntry));
+    history->latest = SDL_calloc((size_t)history->chunk_count, sizeof(HistoryChunk*));
+    history->marks = SDL_calloc((size_t)history->chunk_count, sizeof(Uint64));
+    if (!history->entries || !history->latest || !history->marks) {
+        SDL_Log("Couldn't allocate history.");
+        goto failed;
+    }
+
+    return true;
+
+failed:
+    history_destroy(history);
+    return false;
+}
+
+static bool history_matches(const HistoryChunk* version, const Grid* grid, GridRect bounds) {
+    size_t width = (size_t)(bounds.max_x - bounds.min_x + 1);
+    for (int y = bounds.min_y; y <= bounds.max_y; y++) {
+        int row = grid_index(grid, bounds.min_x, y);
+        int saved = (y - bounds.min_y) * GRID_CHUNK_SIZE;
+        if (SDL_memcmp(&version->types[saved], &grid->types[row], width) != 0 ||
+            SDL_memcmp(&version->colors[saved], &grid->colors[row], width * sizeof(SDL_Color)) != 0)
+            return false;
+    }
+    return true;
+}
+
+/* The chunk as it is now: its newest version when the cells still match, otherwise a new one. */
+static HistoryChunk* history_capture(History* history, const Grid* grid, int index) {
+    GridRect bounds = history_chunk_bounds(grid, index);
+    HistoryChunk* latest = history->latest[index];
+    if (latest && history_matches(latest, grid, bounds)) {
+        latest->refs++;
+        return latest;
+    }
+
+    HistoryChunk* version = SDL_malloc(sizeof(HistoryChunk));
+    if (!version)
+        return NULL;
+    version->refs = 1;
+    version->index = index;
+
+    size_t width = (size_t)(bounds.max_x - bounds.min_x + 1);
+    for (int y = bounds.min_y; y <= bounds.max_y; y++) {
+        int row = grid_index(grid, bounds.min_x, y);
+        int saved = (y - bounds.min_y) * GRID_CHUNK_SIZE;
+        SDL_memcpy(&version->types[saved], &grid->types[row], width);
+        SDL_memcpy(&version->colors[saved], &grid->colors[row], width * sizeof(SDL_Color));
+    }
+
+    history->latest[index] = version;
+    history->bytes += sizeof(HistoryChunk);
+    return version;
+}
+
+static void history_release(History* history, HistoryChunk* version) {
+    if (--version->refs > 0)
+        return;
+
+    if (history->latest[version->index] == version)
+        history->latest[version->index] = NULL;
+    history->bytes -= sizeof(HistoryChunk);
+    SDL_free(version);
+}
+
+/* Writes a version back into its chunk, then syncs and wakes it like any other direct edit. */
+static void history_write(Grid* grid, const HistoryChunk* version) {
+    GridRect bounds = history_chunk_bounds(grid, version->index);
+    size_t width = (size_t)(bounds.max_x - bounds.min_x + 1);
+    for (int y = bounds.min_y; y <= bounds.max_y; y++) {
+        int row = grid_index(grid, bounds.min_x, y);
+        int saved = (y - bounds.min_y) * GRID_CHUNK_SIZE;
+        SDL_memcpy(&grid->types[row], &version->types[saved], width);
+        SDL_memcpy(&grid->colors[row], &version->colors[saved], width * sizeof(SDL_Color));
+    }
+
+    grid_sync_bitboards(grid, bounds);
+    grid_sync_counts(grid, bounds);
+    grid_wake_region(grid, (GridRect){bounds.min_x - 1, bounds.min_y - 1, bounds.max_x + 1, bounds.max_y + 1});
+    grid->dirty = true;
+}
+
+static void history_drop(History* history, int index) {
+    HistoryEntry* entry = &history->entries[index];
+    for (int i = 0; i < entry->count; i++)
+        history_release(history, entry->chunks[i]);
+    SDL_free(entry->chunks);
+
+    SDL_memmove(entry, entry + 1, (size_t)(history->count - index - 1) * sizeof(HistoryEntry));
+    history->count--;
+    if (index < history->position)
+        history->position--;
+}
+
+/* Drops entries until the budget holds, `keep` last; false when even that one had to go. */
+static bool history_trim(History* history, int keep) {
+    while (history->bytes > history->budget && history->count > 0) {
+        int victim = keep;
+        if (history->position > 0 && keep != 0)
+            victim = 0;
+        else if (history->count > history->position && history->count - 1 != keep)
+            victim = history->count - 1;
+
+        history_drop(history, victim);
+        if (victim == keep)
+            return false;
+        if (victim < keep)
+            keep--;
+    }
+    return true;
+}
+
+void history_destroy(History* history) {
+    if (!history)
+        return;
+
+    while (history->entries && history->count > 0)
+        history_drop(history, history->count - 1);
+    SDL_free(history->entries);
+    SDL_free(history->latest);
+    SDL_free(history->marks);
+    *history = (History){0};
+}
+
+void history_begin(History* history) {
+    if (!history)
+        return;
+
+    history->open = false;
+    history->overflowed = false;
+}
+
+static void history_open_entry(History* history) {
+    while (history->count > history->position)
+        history_drop(history, history->count - 1);
+    if (history->count == history->max_entries)
+        history_drop(history, 0);
+
+    history->entries[history->count++] = (HistoryEntry){0};
+    history->position = history->count;
+    history->open = true;
+    history->serial++;
+}
+
+bool history_record(History* history, const Grid* grid, GridRect region) {
+    if (!history_fits(history, grid))
+        return false;
+    if (history->overflowed)
+        return true;
+
+    region = grid_rect_intersect(region, (GridRect){0, 0, grid->width - 1, grid->height - 1});
+    if (grid_rect_is_empty(region))
+        return true;
+
+    if (!history->open)
+        history_open_entry(history);
+    HistoryEntry* entry = &history->entries[history->count - 1];
+
+    for (int cy = region.min_y / GRID_CHUNK_SIZE; cy <= region.max_y / GRID_CHUNK_SIZE; cy++) {
+        for (int cx = region.min_x / GRID_CHUNK_SIZE; cx <= region.max_x / GRID_CHUNK_SIZE; cx++) {
+            int index = cy * grid->chunks_x + cx;
+            if (history->marks[index] == history->serial)
+                continue;
+
+            if (entry->count == entry->capacity) {
+                int capacity = entry->capacity ? 2 * entry->capacity : 16;
+                HistoryChunk** chunks = SDL_realloc(entry->chunks, (size_t)capacity * sizeof(HistoryChunk*));
+                if (!chunks)
+                    goto out_of_memory;
+                entry->chunks = chunks;
+                entry->capacity = capacity;
+            }
+
+            HistoryChunk* version = history_capture(history, grid, index);
+            if (!version)
+                goto out_of_memory;
+            entry->chunks[entry->count++] = version;
+            history->marks[index] = history->serial;
+        }
+    }
+
+    if (!history_trim(history, history->count - 1)) {
+        history->open = false;
+        history->overflowed = true;
+    }
+    return true;
+
+out_of_memory:
+    SDL_Log("Couldn't save chunks for undo, the edit is only partly recorded.");
+    return false;
+}
+
+/* Swaps the chunks of entry `index` with the grid's, so it holds what it replaced. */
+static bool history_swap(History* history, Grid* grid, int index) {
+    HistoryEntry* entry = &history->entries[index];
+    if (entry->count == 0)
+        return true;
+
+    /* Everything is saved before anything is written, so running out of memory leaves the grid alone */
+    HistoryChunk** current = SDL_malloc((size_t)entry->count * sizeof(HistoryChunk*));
+    if (!current)
+        goto out_of_memory;
+    for (int i = 0; i < entry->count; i++) {
+        current[i] = history_capture(history, grid, entry->chunks[i]->index);
+        if (!current[i]) {
+            while (i-- > 0)
+                history_release(history, current[i]);
+            SDL_free(current);
+            goto out_of_memory;
+        }
+    }
+
+    for (int i = 0; i < entry->count; i++) {
+        history_write(grid, entry->chunks[i]);
+        history_release(history, entry->chunks[i]);
+        entry->chunks[i] = current[i];
+    }
+    SDL_free(current);
+    return true;
+
+out_of_memory:
+    SDL_Log("Couldn't save chunks for undo, nothing was changed.");
+    return false;
+}
+
+bool history_undo(History* history, Grid* grid) {
+    if (!history_fits(history, grid) || history->position == 0)
+        return false;
+
+    history_begin(history);
+    if (!history_swap(history, grid, history->position - 1))
+        return false;
+
+    history->position--;
+    history_trim(history, history->position);
+    return true;
+}
+
+bool history_redo(History* history, Grid* grid) {
+    if (!history_fits(history, grid) || history->position == history->count)
+        return false;
+
+    history_begin(history);
+    if (!history_swap(history, grid, history->position))
+        return false;
+
+    history->position++;
+    history_trim(history, history->position - 1);
+    return true;
+}
+
+static void history_record_span(void* data, const Grid* grid, GridRect region) {
+    history_record(data, grid, region);
+}
+
+/* Records into the open entry whatever the grid writes until history_stop_watching. */
+static void history_watch(History* history, Grid* grid) {
+    grid->edit_hook = history ? history_record_span : NULL;
+    grid->edit_hook_data = history;
+}
+
+static void history_stop_watching(Grid* grid) {
+    grid->edit_hook = NULL;
+    grid->edit_hook_data = NULL;
+}
+
+void history_apply_brush(History* history, Grid* grid, Coordinates center, int radius, ParticleType type) {
+    if (!grid)
+        return;
+
+    history_begin(history);
+    history_watch(history, grid);
+    grid_apply_brush(grid, center, radius, type);
+    history_stop_watching(grid);
+}
+
+void history_apply_stroke(History* history, Grid* grid, Coordinates from, Coordinates to, int radius,
+                          ParticleType type) {
+    if (!grid)
+        return;
+
+    history_watch(history, grid);
+    grid_apply_stroke(grid, from, to, radius, type);
+    history_stop_watching(grid);
+}
+
+void history_fill_rect(History* history, Grid* grid, GridRect region, ParticleType type) {
+    if (!grid)
+        return;
+
+    history_begin(history);
+    history_watch(history, grid);
+    grid_fill_rect(grid, region, type);
+    history_stop_watching(grid);
+    history_begin(history);
+}
+
+void history_copy_region(History* history, Grid* destination, Coordinates at, const Grid* source, GridRect region) {
+    if (!destination)
+        return;
+
+    history_begin(history);
+    history_watch(history, destination);
+    grid_copy_region(destination, at, source, region);
+    history_stop_watching(destination);
+    history_begin(history);
+}
+
+bool history_flood_fill(History* history, Grid* grid, Coordinates seed, ParticleType type) {
+    if (!grid)
+        return false;
+
+    history_begin(history);
+    history_watch(history, grid);
+    bool filled = grid_flood_fill(grid, seed, type);
+    history_stop_watching(grid);
+    history_begin(history);
+    return filled;
+}
@@ -0,0 +1,86 @@
+#ifndef FALLING_SAND_HISTORY_H
+#define FALLING_SAND_HISTORY_H
+
+#include <SDL3/SDL.h>
+#include <stdbool.h>
+
+#include "grid/grid.h"
+
+/*
+ * One chunk's types and colors as they were at some point, rows of
+ * GRID_CHUNK_SIZE cells; edge chunks leave the cells past the grid unused.
+ * Versions are immutable and shared: saving a chunk whose cells still match
+ * its newest version only takes another reference to it.
+ */
+typedef struct history_chunk {
+    int refs;
+    int index; /* chunk index in the grid */
+    Uint8 types[GRID_CHUNK_SIZE * GRID_CHUNK_SIZE];
+    SDL_Color colors[GRID_CHUNK_SIZE * GRID_CHUNK_SIZE];
+} HistoryChunk;
+
+/* The chunks one edit touched, as they were before it, or after it once undone. */
+typedef struct history_entry {
+    HistoryChunk** chunks;
+    int count;
+    int capacity;
+} HistoryEntry;
+
+/*
+ * Undo and redo stack over chunk versions. Callers record the region an edit
+ * is about to touch, and only the chunks in it that the open entry doesn't hold
+ * yet get saved. Undoing an entry swaps its chunks with the grid's, so an undo
+ * or redo costs the chunks of that one edit whatever the size of the world.
+ *
+ * `budget` caps the bytes of chunk versions kept alive and `max_entries` the
+ * entries: the oldest undo entries go first, then the newest redo ones. An
+ * entry that alone outgrows the budget is dropped, and the rest of its edit
+ * goes unrecorded.
+ */
+typedef struct history {
+    HistoryEntry* entries; /* oldest first */
+    int count;
+    int position; /* entries below it can be undone, the rest redone */
+    int max_entries;
+    size_t budget;
+    size_t bytes;     /* chunk versions alive */
+    bool open;        /* entries[count - 1] still takes chunks */
+    bool overflowed;  /* the open edit outgrew the budget, so the rest of it is skipped */
+    int chunk_count;  /* of the grid this history belongs to */
+    int chunks_x;
+    HistoryChunk** latest; /* per chunk: its newest saved version, if one is alive */
+    Uint64* marks;         /* per chunk: the entry serial that saved it last */
+    Uint64 serial;
+} History;
+
+bool history_initialize(History* history, const Grid* grid, size_t budget, int max_entries);
+void history_destroy(History* history);
+
+/* Ends the open entry, so the next history_record starts a new one. */
+void history_begin(History* history);
+/*
+ * Saves the chunks `region` touches, as they are now, into the open entry,
+ * starting one if none is open and dropping whatever could be redone. Call it
+ * before the edit. False when out of memory; the edit still goes ahead.
+ */
+bool history_record(History* history, const Grid* grid, GridRect region);
+/* Swap the newest undoable or oldest redoable entry into the grid; false when there is none. */
+bool history_undo(History* history, Grid* grid);
+bool history_redo(History* history, Grid* grid);
+
+/*
+ * Edits that record themselves: the grid reports every span just before
+ * writing it, so a chunk is saved the first time the edit writes to it and
+ * nothing is saved for chunks it only passes over.
+ *
+ * A brush starts a new entry and a stroke adds to the open one, so a drag is
+ * one entry. Region edits are each an entry of their own.
+ */
+void history_apply_brush(History* history, Grid* grid, Coordinates center, int radius, ParticleType type);
+void history_apply_stroke(History* history, Grid* grid, Coordinates from, Coordinates to, int radius,
+                          ParticleType type);
+void history_fill_rect(History* history, Grid* grid, GridRect region, ParticleType type);
+void history_copy_region(History* history, Grid* destination, Coordinates at, const Grid* source, GridRect region);
+bool history_flood_fill(History* history, Grid* grid, Coordinates seed, ParticleType type);
+
+#endif
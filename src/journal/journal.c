@@ -0,0 +1,212 @@
+#include "journal/journal.h"
+
+static const char JOURNAL_MAGIC[4] = {'F', 'S', 'R', 'J'};
+
+/* LEB128: seven bits per byte, high bit set while more bytes follow. */
+static bool journal_write_varint(SDL_IOStream* io, Uint64 value) {
+    do {
+        Uint8 byte = value & 0x7F;
+        value >>= 7;
+        if (value)
+            byte |= 0x80;
+        if (!SDL_WriteU8(io, byte))
+            return false;
+    } while (value);
+    return true;
+}
+
+static bool journal_read_varint(SDL_IOStream* io, Uint64* value) {
+    *value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        Uint8 byte;
+        if (!SDL_ReadU8(io, &byte))
+            return false;
+        *value |= (Uint64)(byte & 0x7F) << shift;
+        if (!(byte & 0x80))
+            return true;
+    }
+    return false;
+}
+
+static bool journal_read_int(SDL_IOStream* io, int* value) {
+    Uint64 raw;
+    if (!journal_read_varint(io, &raw) || raw > SDL_MAX_SINT32)
+        return false;
+    *value = (int)raw;
+    return true;
+}
+
+bool journal_open_write(Journal* journal, const char* path, const JournalHeader* header) {
+    if (!journal || !path || !header || header->width <= 0 || header->height <= 0)
+        return false;
+
+    *journal = (Journal){0};
+    journal->io = SDL_IOFromFile(path, "wb");
+    if (!journal->io) {
+        SDL_Log("Couldn't create journal %s: %s", path, SDL_GetError());
+        return false;
+    }
+    journal->writing = true;
+
+    SDL_IOStream* io = journal->io;
+    if (SDL_WriteIO(io, JOURNAL_MAGIC, sizeof(JOURNAL_MAGIC)) != sizeof(JOURNAL_MAGIC) ||
+        !SDL_WriteU32LE(io, JOURNAL_VERSION) || !SDL_WriteU32LE(io, (Uint32)header->width) ||
+        !SDL_WriteU32LE(io, (Uint32)header->height) || !SDL_WriteU64LE(io, header->seed) ||
+        !SDL_WriteU8(io, header->flags)) {
+        SDL_Log("Couldn't write journal header: %s", SDL_GetError());
+        SDL_CloseIO(io);
+        *journal = (Journal){0};
+        return false;
+    }
+
+    return true;
+}
+
+static bool journal_write_kind(Journal* journal, JournalEventKind kind, Uint64 tick) {
+    if (tick < journal->last_tick)
+        return false;
+
+    bool written = SDL_WriteU8(journal->io, (Uint8)kind) && journal_write_varint(journal->io, tick - journal->last_tick);
+    journal->last_tick = tick;
+    return written;
+}
+
+bool journal_write_event(Journal* journal, const JournalEvent* event) {
+    if (!journal || !journal->io || !journal->writing || !event)
+        return false;
+
+    switch (event->kind) {
+        case JOURNAL_EVENT_STROKE:
+            if (event->from.x < 0 || event->from.y < 0 || event->center.x < 0 || event->center.y < 0 ||
+                event->radius < 0)
+                return false;
+            return journal_write_kind(journal, event->kind, event->tick) &&
+                   journal_write_varint(journal->io, (Uint64)event->from.x) &&
+                   journal_write_varint(journal->io, (Uint64)event->from.y) &&
+                   journal_write_varint(journal->io, (Uint64)event->center.x) &&
+                   journal_write_varint(journal->io, (Uint64)event->center.y) &&
+                   journal_write_varint(journal->io, (Uint64)event->radius) &&
+                   SDL_WriteU8(journal->io, (Uint8)event->type);
+        case JOURNAL_EVENT_BRUSH:
+            if (event->center.x < 0 || event->center.y < 0 || event->radius < 0)
+                return false;
+            return journal_write_kind(journal, event->kind, event->tick) &&
+                   journal_write_varint(journal->io, (Uint64)event->center.x) &&
+                   journal_write_varint(journal->io, (Uint64)event->center.y) &&
+                   journal_write_varint(journal->io, (Uint64)event->radius) &&
+                   SDL_WriteU8(journal->io, (Uint8)event->type);
+        case JOURNAL_EVENT_RESET:
+        case JOURNAL_EVENT_UNDO:
+        case JOURNAL_EVENT_REDO:
+            return journal_write_kind(journal, event->kind, event->tick);
+        default:
+            return false;
+    }
+}
+
+bool journal_close(Journal* journal, Uint64 final_tick) {
+    if (!journal || !journal->io)
+        return false;
+
+    bool closed = true;
+    if (journal->writing && !journal_write_kind(journal, JOURNAL_EVENT_END, final_tick)) {
+        SDL_Log("Couldn't finish journal: %s", SDL_GetError());
+        closed = false;
+    }
+
+    if (!SDL_CloseIO(journal->io))
+        closed = false;
+
+    *journal = (Journal){0};
+    return closed;
+}
+
+bool journal_open_read(Journal* journal, const char* path, JournalHeader* header) {
+    if (!journal || !path || !header)
+        return false;
+
+    *journal = (Journal){0};
+    journal->io = SDL_IOFromFile(path, "rb");
+    if (!journal->io) {
+        SDL_Log("Couldn't open journal %s: %s", path, SDL_GetError());
+        return false;
+    }
+
+    SDL_IOStream* io = journal->io;
+    char magic[4];
+    Uint32 version, width, height;
+    if (SDL_ReadIO(io, magic, sizeof(magic)) != sizeof(magic) || SDL_memcmp(magic, JOURNAL_MAGIC, sizeof(magic)) != 0 ||
+        !SDL_ReadU32LE(io, &version) || version < 1 || version > JOURNAL_VERSION || !SDL_ReadU32LE(io, &width) ||
+        !SDL_ReadU32LE(io, &height) || !SDL_ReadU64LE(io, &header->seed) || !SDL_ReadU8(io, &header->flags) ||
+        width == 0 || height == 0 || width > SDL_MAX_SINT32 || height > SDL_MAX_SINT32) {
+        SDL_Log("%s is not a version 1 to %d journal.", path, JOURNAL_VERSION);
+        SDL_CloseIO(io);
+        *journal = (Journal){0};
+        return false;
+    }
+
+    header->width = (int)width;
+    header->height = (int)height;
+    return true;
+}
+
+/* Center, radius and type, shared by brushes and the end of strokes. */
+static bool journal_read_brush(SDL_IOStream* io, JournalEvent* event) {
+    Uint8 type;
+    if (!journal_read_int(io, &event->center.x) || !journal_read_int(io, &event->center.y) ||
+        !journal_read_int(io, &event->radius) || !SDL_ReadU8(io, &type))
+        return false;
+    event->type = (ParticleType)type;
+    return true;
+}
+
+bool journal_read_event(Journal* journal, JournalEvent* event) {
+    if (!journal || !journal->io || journal->writing || !event)
+        return false;
+
+    Uint8 kind;
+    Uint64 delta;
+    if (!SDL_ReadU8(journal->io, &kind) || !journal_read_varint(journal->io, &delta))
+        return false;
+
+    *event = (JournalEvent){.kind = (JournalEventKind)kind, .tick = journal->last_tick + delta};
+    journal->last_tick = event->tick;
+
+    switch (kind) {
+        case JOURNAL_EVENT_STROKE:
+            return journal_read_int(journal->io, &event->from.x) && journal_read_int(journal->io, &event->from.y) &&
+                   journal_read_brush(journal->io, event);
+        case JOURNAL_EVENT_BRUSH:
+            return journal_read_brush(journal->io, event);
+        case JOURNAL_EVENT_RESET:
+        case JOURNAL_EVENT_UNDO:
+        case JOURNAL_EVENT_REDO:
+        case JOURNAL_EVENT_END:
+            return true;
+        default:
+            return false;
+    }
+}
+
+void journal_apply_event(Grid* grid, History* history, const JournalEvent* event) {
+    if (!grid || !event)
+        return;
+
+    switch (event->kind) {
+        case JOURNAL_EVENT_BRUSH:
+            history_apply_brush(history, grid, event->center, event->radius, event->type);
+            break;
+        case JOURNAL_EVENT_STROKE:
+            history_apply_stroke(history, grid, event->from, event->center, event->radius, event->type);
+            break;
+        case JOURNAL_EVENT_RESET:
+            history_begin(history);
+            history_record(history, grid, (GridRect){0, 0, grid->width - 1, grid->height - 1});
+            grid_reset(grid);
+            history_begin(history);
+            break;
+        case JOURNAL_EVENT_UNDO: history_undo(history, grid); break;
+        case JOURNAL_EVENT_REDO: history_redo(history, grid); break;
+        default: break;
+    }
+}
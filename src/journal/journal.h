@@ -0,0 +1,81 @@
+#ifndef FALLING_SAND_JOURNAL_H
+#define FALLING_SAND_JOURNAL_H
+
+#include <SDL3/SDL.h>
+#include <stdbool.h>
+
+#include "grid/grid.h"
+#include "history/history.h"
+#include "particle/particle.h"
+#include "types.h"
+
+/*
+ * Binary input journal: everything that changes the world, keyed by the tick
+ * it happened before. Replaying a journal on a grid of the recorded size and
+ * seed reproduces the recorded run exactly.
+ *
+ * Layout, little endian: "FSRJ", u32 version, u32 width, u32 height, u64 seed,
+ * u8 flags, then events of u8 kind + varint tick delta + payload. A brush
+ * carries varint x, y, radius and a u8 type, a stroke the same after a varint
+ * x, y it starts from; reset, undo, redo and end carry nothing. Version 1
+ * journals, which have no strokes, and version 2 ones, which have no undo, are
+ * still read.
+ */
+#define JOURNAL_VERSION 3
+
+/*
+ * Recorded with grid_update_parallel's checkerboard order, so the replay runs it
+ * too. Recording now runs in the grid's deterministic mode, which matches the
+ * serial scan, so only older journals carry it.
+ */
+#define JOURNAL_FLAG_PARALLEL 0x01
+
+typedef enum journal_event_kind {
+    JOURNAL_EVENT_END,
+    JOURNAL_EVENT_BRUSH,
+    JOURNAL_EVENT_RESET,
+    JOURNAL_EVENT_STROKE,
+    JOURNAL_EVENT_UNDO,
+    JOURNAL_EVENT_REDO,
+} JournalEventKind;
+
+typedef struct journal_header {
+    int width;
+    int height;
+    Uint64 seed;
+    Uint8 flags;
+} JournalHeader;
+
+typedef struct journal_event {
+    JournalEventKind kind;
+    Uint64 tick; /* grid tick_count when the event was applied */
+    Coordinates center; /* a stroke ends here */
+    Coordinates from;   /* stroke only */
+    int radius;
+    ParticleType type;
+} JournalEvent;
+
+typedef struct journal {
+    SDL_IOStream* io;
+    Uint64 last_tick;
+    bool writing;
+} Journal;
+
+bool journal_open_write(Journal* journal, const char* path, const JournalHeader* header);
+bool journal_write_event(Journal* journal, const JournalEvent* event);
+/* Writing journals end with an END event at `final_tick`; both kinds get closed. */
+bool journal_close(Journal* journal, Uint64 final_tick);
+
+bool journal_open_read(Journal* journal, const char* path, JournalHeader* header);
+/* False at a truncated or malformed event; the END event is returned like any other. */
+bool journal_read_event(Journal* journal, JournalEvent* event);
+
+/*
+ * Applies an event to the grid; END does nothing. Brushes and resets start a
+ * history entry and strokes add to the open one, so a drag undoes as a whole.
+ * Without a history nothing is recorded and undo and redo do nothing; a replay
+ * needs one with the recorded run's budget to come out the same.
+ */
+void journal_apply_event(Grid* grid, History* history, const JournalEvent* event);
+
+#endif
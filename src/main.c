@@ -6,22 +6,72 @@
 
 #include "config/display_config.h"
 #include "display/display.h"
-#include "grid/grid.h"
+#include "journal/journal.h"
+#include "profiler/profiler.h"
+#include "simulation/simulation.h"
+#include "snapshot/snapshot.h"
 
 typedef struct app_state {
     Display display;
-    Grid grid;
+    Simulation simulation;
     bool left_mouse_pressed;
+    bool stroking;          /* the brush was down and in bounds last frame */
+    Coordinates stroke_end; /* where it was */
     ParticleType particle_in_use;
     int brush_radius;
-    Uint64 last_tick;
-    double accumulator;
 } AppState;
 
+/* Accepts `--size WIDTHxHEIGHT`, `--record FILE` and `--load FILE`; anything else is ignored. */
+static bool parse_options(int argc, char *argv[], int *width, int *height, const char **record_path,
+                          const char **load_path) {
+    *width = GRID_WIDTH;
+    *height = GRID_HEIGHT;
+    *record_path = NULL;
+    *load_path = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        if (SDL_strcmp(argv[i], "--size") == 0 && i + 1 < argc) {
+            if (SDL_sscanf(argv[++i], "%dx%d", width, height) != 2 || *width <= 0 || *height <= 0)
+                return false;
+        } else if (SDL_strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+            *record_path = argv[++i];
+        } else if (SDL_strcmp(argv[i], "--load") == 0 && i + 1 < argc) {
+            *load_path = argv[++i];
+        }
+    }
+
+    return true;
+}
+
+/* Every world edit goes to the simulation thread, which applies and records it before its next tick. */
+static void send_event(AppState *state, JournalEvent event) {
+    if (!simulation_send(&state->simulation, &event))
+        SDL_Log("Simulation is falling behind, dropped an edit.");
+}
+
 SDL_AppResult SDL_AppInit(void **appstate, int argc, char *argv[]) {
+    int grid_width, grid_height;
+    const char *record_path, *load_path;
+    if (!parse_options(argc, argv, &grid_width, &grid_height, &record_path, &load_path)) {
+        SDL_Log("Usage: falling_sand [--size WIDTHxHEIGHT] [--record FILE] [--load FILE]");
+        return SDL_APP_FAILURE;
+    }
+
+    /* A snapshot decides the world size */
+    Snapshot snapshot = {0};
+    if (load_path) {
+        if (!snapshot_open(&snapshot, load_path))
+            return SDL_APP_FAILURE;
+        grid_width = snapshot.header.width;
+        grid_height = snapshot.header.height;
+    }
+
+    PROFILE_INITIALIZE();
+
     AppState *state = SDL_calloc(1, sizeof(AppState));
     if (!state) {
         SDL_Log("Couldn't allocate AppState.");
+        snapshot_close(&snapshot);
         return SDL_APP_FAILURE;
     }
 
@@ -29,6 +79,8 @@ SDL_AppResult SDL_AppInit(void **appstate, int argc, char *argv[]) {
         .title = DISPLAY_TITLE,
         .width = DISPLAY_WIDTH,
         .height = DISPLAY_HEIGHT,
+        .texture_width = grid_width,
+        .texture_height = grid_height,
         .window_flags = DISPLAY_WINDOW_FLAGS,
         .init_flags = DISPLAY_INIT_FLAGS,
         .presentation = DISPLAY_LOGICAL_PRESENTATION,
@@ -36,12 +88,14 @@ SDL_AppResult SDL_AppInit(void **appstate, int argc, char *argv[]) {
 
     if (!display_initialize(&state->display, &config)) {
         SDL_Log("Couldn't initialize Display.");
+        snapshot_close(&snapshot);
         SDL_free(state);
         return SDL_APP_FAILURE;
     }
 
-    if (!grid_initialize(&state->grid)) {
-        SDL_Log("Couldn't initialize Grid.");
+    if (!simulation_initialize(&state->simulation, grid_width, grid_height)) {
+        SDL_Log("Couldn't initialize Simulation.");
+        snapshot_close(&snapshot);
         display_destroy(&state->display);
         SDL_free(state);
         return SDL_APP_FAILURE;
@@ -49,10 +103,44 @@ SDL_AppResult SDL_AppInit(void **appstate, int argc, char *argv[]) {
 
     state->brush_radius = DEFAULT_BRUSH_RADIUS;
     state->particle_in_use = SAND;
-    state->last_tick = SDL_GetPerformanceCounter();
-    state->accumulator = 0.0;
 
-    SDL_srand((Uint64)time(NULL));
+    /* The simulation thread isn't running yet, so its grid and journal can be set up here */
+    Grid *grid = &state->simulation.grid;
+    Uint64 seed = (Uint64)time(NULL);
+    grid_set_seed(grid, seed);
+
+    if (load_path) {
+        if (!snapshot_load(&snapshot, grid, &state->simulation.workers)) {
+            SDL_Log("Couldn't load snapshot, starting empty.");
+            grid_reset(grid);
+            grid_set_seed(grid, seed);
+        }
+        snapshot_close(&snapshot);
+
+        /* A journal replays from an empty grid, which this one isn't */
+        if (record_path) {
+            SDL_Log("Recording isn't supported on a loaded snapshot, running without it.");
+            record_path = NULL;
+        }
+    }
+
+    JournalHeader header = {
+        .width = grid_width,
+        .height = grid_height,
+        .seed = seed,
+        .flags = 0,
+    };
+    if (record_path && !journal_open_write(&state->simulation.journal, record_path, &header))
+        SDL_Log("Couldn't start recording, running without it.");
+    else if (record_path)
+        grid->deterministic = true; /* ticks match the serial scan a replay runs, whatever the thread count */
+
+    if (!simulation_start(&state->simulation)) {
+        simulation_destroy(&state->simulation);
+        display_destroy(&state->display);
+        SDL_free(state);
+        return SDL_APP_FAILURE;
+    }
 
     *appstate = state;
     return SDL_APP_CONTINUE;
@@ -70,7 +158,18 @@ SDL_AppResult SDL_AppEvent(void *appstate, SDL_Event *event) {
             case SDLK_1: state->particle_in_use = SAND; break;
             case SDLK_2: state->particle_in_use = ROCK; break;
             case SDLK_3: state->particle_in_use = EMPTY; break;
-            case SDLK_R: grid_reset(&state->grid); break;
+            case SDLK_4: state->particle_in_use = WATER; break;
+            case SDLK_R: send_event(state, (JournalEvent){.kind = JOURNAL_EVENT_RESET}); break;
+            case SDLK_Z:
+                if (event->key.mod & SDL_KMOD_CTRL)
+                    send_event(state, (JournalEvent){.kind = event->key.mod & SDL_KMOD_SHIFT ? JOURNAL_EVENT_REDO
+                                                                                            : JOURNAL_EVENT_UNDO});
+                break;
+            case SDLK_Y:
+                if (event->key.mod & SDL_KMOD_CTRL)
+                    send_event(state, (JournalEvent){.kind = JOURNAL_EVENT_REDO});
+                break;
+            case SDLK_P: PROFILE_EXPORT(PROFILER_TRACE_PATH); break;
             default: break;
         }
     } 
@@ -103,24 +202,30 @@ SDL_AppResult SDL_AppIterate(void *appstate) {
     if (!state || !state->display.renderer) 
         return SDL_APP_FAILURE;
 
-    Uint64 now = SDL_GetPerformanceCounter();
-    double dt = (double)(now - state->last_tick) / (double)SDL_GetPerformanceFrequency();
-    state->last_tick = now;
-    state->accumulator += dt;
-
+    /* Grid dimensions never change once the simulation runs, so reading them here is safe */
+    Grid *grid = &state->simulation.grid;
     float mouse_x, mouse_y;
     SDL_GetMouseState(&mouse_x, &mouse_y);
-    Coordinates coordinates = {(int)(mouse_x / PARTICLE_SIZE), (int)(mouse_y / PARTICLE_SIZE)};
-    if (state->left_mouse_pressed && grid_is_in_bounds(coordinates)) 
-        grid_apply_brush(&state->grid, coordinates, state->brush_radius, state->particle_in_use);
-
-    while (state->accumulator >= SIMULATION_TICK_RATE) {
-        grid_update(&state->grid);
-        state->accumulator -= SIMULATION_TICK_RATE;
+    Coordinates coordinates = {(int)(mouse_x * grid->width / DISPLAY_WIDTH),
+                               (int)(mouse_y * grid->height / DISPLAY_HEIGHT)};
+    if (state->left_mouse_pressed && grid_is_in_bounds(grid, coordinates)) {
+        /* A drag joins up with last frame's position, so fast strokes leave no gaps, and undoes as one edit */
+        send_event(state, (JournalEvent){.kind = state->stroking ? JOURNAL_EVENT_STROKE : JOURNAL_EVENT_BRUSH,
+                                         .from = state->stroke_end,
+                                         .center = coordinates,
+                                         .radius = state->brush_radius,
+                                         .type = state->particle_in_use});
+        state->stroke_end = coordinates;
+        state->stroking = true;
+    } else {
+        state->stroking = false;
     }
 
-    grid_render(&state->grid, &state->display);
+    simulation_render(&state->simulation, &state->display);
+
+    PROFILE_BEGIN(PROFILE_ZONE_PRESENT);
     SDL_RenderPresent(state->display.renderer);
+    PROFILE_END(PROFILE_ZONE_PRESENT);
 
     return SDL_APP_CONTINUE;
 }
@@ -128,6 +233,9 @@ SDL_AppResult SDL_AppIterate(void *appstate) {
 void SDL_AppQuit(void *appstate, SDL_AppResult result) {
     AppState *state = appstate;
     if (state) {
+        simulation_destroy(&state->simulation);
+        PROFILE_REPORT();
+        PROFILE_EXPORT(PROFILER_TRACE_PATH);
         display_destroy(&state->display);
         SDL_free(state);
     }
@@ -0,0 +1,83 @@
+#include "margolus/margolus.h"
+
+#define MARGOLUS_TOP_LEFT 0
+#define MARGOLUS_TOP_RIGHT 1
+#define MARGOLUS_BOTTOM_LEFT 2
+#define MARGOLUS_BOTTOM_RIGHT 3
+
+/* A block being worked out: the type in each cell, where it came from and whether it moved yet. */
+typedef struct margolus_block {
+    Uint8 types[4];
+    Uint8 sources[4];
+    bool moved[4];
+} MargolusBlock;
+
+/* The wall class has no material entry, so it reads as an unused id: no flags, never displaced. */
+static Uint8 margolus_type(int class) {
+    return class == MARGOLUS_WALL ? 0xFF : (Uint8)class;
+}
+
+/* Swaps two cells when neither has moved this step and the first may displace the second. */
+static bool margolus_try_move(MargolusBlock* block, int from, int to) {
+    if (block->moved[from] || block->moved[to] || !particle_type_has(block->types[from], MATERIAL_MOVES) ||
+        !particle_can_displace(block->types[from], block->types[to]))
+        return false;
+
+    Uint8 type = block->types[from];
+    block->types[from] = block->types[to];
+    block->types[to] = type;
+
+    Uint8 source = block->sources[from];
+    block->sources[from] = block->sources[to];
+    block->sources[to] = source;
+
+    block->moved[from] = block->moved[to] = true;
+    return true;
+}
+
+/* Same order as the scan kernels: fall, else slide diagonally, else a liquid flows along its row. */
+static Uint8 margolus_step(const Uint8 types[4]) {
+    MargolusBlock block = {.sources = {0, 1, 2, 3}};
+    SDL_memcpy(block.types, types, sizeof(block.types));
+
+    margolus_try_move(&block, MARGOLUS_TOP_LEFT, MARGOLUS_BOTTOM_LEFT);
+    margolus_try_move(&block, MARGOLUS_TOP_RIGHT, MARGOLUS_BOTTOM_RIGHT);
+
+    for (int top = MARGOLUS_TOP_LEFT; top <= MARGOLUS_TOP_RIGHT; top++) {
+        int side = top ^ 1;
+        bool slides = particle_type_has(block.types[top], MATERIAL_POWDER | MATERIAL_LIQUID);
+        if (slides && !particle_type_has(block.types[side], MATERIAL_SOLID))
+            margolus_try_move(&block, top, side + 2);
+    }
+
+    for (int left = MARGOLUS_TOP_LEFT; left <= MARGOLUS_BOTTOM_LEFT; left += 2) {
+        int right = left + 1;
+        if (particle_type_has(block.types[left], MATERIAL_LIQUID) && margolus_try_move(&block, left, right))
+            continue;
+        if (particle_type_has(block.types[right], MATERIAL_LIQUID))
+            margolus_try_move(&block, right, left);
+    }
+
+    Uint8 move = 0;
+    for (int cell = 0; cell < 4; cell++)
+        move |= (Uint8)(block.sources[cell] << (2 * cell));
+    return move;
+}
+
+void margolus_build_rules(MargolusRules* rules) {
+    if (!rules)
+        return;
+
+    for (int id = 0; id < 256; id++)
+        rules->classes[id] = id < PARTICLE_TYPE_COUNT ? (Uint8)id : MARGOLUS_WALL;
+
+    for (int state = 0; state < MARGOLUS_STATES; state++) {
+        Uint8 types[4];
+        int rest = state;
+        for (int cell = 0; cell < 4; cell++) {
+            types[cell] = margolus_type(rest % MARGOLUS_CLASSES);
+            rest /= MARGOLUS_CLASSES;
+        }
+        rules->moves[state] = margolus_step(types);
+    }
+}
@@ -0,0 +1,46 @@
+#ifndef FALLING_SAND_MARGOLUS_H
+#define FALLING_SAND_MARGOLUS_H
+
+#include <SDL3/SDL.h>
+#include <stdbool.h>
+
+#include "particle/particle.h"
+
+/*
+ * Rules for a Margolus neighborhood: the grid is cut into 2x2 blocks whose
+ * origin shifts one cell down and right on alternate ticks, and every block
+ * steps on its own from the types of its four cells. Cells of a block are
+ * numbered top left, top right, bottom left, bottom right.
+ *
+ * Types are folded into classes first: one per material, plus a wall class
+ * for the grid border and unused ids, which never moves or gets displaced.
+ */
+#define MARGOLUS_WALL PARTICLE_TYPE_COUNT
+#define MARGOLUS_CLASSES (PARTICLE_TYPE_COUNT + 1)
+#define MARGOLUS_STATES (MARGOLUS_CLASSES * MARGOLUS_CLASSES * MARGOLUS_CLASSES * MARGOLUS_CLASSES)
+
+/* Move byte that leaves every cell as it is. */
+#define MARGOLUS_IDENTITY 0xE4
+
+typedef struct margolus_rules {
+    Uint8 classes[256];           /* type byte to class */
+    Uint8 moves[MARGOLUS_STATES]; /* per block state, 2 bits per cell naming the cell its content comes from */
+} MargolusRules;
+
+/* Derives the table from PARTICLE_MATERIALS: falls, diagonal slides, sinking by density and liquid flow. */
+void margolus_build_rules(MargolusRules* rules);
+
+static inline int margolus_state(const MargolusRules* rules, Uint8 top_left, Uint8 top_right, Uint8 bottom_left,
+                                 Uint8 bottom_right) {
+    return rules->classes[top_left] +
+           MARGOLUS_CLASSES * (rules->classes[top_right] +
+                               MARGOLUS_CLASSES * (rules->classes[bottom_left] +
+                                                   MARGOLUS_CLASSES * rules->classes[bottom_right]));
+}
+
+/* The cell whose content `cell` takes under `move`. */
+static inline int margolus_source(Uint8 move, int cell) {
+    return (move >> (2 * cell)) & 3;
+}
+
+#endif
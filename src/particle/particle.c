@@ -1,8 +1,51 @@
 #include "config/color_config.h"
+#include "config/simulation_config.h"
 #include "particle/particle.h"
 
+_Static_assert(WATER_DISPERSION >= 0 && WATER_DISPERSION <= MATERIAL_MAX_DISPERSION, "water flows too far per tick");
+
+const Material PARTICLE_MATERIALS[256] = {
+    [EMPTY] = {
+        .name = "empty",
+        .flags = MATERIAL_EMPTY,
+        .density = 0,
+        .priority = 0,
+        .color_variation = EMPTY_COLOR_VARIATION,
+        .kernel = MATERIAL_KERNEL_NONE,
+        .base_color = EMPTY_BASE_COLOR,
+    },
+    [ROCK] = {
+        .name = "rock",
+        .flags = MATERIAL_SOLID,
+        .density = 255,
+        .priority = 2,
+        .color_variation = ROCK_COLOR_VARIATION,
+        .kernel = MATERIAL_KERNEL_NONE,
+        .base_color = ROCK_BASE_COLOR,
+    },
+    [SAND] = {
+        .name = "sand",
+        .flags = MATERIAL_MOVES | MATERIAL_POWDER,
+        .density = 160,
+        .priority = 1,
+        .color_variation = SAND_COLOR_VARIATION,
+        .kernel = MATERIAL_KERNEL_POWDER,
+        .base_color = SAND_BASE_COLOR,
+    },
+    [WATER] = {
+        .name = "water",
+        .flags = MATERIAL_MOVES | MATERIAL_LIQUID,
+        .density = 100,
+        .priority = 1,
+        .color_variation = WATER_COLOR_VARIATION,
+        .dispersion = WATER_DISPERSION,
+        .kernel = MATERIAL_KERNEL_LIQUID,
+        .base_color = WATER_BASE_COLOR,
+    },
+};
+
 bool particle_is_type_solid(ParticleType type) {
-    return type == ROCK;
+    return particle_type_has((Uint8)type, MATERIAL_SOLID);
 }
 
 bool particle_is_solid(const Particle* particle) {
@@ -21,37 +64,51 @@ static Uint8 clamp_color_component(int value) {
     return (Uint8)value;
 }
 
-SDL_Color particle_get_random_color_with_variation(SDL_Color color_base, int variation) {
+SDL_Color particle_get_random_color_with_variation(SDL_Color color_base, int variation, Random* random) {
     if (variation == 0)
         return color_base;
 
     int range_variation = variation * 2 + 1;
     return (SDL_Color) {
-        .r = clamp_color_component(color_base.r + SDL_rand(range_variation) - variation),
-        .g = clamp_color_component(color_base.g + SDL_rand(range_variation) - variation),
-        .b = clamp_color_component(color_base.b + SDL_rand(range_variation) - variation),
+        .r = clamp_color_component(color_base.r + random_below(random, range_variation) - variation),
+        .g = clamp_color_component(color_base.g + random_below(random, range_variation) - variation),
+        .b = clamp_color_component(color_base.b + random_below(random, range_variation) - variation),
         .a = color_base.a
     };
 }
 
+/* Unknown types draw like empty cells. */
 SDL_Color particle_get_default_color_by_type(ParticleType type) {
-    switch (type) {
-        case ROCK: return ROCK_BASE_COLOR;
-        case SAND: return SAND_BASE_COLOR;
-        default: return EMPTY_BASE_COLOR;
-    }
+    const Material* material = particle_get_material(type);
+    return material->name ? material->base_color : EMPTY_BASE_COLOR;
+}
+
+SDL_Color particle_get_random_color_by_type(ParticleType type, Random* random) {
+    SDL_Color color;
+    particle_fill_random_colors(type, &color, 1, random);
+    return color;
 }
 
-SDL_Color particle_get_random_color_by_type(ParticleType type) {
-    switch (type) {
-        case ROCK: return particle_get_random_color_with_variation(ROCK_BASE_COLOR, ROCK_COLOR_VARIATION);
-        case SAND: return particle_get_random_color_with_variation(SAND_BASE_COLOR, SAND_COLOR_VARIATION);
-        default: return EMPTY_BASE_COLOR;
+/* Unknown types fill like empty cells; materials without variation draw nothing. */
+void particle_fill_random_colors(ParticleType type, SDL_Color* colors, int count, Random* random) {
+    const Material* material = particle_get_material(type);
+    SDL_Color base = material->name ? material->base_color : EMPTY_BASE_COLOR;
+    if (!material->name || material->color_variation == 0) {
+        for (int i = 0; i < count; i++)
+            colors[i] = base;
+        return;
     }
+
+    for (int i = 0; i < count; i++)
+        colors[i] = particle_get_random_color_with_variation(base, material->color_variation, random);
+}
+
+bool particle_is_type_empty(ParticleType type) {
+    return particle_type_has((Uint8)type, MATERIAL_EMPTY);
 }
 
 bool particle_is_empty(const Particle* particle) {
     if (!particle)
         return false;
-    return particle->type == EMPTY;
+    return particle_is_type_empty(particle->type);
 }
\ No newline at end of file
@@ -4,22 +4,93 @@
 #include <SDL3/SDL.h>
 #include <stdbool.h>
 
+#include "random/random.h"
+
+/*
+ * Type ids are what the grid's type plane stores, so they stay below 256 and
+ * keep their values once saved. They are grouped by kind: the empty id first,
+ * then materials that never move, then powders, then liquids, so the row
+ * kernel can classify a block of cells with range compares. Add new materials
+ * at the end of their group's range or after every group, and keep the
+ * range macros below in step.
+ */
 typedef enum particle_type {
-    EMPTY, ROCK, SAND
+    EMPTY, ROCK, SAND, WATER,
+    PARTICLE_TYPE_COUNT
 } ParticleType;
 
+#define PARTICLE_LAST_SOLID ROCK    /* ids after EMPTY up to here never move and are solid */
+#define PARTICLE_FIRST_MOVING SAND  /* ids from here up to PARTICLE_TYPE_COUNT have a kernel */
+#define PARTICLE_LAST_POWDER SAND   /* ids from PARTICLE_FIRST_MOVING up to here are powders */
+#define PARTICLE_FIRST_LIQUID WATER /* ids from here up to PARTICLE_LAST_LIQUID are liquids */
+#define PARTICLE_LAST_LIQUID WATER
+
+/* Material flags; hot checks are one table load and a mask. */
+#define MATERIAL_EMPTY 0x01  /* nothing there, anything may move in */
+#define MATERIAL_SOLID 0x02  /* blocks grains sliding diagonally past it */
+#define MATERIAL_MOVES 0x04  /* has an update kernel */
+#define MATERIAL_POWDER 0x08 /* falls straight down, else slides diagonally */
+#define MATERIAL_LIQUID 0x10 /* moves like a powder, else flows sideways; heavier movers sink through it */
+
+/* Farthest a liquid flows in one tick; the checkerboard update relies on it staying under half a chunk. */
+#define MATERIAL_MAX_DISPERSION 15
+
+/* What grid_update runs for a cell of the material; the grid owns the kernels. */
+typedef enum material_kernel {
+    MATERIAL_KERNEL_NONE,
+    MATERIAL_KERNEL_POWDER,
+    MATERIAL_KERNEL_LIQUID,
+    MATERIAL_KERNEL_COUNT
+} MaterialKernel;
+
+typedef struct material {
+    const char* name;
+    Uint8 flags;
+    Uint8 density;  /* heavier materials sink through lighter ones */
+    Uint8 priority; /* a brush paints over lower priority materials */
+    Uint8 color_variation;
+    Uint8 dispersion; /* liquids: cells flowed sideways per tick, at most MATERIAL_MAX_DISPERSION */
+    Uint8 kernel;   /* MaterialKernel */
+    SDL_Color base_color;
+} Material;
+
+/*
+ * Indexed by any type byte, so neighbor lookups need no range check. Unused
+ * ids, including the grid's border type, are all zero: never empty, never
+ * solid and never updated.
+ */
+extern const Material PARTICLE_MATERIALS[256];
+
+static inline const Material* particle_get_material(ParticleType type) {
+    return &PARTICLE_MATERIALS[(Uint8)type];
+}
+
+static inline bool particle_type_has(Uint8 type, Uint8 flags) {
+    return (PARTICLE_MATERIALS[type].flags & flags) != 0;
+}
+
+/* Whether `mover` may take `target`'s cell: it is empty, or a lighter liquid that trades places. */
+static inline bool particle_can_displace(Uint8 mover, Uint8 target) {
+    if (particle_type_has(target, MATERIAL_EMPTY))
+        return true;
+    return particle_type_has(target, MATERIAL_LIQUID) &&
+           PARTICLE_MATERIALS[target].density < PARTICLE_MATERIALS[mover].density;
+}
+
 typedef struct particle {
     ParticleType type;
     SDL_Color color;
-    Uint8 update_gen;
 } Particle;
 
 SDL_Color particle_get_default_color_by_type(ParticleType type);
-SDL_Color particle_get_random_color_by_type(ParticleType type);
-SDL_Color particle_get_random_color_with_variation(SDL_Color color_base, int variation);
+SDL_Color particle_get_random_color_by_type(ParticleType type, Random* random);
+SDL_Color particle_get_random_color_with_variation(SDL_Color color_base, int variation, Random* random);
+/* `count` colors drawn as that many particle_get_random_color_by_type calls would draw them. */
+void particle_fill_random_colors(ParticleType type, SDL_Color* colors, int count, Random* random);
 
 bool particle_is_empty(const Particle *particle);
 bool particle_is_solid(const Particle *particle);
+bool particle_is_type_empty(ParticleType type);
 bool particle_is_type_solid(ParticleType type);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,151 @@
+#include "profiler/profiler.h"
+
+typedef struct profiler_ring {
+    ProfilerSample samples[PROFILER_RING_SIZE];
+    Uint64 written;
+    SDL_SpinLock lock;
+} ProfilerRing;
+
+typedef struct profiler_zone_info {
+    const char* name;
+    int thread; /* index into PROFILER_THREAD_NAMES */
+} ProfilerZoneInfo;
+
+static const char* const PROFILER_THREAD_NAMES[] = {"render", "simulation"};
+
+static const ProfilerZoneInfo PROFILER_ZONES[PROFILE_ZONE_COUNT] = {
+    [PROFILE_ZONE_COMMANDS] = {"commands", 1},
+    [PROFILE_ZONE_TICK] = {"tick", 1},
+    [PROFILE_ZONE_PUBLISH] = {"publish", 1},
+    [PROFILE_ZONE_UPLOAD] = {"upload", 0},
+    [PROFILE_ZONE_PRESENT] = {"present", 0},
+};
+
+static ProfilerRing profiler_rings[PROFILE_ZONE_COUNT];
+static Uint64 profiler_epoch;
+
+void profiler_initialize(void) {
+    for (int zone = 0; zone < PROFILE_ZONE_COUNT; zone++) {
+        ProfilerRing* ring = &profiler_rings[zone];
+        SDL_LockSpinlock(&ring->lock);
+        ring->written = 0;
+        SDL_UnlockSpinlock(&ring->lock);
+    }
+    profiler_epoch = SDL_GetPerformanceCounter();
+}
+
+void profiler_record(ProfilerZone zone, Uint64 start, Uint64 end) {
+    if ((unsigned)zone >= PROFILE_ZONE_COUNT)
+        return;
+
+    ProfilerRing* ring = &profiler_rings[zone];
+    SDL_LockSpinlock(&ring->lock);
+    ring->samples[ring->written & (PROFILER_RING_SIZE - 1)] = (ProfilerSample){start, end - start};
+    ring->written++;
+    SDL_UnlockSpinlock(&ring->lock);
+}
+
+const char* profiler_get_zone_name(ProfilerZone zone) {
+    if ((unsigned)zone >= PROFILE_ZONE_COUNT)
+        return NULL;
+    return PROFILER_ZONES[zone].name;
+}
+
+/* Copies the zone's samples, oldest first, into `samples` of PROFILER_RING_SIZE entries. */
+static int profiler_copy_samples(ProfilerZone zone, ProfilerSample* samples) {
+    ProfilerRing* ring = &profiler_rings[zone];
+    SDL_LockSpinlock(&ring->lock);
+    int count = (int)SDL_min(ring->written, (Uint64)PROFILER_RING_SIZE);
+    Uint64 first = ring->written - (Uint64)count;
+    for (int i = 0; i < count; i++)
+        samples[i] = ring->samples[(first + (Uint64)i) & (PROFILER_RING_SIZE - 1)];
+    SDL_UnlockSpinlock(&ring->lock);
+    return count;
+}
+
+static int profiler_compare_durations(const void* a, const void* b) {
+    Uint64 left = ((const ProfilerSample*)a)->duration;
+    Uint64 right = ((const ProfilerSample*)b)->duration;
+    return (left > right) - (left < right);
+}
+
+bool profiler_get_stats(ProfilerZone zone, ProfilerStats* stats) {
+    if ((unsigned)zone >= PROFILE_ZONE_COUNT || !stats)
+        return false;
+
+    *stats = (ProfilerStats){0};
+    ProfilerSample* samples = SDL_malloc(PROFILER_RING_SIZE * sizeof(ProfilerSample));
+    if (!samples)
+        return false;
+
+    int count = profiler_copy_samples(zone, samples);
+    if (count > 0) {
+        SDL_qsort(samples, (size_t)count, sizeof(ProfilerSample), profiler_compare_durations);
+
+        double to_ms = 1e3 / (double)SDL_GetPerformanceFrequency();
+        Uint64 total = 0;
+        for (int i = 0; i < count; i++)
+            total += samples[i].duration;
+
+        /* Nearest rank: the smallest sample at or above 99% of the others */
+        int p99 = (count * 99 + 99) / 100 - 1;
+        stats->count = count;
+        stats->min_ms = (double)samples[0].duration * to_ms;
+        stats->avg_ms = (double)total / count * to_ms;
+        stats->p99_ms = (double)samples[p99].duration * to_ms;
+        stats->max_ms = (double)samples[count - 1].duration * to_ms;
+    }
+
+    SDL_free(samples);
+    return true;
+}
+
+void profiler_report(void) {
+    for (int zone = 0; zone < PROFILE_ZONE_COUNT; zone++) {
+        ProfilerStats stats;
+        if (!profiler_get_stats(zone, &stats) || stats.count == 0)
+            continue;
+        SDL_Log("%-8s %5d samples  min %.3f  avg %.3f  p99 %.3f  max %.3f ms", PROFILER_ZONES[zone].name, stats.count,
+                stats.min_ms, stats.avg_ms, stats.p99_ms, stats.max_ms);
+    }
+}
+
+bool profiler_export_trace(const char* path) {
+    if (!path)
+        return false;
+
+    ProfilerSample* samples = SDL_malloc(PROFILER_RING_SIZE * sizeof(ProfilerSample));
+    SDL_IOStream* io = SDL_IOFromFile(path, "w");
+    bool exported = false;
+    if (!samples || !io) {
+        SDL_Log("Couldn't export trace to %s: %s", path, SDL_GetError());
+        goto failed;
+    }
+
+    /* Complete ("X") events in microseconds since profiler_initialize, one track per thread */
+    double to_us = 1e6 / (double)SDL_GetPerformanceFrequency();
+    SDL_IOprintf(io, "{\"traceEvents\":[\n");
+    for (int thread = 0; thread < (int)SDL_arraysize(PROFILER_THREAD_NAMES); thread++) {
+        SDL_IOprintf(io, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+                     thread ? ",\n" : "", thread, PROFILER_THREAD_NAMES[thread]);
+    }
+    for (int zone = 0; zone < PROFILE_ZONE_COUNT; zone++) {
+        int count = profiler_copy_samples(zone, samples);
+        for (int i = 0; i < count; i++) {
+            Uint64 start = samples[i].start > profiler_epoch ? samples[i].start - profiler_epoch : 0;
+            SDL_IOprintf(io, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+                         PROFILER_ZONES[zone].name, PROFILER_ZONES[zone].thread, (double)start * to_us,
+                         (double)samples[i].duration * to_us);
+        }
+    }
+    SDL_IOprintf(io, "\n]}\n");
+    exported = true;
+
+failed:
+    if (io && !SDL_CloseIO(io))
+        exported = false;
+    if (exported)
+        SDL_Log("Wrote trace to %s.", path);
+    SDL_free(samples);
+    return exported;
+}
@@ -0,0 +1,63 @@
+#ifndef FALLING_SAND_PROFILER_H
+#define FALLING_SAND_PROFILER_H
+
+#include <SDL3/SDL.h>
+#include <stdbool.h>
+
+/*
+ * Frame profiler: timed zones around the phases of a frame, kept in one ring
+ * of recent samples per zone. Reports min/avg/p99/max per zone and exports the
+ * samples as Chrome trace-event JSON (chrome://tracing, Perfetto).
+ *
+ * Only built in when FALLING_SAND_PROFILE is defined, which configuring with
+ * -DFALLING_SAND_PROFILER=ON does; otherwise every PROFILE_* macro expands to
+ * nothing and no counter is ever read.
+ */
+#define PROFILER_RING_SIZE 4096 /* samples kept per zone, power of two */
+#define PROFILER_TRACE_PATH "falling_sand_trace.json"
+
+/* Each zone is only ever recorded from one thread. */
+typedef enum profiler_zone {
+    PROFILE_ZONE_COMMANDS, /* simulation: applying brush and reset commands */
+    PROFILE_ZONE_TICK,     /* simulation: one grid update */
+    PROFILE_ZONE_PUBLISH,  /* simulation: packing a finished frame */
+    PROFILE_ZONE_UPLOAD,   /* render: texture upload */
+    PROFILE_ZONE_PRESENT,  /* render: SDL_RenderPresent */
+    PROFILE_ZONE_COUNT,
+} ProfilerZone;
+
+typedef struct profiler_sample {
+    Uint64 start;
+    Uint64 duration;
+} ProfilerSample;
+
+typedef struct profiler_stats {
+    int count; /* samples still in the ring */
+    double min_ms;
+    double avg_ms;
+    double p99_ms;
+    double max_ms;
+} ProfilerStats;
+
+void profiler_initialize(void);
+void profiler_record(ProfilerZone zone, Uint64 start, Uint64 end);
+bool profiler_get_stats(ProfilerZone zone, ProfilerStats* stats);
+const char* profiler_get_zone_name(ProfilerZone zone);
+void profiler_report(void);
+bool profiler_export_trace(const char* path);
+
+#ifdef FALLING_SAND_PROFILE
+#define PROFILE_INITIALIZE() profiler_initialize()
+#define PROFILE_BEGIN(zone) Uint64 profile_start_##zone = SDL_GetPerformanceCounter()
+#define PROFILE_END(zone) profiler_record(zone, profile_start_##zone, SDL_GetPerformanceCounter())
+#define PROFILE_REPORT() profiler_report()
+#define PROFILE_EXPORT(path) profiler_export_trace(path)
+#else
+#define PROFILE_INITIALIZE() ((void)0)
+#define PROFILE_BEGIN(zone) ((void)0)
+#define PROFILE_END(zone) ((void)0)
+#define PROFILE_REPORT() ((void)0)
+#define PROFILE_EXPORT(path) ((void)0)
+#endif
+
+#endif
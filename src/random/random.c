@@ -0,0 +1,32 @@
+#include "random/random.h"
+
+static Uint64 random_splitmix64(Uint64* value) {
+    Uint64 z = (*value += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+void random_seed(Random* random, Uint64 seed) {
+    if (!random)
+        return;
+
+    /* splitmix64 never yields four zero words in a row, so the state is never all zero */
+    for (int i = 0; i < 4; i++)
+        random->state[i] = random_splitmix64(&seed);
+    random->bits = 0;
+    random->bit_count = 0;
+}
+
+void random_seed_stream(Random* random, Uint64 seed, Uint64 stream) {
+    Uint64 mixed = stream;
+    random_seed(random, seed ^ random_splitmix64(&mixed));
+}
+
+Sint32 random_below(Random* random, Sint32 n) {
+    if (!random || n <= 0)
+        return 0;
+
+    /* Multiply-shift keeps the top bits, which are the best ones xoshiro has */
+    return (Sint32)(((random_next(random) >> 32) * (Uint64)n) >> 32);
+}
@@ -0,0 +1,67 @@
+#ifndef FALLING_SAND_RANDOM_H
+#define FALLING_SAND_RANDOM_H
+
+#include <SDL3/SDL.h>
+#include <stdbool.h>
+
+/*
+ * xoshiro256** stream. Each stream is owned by one thread at a time; seeding
+ * the same seed and stream id always gives the same sequence. Single-bit
+ * draws come out of a 64-bit buffer, so one generator step serves 64 of them.
+ */
+typedef struct random {
+    Uint64 state[4];
+    Uint64 bits;
+    int bit_count;
+} Random;
+
+void random_seed(Random* random, Uint64 seed);
+/* Independent stream `stream` of `seed`, e.g. one per chunk and tick. */
+void random_seed_stream(Random* random, Uint64 seed, Uint64 stream);
+/* Uniform in [0, n), or 0 when n <= 0; same contract as SDL_rand. */
+Sint32 random_below(Random* random, Sint32 n);
+
+static inline Uint64 random_rotate(Uint64 value, int shift) {
+    return (value << shift) | (value >> (64 - shift));
+}
+
+static inline Uint64 random_next(Random* random) {
+    Uint64* s = random->state;
+    Uint64 result = random_rotate(s[1] * 5, 7) * 9;
+    Uint64 t = s[1] << 17;
+
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = random_rotate(s[3], 45);
+
+    return result;
+}
+
+/*
+ * Stateless draw for item `index` of `stream`: a splitmix64 finalizer over the
+ * three inputs, so work whose draws must not depend on visit order can key
+ * them by position instead of pulling them from a stream in turn.
+ */
+static inline Uint64 random_hash(Uint64 seed, Uint64 stream, Uint64 index) {
+    Uint64 z = seed + stream * 0x9E3779B97F4A7C15ull + index * 0xD1B54A32D192ED03ull;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+static inline bool random_bit(Random* random) {
+    if (random->bit_count == 0) {
+        random->bits = random_next(random);
+        random->bit_count = 64;
+    }
+
+    bool bit = random->bits & 1;
+    random->bits >>= 1;
+    random->bit_count--;
+    return bit;
+}
+
+#endif
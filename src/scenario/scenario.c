@@ -0,0 +1,105 @@
+#include <SDL3/SDL.h>
+
+#include "scenario/scenario.h"
+
+static const char* const SCENARIO_NAMES[SCENARIO_COUNT] = {
+    [SCENARIO_EMPTY] = "empty",
+    [SCENARIO_SETTLED] = "settled",
+    [SCENARIO_PILE] = "pile",
+    [SCENARIO_AVALANCHE] = "avalanche",
+    [SCENARIO_NOISE] = "noise",
+    [SCENARIO_FLOOD] = "flood",
+};
+
+const char* scenario_get_name(ScenarioKind kind) {
+    if (kind < 0 || kind >= SCENARIO_COUNT)
+        return NULL;
+    return SCENARIO_NAMES[kind];
+}
+
+bool scenario_find(const char* name, ScenarioKind* kind) {
+    if (!name || !kind)
+        return false;
+
+    for (int i = 0; i < SCENARIO_COUNT; i++) {
+        if (SDL_strcmp(name, SCENARIO_NAMES[i]) == 0) {
+            *kind = (ScenarioKind)i;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static void scenario_fill(Grid* grid, int min_x, int min_y, int max_x, int max_y, ParticleType type) {
+    for (int y = SDL_max(min_y, 0); y <= SDL_min(max_y, grid->height - 1); y++) {
+        for (int x = SDL_max(min_x, 0); x <= SDL_min(max_x, grid->width - 1); x++) {
+            grid_place_particle(grid, (Coordinates){x, y}, type);
+        }
+    }
+}
+
+/* Bottom half packed wall to wall with sand: nothing can move. */
+static void scenario_generate_settled(Grid* grid) {
+    scenario_fill(grid, 0, grid->height / 2, grid->width - 1, grid->height - 1, SAND);
+}
+
+/* A block of sand over the middle third that drops and spreads into a heap. */
+static void scenario_generate_pile(Grid* grid) {
+    int third = grid->width / 3;
+    scenario_fill(grid, third, 0, 2 * third, grid->height / 3, SAND);
+}
+
+/* Dense sand above staggered rock shelves: the worst frame we know of. */
+static void scenario_generate_avalanche(Grid* grid) {
+    scenario_fill(grid, 0, 0, grid->width - 1, grid->height * 3 / 4, SAND);
+
+    int shelf_length = SDL_max(grid->width / 4, 1);
+    for (int y = grid->height / 8; y < grid->height; y += SDL_max(grid->height / 6, 2)) {
+        int offset = (y / SDL_max(grid->height / 6, 2)) % 2 ? grid->width - shelf_length : 0;
+        scenario_fill(grid, offset, y, offset + shelf_length - 1, y, ROCK);
+    }
+}
+
+/* Random mix of sand, rock and air; about half the cells hold sand. */
+static void scenario_generate_noise(Grid* grid) {
+    for (int y = 0; y < grid->height; y++) {
+        for (int x = 0; x < grid->width; x++) {
+            Sint32 roll = random_below(&grid->random, 10);
+            if (roll < 5)
+                grid_place_particle(grid, (Coordinates){x, y}, SAND);
+            else if (roll == 5)
+                grid_place_particle(grid, (Coordinates){x, y}, ROCK);
+        }
+    }
+}
+
+/* A sheet of water over the top third pouring into rock basins, which fill and level out. */
+static void scenario_generate_flood(Grid* grid) {
+    scenario_fill(grid, 0, 0, grid->width - 1, grid->height / 3, WATER);
+
+    int basin_width = SDL_max(grid->width / 4, 2);
+    for (int x = basin_width - 1; x < grid->width; x += basin_width)
+        scenario_fill(grid, x, grid->height / 2, x, grid->height - 1, ROCK);
+}
+
+bool scenario_generate(Grid* grid, ScenarioKind kind, Uint64 seed) {
+    if (!grid || kind < 0 || kind >= SCENARIO_COUNT)
+        return false;
+
+    if (!grid_reset(grid))
+        return false;
+
+    grid_set_seed(grid, seed);
+
+    switch (kind) {
+        case SCENARIO_SETTLED: scenario_generate_settled(grid); break;
+        case SCENARIO_PILE: scenario_generate_pile(grid); break;
+        case SCENARIO_AVALANCHE: scenario_generate_avalanche(grid); break;
+        case SCENARIO_NOISE: scenario_generate_noise(grid); break;
+        case SCENARIO_FLOOD: scenario_generate_flood(grid); break;
+        default: break;
+    }
+
+    return true;
+}
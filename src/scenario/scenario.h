@@ -0,0 +1,25 @@
+#ifndef FALLING_SAND_SCENARIO_H
+#define FALLING_SAND_SCENARIO_H
+
+#include <SDL3/SDL.h>
+#include <stdbool.h>
+
+#include "grid/grid.h"
+
+typedef enum scenario_kind {
+    SCENARIO_EMPTY,
+    SCENARIO_SETTLED,
+    SCENARIO_PILE,
+    SCENARIO_AVALANCHE,
+    SCENARIO_NOISE,
+    SCENARIO_FLOOD,
+    SCENARIO_COUNT
+} ScenarioKind;
+
+const char* scenario_get_name(ScenarioKind kind);
+bool scenario_find(const char* name, ScenarioKind* kind);
+
+/* Resets the grid and fills it with the given scene; same seed, same scene. */
+bool scenario_generate(Grid* grid, ScenarioKind kind, Uint64 seed);
+
+#endif
@@ -0,0 +1,57 @@
+#include "scheduler/scheduler.h"
+
+void scheduler_initialize(Scheduler* scheduler, double tick_rate, int max_ticks, double budget, int max_backlog) {
+    if (!scheduler)
+        return;
+
+    *scheduler = (Scheduler){
+        .tick_rate = tick_rate,
+        .max_ticks = SDL_max(max_ticks, 1),
+        .budget = budget,
+        .max_backlog = SDL_max(max_backlog, 0),
+    };
+}
+
+int scheduler_begin_frame(Scheduler* scheduler, double elapsed) {
+    if (!scheduler || scheduler->tick_rate <= 0.0)
+        return 0;
+
+    scheduler->frame_ticks = 0;
+    scheduler->accumulator += SDL_max(elapsed, 0.0);
+
+    int shed = scheduler_backlog(scheduler) - scheduler->max_ticks - scheduler->max_backlog;
+    if (shed <= 0)
+        return 0;
+
+    scheduler->accumulator -= shed * scheduler->tick_rate;
+    scheduler->shed_ticks += (Uint64)shed;
+    return shed;
+}
+
+bool scheduler_next_tick(Scheduler* scheduler, double spent) {
+    if (!scheduler || scheduler->tick_rate <= 0.0)
+        return false;
+
+    if (scheduler->accumulator < scheduler->tick_rate || scheduler->frame_ticks >= scheduler->max_ticks)
+        return false;
+
+    /* The first tick always runs, so a frame over budget still makes progress */
+    if (scheduler->frame_ticks > 0 && spent >= scheduler->budget)
+        return false;
+
+    scheduler->accumulator -= scheduler->tick_rate;
+    scheduler->frame_ticks++;
+    return true;
+}
+
+int scheduler_backlog(const Scheduler* scheduler) {
+    if (!scheduler || scheduler->tick_rate <= 0.0)
+        return 0;
+    return (int)SDL_min(scheduler->accumulator / scheduler->tick_rate, (double)SDL_MAX_SINT32);
+}
+
+double scheduler_idle_time(const Scheduler* scheduler) {
+    if (!scheduler)
+        return 0.0;
+    return SDL_max(scheduler->tick_rate - scheduler->accumulator, 0.0);
+}
@@ -0,0 +1,37 @@
+#ifndef FALLING_SAND_SCHEDULER_H
+#define FALLING_SAND_SCHEDULER_H
+
+#include <SDL3/SDL.h>
+#include <stdbool.h>
+
+/*
+ * Fixed-step tick scheduler with bounded catch-up. A frame runs at most
+ * `max_ticks` ticks and stops starting new ones once `budget` seconds went
+ * into stepping; whatever is still owed carries over to later frames. Owing
+ * more than `max_backlog` ticks beyond what one frame may run means the
+ * simulation can't keep up, so the excess is dropped and simulated time runs
+ * slower than wall time instead.
+ */
+typedef struct scheduler {
+    double tick_rate; /* seconds of simulated time per tick */
+    int max_ticks;
+    double budget;
+    int max_backlog;
+    double accumulator; /* simulated time owed */
+    int frame_ticks;
+    Uint64 shed_ticks; /* ticks dropped since initialization */
+} Scheduler;
+
+void scheduler_initialize(Scheduler* scheduler, double tick_rate, int max_ticks, double budget, int max_backlog);
+
+/* Starts a frame `elapsed` seconds after the previous one; returns the ticks it had to drop. */
+int scheduler_begin_frame(Scheduler* scheduler, double elapsed);
+/* True, and counts the tick, while one is due and the frame has ticks and `spent` seconds left. */
+bool scheduler_next_tick(Scheduler* scheduler, double spent);
+
+/* Ticks still owed after this frame. */
+int scheduler_backlog(const Scheduler* scheduler);
+/* Seconds until the next tick is due; 0 while there is a backlog. */
+double scheduler_idle_time(const Scheduler* scheduler);
+
+#endif
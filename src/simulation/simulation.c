@@ -0,0 +1,280 @@
+#include "simulation/simulation.h"
+
+#include "profiler/profiler.h"
+
+bool simulation_queue_push(SimulationQueue* queue, const JournalEvent* event) {
+    if (!queue || !event)
+        return false;
+
+    Uint32 head = SDL_GetAtomicU32(&queue->head);
+    if (head - SDL_GetAtomicU32(&queue->tail) == SIMULATION_COMMAND_QUEUE_SIZE)
+        return false;
+
+    queue->events[head & (SIMULATION_COMMAND_QUEUE_SIZE - 1)] = *event;
+    SDL_SetAtomicU32(&queue->head, head + 1);
+    return true;
+}
+
+bool simulation_queue_pop(SimulationQueue* queue, JournalEvent* event) {
+    if (!queue || !event)
+        return false;
+
+    Uint32 tail = SDL_GetAtomicU32(&queue->tail);
+    if (tail == SDL_GetAtomicU32(&queue->head))
+        return false;
+
+    *event = queue->events[tail & (SIMULATION_COMMAND_QUEUE_SIZE - 1)];
+    SDL_SetAtomicU32(&queue->tail, tail + 1);
+    return true;
+}
+
+static GridRect* simulation_alloc_rects(int count) {
+    GridRect* rects = SDL_malloc((size_t)count * sizeof(GridRect));
+    if (rects) {
+        for (int i = 0; i < count; i++)
+            rects[i] = GRID_RECT_EMPTY;
+    }
+    return rects;
+}
+
+bool simulation_initialize(Simulation* simulation, int width, int height) {
+    if (!simulation)
+        return false;
+
+    *simulation = (Simulation){0};
+    if (!grid_initialize(&simulation->grid, width, height)) {
+        SDL_Log("Couldn't initialize Grid.");
+        return false;
+    }
+
+    if (!workers_initialize(&simulation->workers, SIMULATION_WORKER_THREADS)) {
+        SDL_Log("Couldn't initialize WorkerPool.");
+        goto failed;
+    }
+
+    Grid* grid = &simulation->grid;
+    if (!history_initialize(&simulation->history, grid, HISTORY_MEMORY_BUDGET, HISTORY_MAX_ENTRIES))
+        goto failed;
+
+    int chunk_count = grid->chunks_x * grid->chunks_y;
+    for (int i = 0; i < SIMULATION_FRAME_COUNT; i++) {
+        SimulationFrame* frame = &simulation->frames[i];
+        frame->colors = SDL_calloc((size_t)grid->stride * (size_t)grid->height, sizeof(SDL_Color));
+        frame->paint = simulation_alloc_rects(chunk_count);
+        frame->stale = simulation_alloc_rects(chunk_count);
+        if (!frame->colors || !frame->paint || !frame->stale)
+            goto out_of_memory;
+    }
+
+    simulation->unseen = simulation_alloc_rects(chunk_count);
+    simulation->everything = simulation_alloc_rects(chunk_count);
+    if (!simulation->unseen || !simulation->everything)
+        goto out_of_memory;
+
+    for (int cy = 0; cy < grid->chunks_y; cy++) {
+        for (int cx = 0; cx < grid->chunks_x; cx++) {
+            simulation->everything[cy * grid->chunks_x + cx] = (GridRect){
+                cx * GRID_CHUNK_SIZE,
+                cy * GRID_CHUNK_SIZE,
+                SDL_min((cx + 1) * GRID_CHUNK_SIZE, grid->width) - 1,
+                SDL_min((cy + 1) * GRID_CHUNK_SIZE, grid->height) - 1
+            };
+        }
+    }
+
+    scheduler_initialize(&simulation->scheduler, SIMULATION_TICK_RATE, SIMULATION_MAX_TICKS_PER_FRAME,
+                         SIMULATION_FRAME_BUDGET, SIMULATION_MAX_BACKLOG_TICKS);
+
+    simulation->back = 0;
+    SDL_SetAtomicInt(&simulation->ready, 1);
+    simulation->front = 2;
+
+    return true;
+
+out_of_memory:
+    SDL_Log("Couldn't allocate simulation frames.");
+failed:
+    simulation_destroy(simulation);
+    return false;
+}
+
+/* Applies queued commands before the next tick, recording them when a journal is open. */
+static void simulation_apply_commands(Simulation* simulation) {
+    Grid* grid = &simulation->grid;
+    JournalEvent event;
+
+    while (simulation_queue_pop(&simulation->queue, &event)) {
+        PROFILE_BEGIN(PROFILE_ZONE_COMMANDS);
+        event.tick = grid->tick_count;
+        journal_apply_event(grid, &simulation->history, &event);
+
+        if (simulation->journal.io && !journal_write_event(&simulation->journal, &event)) {
+            SDL_Log("Couldn't record event, recording stopped.");
+            journal_close(&simulation->journal, grid->tick_count);
+        }
+        PROFILE_END(PROFILE_ZONE_COMMANDS);
+    }
+}
+
+static void simulation_step(Simulation* simulation) {
+    PROFILE_BEGIN(PROFILE_ZONE_TICK);
+    if (SIMULATION_WORKER_THREADS > 0)
+        grid_update_parallel(&simulation->grid, &simulation->workers);
+    else
+        grid_update(&simulation->grid);
+    PROFILE_END(PROFILE_ZONE_TICK);
+}
+
+static void simulation_copy_rect(const Grid* grid, SDL_Color* colors, GridRect rect) {
+    size_t row_size = (size_t)(rect.max_x - rect.min_x + 1) * sizeof(SDL_Color);
+    for (int y = rect.min_y; y <= rect.max_y; y++) {
+        int index = grid_index(grid, rect.min_x, y);
+        SDL_memcpy(&colors[index], &grid->colors[index], row_size);
+    }
+}
+
+/* Brings the back frame up to date with the grid and swaps it in as the newest one. */
+static void simulation_publish(Simulation* simulation) {
+    PROFILE_BEGIN(PROFILE_ZONE_PUBLISH);
+    Grid* grid = &simulation->grid;
+    int chunk_count = grid->chunks_x * grid->chunks_y;
+
+    /* Once the newest frame is taken the texture is only behind by what was painted since */
+    bool taken = !(SDL_GetAtomicInt(&simulation->ready) & SIMULATION_FRAME_FRESH);
+
+    for (int i = 0; i < chunk_count; i++) {
+        GridRect painted = grid->paint[i];
+        if (taken)
+            simulation->unseen[i] = painted;
+        if (grid_rect_is_empty(painted))
+            continue;
+
+        grid->paint[i] = GRID_RECT_EMPTY;
+        grid_rect_extend(&simulation->unseen[i], painted);
+        for (int f = 0; f < SIMULATION_FRAME_COUNT; f++)
+            grid_rect_extend(&simulation->frames[f].stale[i], painted);
+    }
+    grid->dirty = false;
+
+    SimulationFrame* frame = &simulation->frames[simulation->back];
+    for (int i = 0; i < chunk_count; i++) {
+        if (!grid_rect_is_empty(frame->stale[i])) {
+            simulation_copy_rect(grid, frame->colors, frame->stale[i]);
+            frame->stale[i] = GRID_RECT_EMPTY;
+        }
+    }
+    SDL_memcpy(frame->paint, simulation->unseen, (size_t)chunk_count * sizeof(GridRect));
+    frame->tick_count = grid->tick_count;
+    frame->shed_ticks = simulation->scheduler.shed_ticks;
+
+    int previous = SDL_SetAtomicInt(&simulation->ready, simulation->back | SIMULATION_FRAME_FRESH);
+    simulation->back = previous & ~SIMULATION_FRAME_FRESH;
+    PROFILE_END(PROFILE_ZONE_PUBLISH);
+}
+
+static int simulation_thread_main(void* data) {
+    Simulation* simulation = data;
+    Scheduler* scheduler = &simulation->scheduler;
+    Uint64 frequency = SDL_GetPerformanceFrequency();
+    Uint64 last_frame = SDL_GetPerformanceCounter();
+    Uint64 last_report = last_frame;
+    Uint64 unreported = 0;
+
+    while (!SDL_GetAtomicInt(&simulation->quit)) {
+        Uint64 frame_start = SDL_GetPerformanceCounter();
+        unreported += (Uint64)scheduler_begin_frame(scheduler, (double)(frame_start - last_frame) / (double)frequency);
+        last_frame = frame_start;
+
+        simulation_apply_commands(simulation);
+        while (scheduler_next_tick(scheduler, (double)(SDL_GetPerformanceCounter() - frame_start) / (double)frequency))
+            simulation_step(simulation);
+
+        if (simulation->grid.dirty)
+            simulation_publish(simulation);
+
+        /* At most one report a second while falling behind */
+        Uint64 now = SDL_GetPerformanceCounter();
+        if (unreported && now - last_report >= frequency) {
+            SDL_Log("Simulation can't keep up, dropped %llu ticks (%d still owed).", (unsigned long long)unreported,
+                    scheduler_backlog(scheduler));
+            unreported = 0;
+            last_report = now;
+        }
+
+        /* Sleep until the next tick is due; a backlog is worked off right away */
+        double idle = scheduler_idle_time(scheduler);
+        if (idle > 0.0)
+            SDL_DelayNS((Uint64)(idle * 1e9));
+    }
+
+    return 0;
+}
+
+bool simulation_start(Simulation* simulation) {
+    if (!simulation || !simulation->grid.arena || simulation->thread)
+        return false;
+
+    SDL_SetAtomicInt(&simulation->quit, 0);
+    simulation->thread = SDL_CreateThread(simulation_thread_main, "simulation", simulation);
+    if (!simulation->thread) {
+        SDL_Log("Couldn't create simulation thread: %s", SDL_GetError());
+        return false;
+    }
+    return true;
+}
+
+void simulation_destroy(Simulation* simulation) {
+    if (!simulation)
+        return;
+
+    if (simulation->thread) {
+        SDL_SetAtomicInt(&simulation->quit, 1);
+        SDL_WaitThread(simulation->thread, NULL);
+    }
+
+    if (simulation->journal.io)
+        journal_close(&simulation->journal, simulation->grid.tick_count);
+
+    for (int i = 0; i < SIMULATION_FRAME_COUNT; i++) {
+        SDL_free(simulation->frames[i].colors);
+        SDL_free(simulation->frames[i].paint);
+        SDL_free(simulation->frames[i].stale);
+    }
+    SDL_free(simulation->unseen);
+    SDL_free(simulation->everything);
+
+    history_destroy(&simulation->history);
+    workers_destroy(&simulation->workers);
+    grid_destroy(&simulation->grid);
+    *simulation = (Simulation){0};
+}
+
+bool simulation_send(Simulation* simulation, const JournalEvent* event) {
+    return simulation && simulation_queue_push(&simulation->queue, event);
+}
+
+/* The newest frame when one was published since the last call, else NULL. */
+static const SimulationFrame* simulation_take_frame(Simulation* simulation) {
+    if (!(SDL_GetAtomicInt(&simulation->ready) & SIMULATION_FRAME_FRESH))
+        return NULL;
+
+    int previous = SDL_SetAtomicInt(&simulation->ready, simulation->front);
+    simulation->front = previous & ~SIMULATION_FRAME_FRESH;
+    return &simulation->frames[simulation->front];
+}
+
+void simulation_render(Simulation* simulation, Display* display) {
+    if (!simulation || !display || !display->renderer || !display->texture)
+        return;
+
+    const SimulationFrame* frame = simulation_take_frame(simulation);
+    if (frame || simulation->reupload) {
+        frame = &simulation->frames[simulation->front];
+        const GridRect* paint = simulation->reupload ? simulation->everything : frame->paint;
+        PROFILE_BEGIN(PROFILE_ZONE_UPLOAD);
+        simulation->reupload = !grid_upload_paint(&simulation->grid, display->texture, frame->colors, paint);
+        PROFILE_END(PROFILE_ZONE_UPLOAD);
+    }
+
+    SDL_RenderTexture(display->renderer, display->texture, NULL, NULL);
+}
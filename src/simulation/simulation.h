@@ -0,0 +1,77 @@
+#ifndef FALLING_SAND_SIMULATION_H
+#define FALLING_SAND_SIMULATION_H
+
+#include <SDL3/SDL.h>
+#include <stdbool.h>
+
+#include "config/simulation_config.h"
+#include "display/display.h"
+#include "grid/grid.h"
+#include "history/history.h"
+#include "journal/journal.h"
+#include "scheduler/scheduler.h"
+#include "workers/workers.h"
+
+#define SIMULATION_FRAME_COUNT 3
+#define SIMULATION_FRAME_FRESH 0x100 /* set in `ready` until the render thread takes the frame */
+
+/* Single-producer single-consumer ring: the render thread pushes, the simulation thread pops. */
+typedef struct simulation_queue {
+    JournalEvent events[SIMULATION_COMMAND_QUEUE_SIZE];
+    SDL_AtomicU32 head; /* next slot to write, only advanced by the producer */
+    SDL_AtomicU32 tail; /* next slot to read, only advanced by the consumer */
+} SimulationQueue;
+
+/*
+ * One finished color frame. `paint` covers everything that changed since the
+ * last frame the render thread is known to have taken, so uploading it brings
+ * the texture up to date no matter how many frames were skipped in between.
+ */
+typedef struct simulation_frame {
+    SDL_Color* colors; /* laid out like the grid's color plane */
+    GridRect* paint;   /* per chunk */
+    GridRect* stale;   /* per chunk: changed since this frame was last written */
+    Uint64 tick_count;
+    Uint64 shed_ticks; /* ticks the scheduler dropped so far */
+} SimulationFrame;
+
+/*
+ * Runs the grid on its own thread at the fixed tick rate, catching up through
+ * a bounded Scheduler after a stall. Commands reach it
+ * through `queue`; finished frames go back through a triple buffer, so neither
+ * side ever waits for the other. Until simulation_start the grid, pool and
+ * journal may be set up directly; afterwards only the simulation thread
+ * touches them.
+ */
+typedef struct simulation {
+    Grid grid;
+    WorkerPool workers;
+    History history; /* undo and redo of the edits the queue brings */
+    Journal journal; /* open while recording */
+    SimulationQueue queue;
+    Scheduler scheduler;
+    SimulationFrame frames[SIMULATION_FRAME_COUNT];
+    GridRect* unseen;     /* per chunk: painted since the last frame known to be taken */
+    GridRect* everything; /* per chunk: its whole bounds, for a full upload */
+    SDL_AtomicInt ready; /* newest frame, ORed with SIMULATION_FRAME_FRESH until taken */
+    int back;            /* simulation thread's frame */
+    int front;           /* render thread's frame */
+    bool reupload;       /* render thread: last upload failed, send the whole frame */
+    SDL_Thread* thread;
+    SDL_AtomicInt quit;
+} Simulation;
+
+bool simulation_queue_push(SimulationQueue* queue, const JournalEvent* event);
+bool simulation_queue_pop(SimulationQueue* queue, JournalEvent* event);
+
+bool simulation_initialize(Simulation* simulation, int width, int height);
+bool simulation_start(Simulation* simulation);
+/* Stops the thread, closes the journal at the final tick and frees everything. */
+void simulation_destroy(Simulation* simulation);
+
+/* Queues a brush, reset, undo or redo for the next tick; false when the queue is full. */
+bool simulation_send(Simulation* simulation, const JournalEvent* event);
+/* Uploads the newest finished frame, if there is one, and draws the texture. */
+void simulation_render(Simulation* simulation, Display* display);
+
+#endif
@@ -0,0 +1,436 @@
+#include "snapshot/snapshot.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define SNAPSHOT_USE_MMAP 1
+#endif
+
+static const char SNAPSHOT_MAGIC[4] = {'F', 'S', 'S', 'N'};
+
+#define SNAPSHOT_HEADER_SIZE 79
+#define SNAPSHOT_TABLE_ENTRY_SIZE 12
+#define SNAPSHOT_CHUNK_CELLS (GRID_CHUNK_SIZE * GRID_CHUNK_SIZE)
+
+/* Growable byte buffer; `failed` sticks once an allocation fails. */
+typedef struct snapshot_buffer {
+    Uint8* data;
+    size_t size;
+    size_t capacity;
+    bool failed;
+} SnapshotBuffer;
+
+/* Bounds-checked cursor over a chunk payload. */
+typedef struct snapshot_reader {
+    const Uint8* data;
+    size_t size;
+    size_t offset;
+} SnapshotReader;
+
+typedef struct snapshot_load_job {
+    const Snapshot* snapshot;
+    Grid* grid;
+    SDL_AtomicInt failed;
+} SnapshotLoadJob;
+
+static Uint8* snapshot_buffer_grow(SnapshotBuffer* buffer, size_t size) {
+    if (buffer->failed)
+        return NULL;
+
+    if (buffer->size + size > buffer->capacity) {
+        size_t capacity = SDL_max(buffer->capacity * 2, buffer->size + size);
+        Uint8* data = SDL_realloc(buffer->data, capacity);
+        if (!data) {
+            buffer->failed = true;
+            return NULL;
+        }
+        buffer->data = data;
+        buffer->capacity = capacity;
+    }
+
+    Uint8* bytes = buffer->data + buffer->size;
+    buffer->size += size;
+    return bytes;
+}
+
+static void snapshot_set_u32(Uint8* bytes, Uint32 value) {
+    for (int i = 0; i < 4; i++)
+        bytes[i] = (Uint8)(value >> (8 * i));
+}
+
+static void snapshot_set_u64(Uint8* bytes, Uint64 value) {
+    for (int i = 0; i < 8; i++)
+        bytes[i] = (Uint8)(value >> (8 * i));
+}
+
+static Uint32 snapshot_get_u32(const Uint8* bytes) {
+    Uint32 value = 0;
+    for (int i = 0; i < 4; i++)
+        value |= (Uint32)bytes[i] << (8 * i);
+    return value;
+}
+
+static Uint64 snapshot_get_u64(const Uint8* bytes) {
+    Uint64 value = 0;
+    for (int i = 0; i < 8; i++)
+        value |= (Uint64)bytes[i] << (8 * i);
+    return value;
+}
+
+static void snapshot_put_bytes(SnapshotBuffer* buffer, const void* bytes, size_t size) {
+    Uint8* out = snapshot_buffer_grow(buffer, size);
+    if (out)
+        SDL_memcpy(out, bytes, size);
+}
+
+/* LEB128, same as the journal. */
+static void snapshot_put_varint(SnapshotBuffer* buffer, Uint32 value) {
+    do {
+        Uint8 byte = value & 0x7F;
+        value >>= 7;
+        if (value)
+            byte |= 0x80;
+        snapshot_put_bytes(buffer, &byte, 1);
+    } while (value);
+}
+
+static bool snapshot_read_varint(SnapshotReader* reader, Uint32* value) {
+    *value = 0;
+    for (int shift = 0; shift < 32; shift += 7) {
+        if (reader->offset >= reader->size)
+            return false;
+        Uint8 byte = reader->data[reader->offset++];
+        *value |= (Uint32)(byte & 0x7F) << shift;
+        if (!(byte & 0x80))
+            return true;
+    }
+    return false;
+}
+
+/* Packs `count` elements of `size` bytes; runs shorter than three stay literal. */
+static void snapshot_pack(SnapshotBuffer* buffer, const Uint8* elements, int count, int size) {
+    int literal_start = 0;
+    int i = 0;
+
+    while (i < count) {
+        int run = 1;
+        while (i + run < count && SDL_memcmp(&elements[(i + run) * size], &elements[i * size], (size_t)size) == 0)
+            run++;
+
+        if (run < 3) {
+            i += run;
+            continue;
+        }
+
+        if (literal_start < i) {
+            snapshot_put_varint(buffer, (Uint32)(i - literal_start) << 1 | 1);
+            snapshot_put_bytes(buffer, &elements[literal_start * size], (size_t)((i - literal_start) * size));
+        }
+        snapshot_put_varint(buffer, (Uint32)run << 1);
+        snapshot_put_bytes(buffer, &elements[i * size], (size_t)size);
+        i += run;
+        literal_start = i;
+    }
+
+    if (literal_start < count) {
+        snapshot_put_varint(buffer, (Uint32)(count - literal_start) << 1 | 1);
+        snapshot_put_bytes(buffer, &elements[literal_start * size], (size_t)((count - literal_start) * size));
+    }
+}
+
+static bool snapshot_unpack(SnapshotReader* reader, Uint8* elements, int count, int size) {
+    int done = 0;
+    while (done < count) {
+        Uint32 token;
+        if (!snapshot_read_varint(reader, &token))
+            return false;
+
+        Uint32 n = token >> 1;
+        if (n == 0 || n > (Uint32)(count - done))
+            return false;
+
+        size_t bytes = (token & 1) ? (size_t)n * (size_t)size : (size_t)size;
+        if (reader->size - reader->offset < bytes)
+            return false;
+
+        Uint8* out = &elements[done * size];
+        if (token & 1) {
+            SDL_memcpy(out, &reader->data[reader->offset], bytes);
+        } else if (size == 1) {
+            SDL_memset(out, reader->data[reader->offset], n);
+        } else {
+            for (Uint32 i = 0; i < n; i++)
+                SDL_memcpy(&out[i * (Uint32)size], &reader->data[reader->offset], (size_t)size);
+        }
+        reader->offset += bytes;
+        done += (int)n;
+    }
+    return true;
+}
+
+static GridRect snapshot_chunk_bounds(int width, int height, int chunk_x, int chunk_y) {
+    return (GridRect){
+        chunk_x * GRID_CHUNK_SIZE,
+        chunk_y * GRID_CHUNK_SIZE,
+        SDL_min((chunk_x + 1) * GRID_CHUNK_SIZE, width) - 1,
+        SDL_min((chunk_y + 1) * GRID_CHUNK_SIZE, height) - 1
+    };
+}
+
+static void snapshot_pack_chunk(SnapshotBuffer* buffer, const Grid* grid, GridRect bounds) {
+    Uint8 types[SNAPSHOT_CHUNK_CELLS];
+    SDL_Color colors[SNAPSHOT_CHUNK_CELLS];
+    int width = bounds.max_x - bounds.min_x + 1;
+    int cells = 0;
+
+    for (int y = bounds.min_y; y <= bounds.max_y; y++) {
+        int row = grid_index(grid, bounds.min_x, y);
+        SDL_memcpy(&types[cells], &grid->types[row], (size_t)width);
+        SDL_memcpy(&colors[cells], &grid->colors[row], (size_t)width * sizeof(SDL_Color));
+        cells += width;
+    }
+
+    snapshot_pack(buffer, types, cells, 1);
+    snapshot_pack(buffer, (const Uint8*)colors, cells, (int)sizeof(SDL_Color));
+}
+
+bool snapshot_save(const Grid* grid, const char* path) {
+    if (!grid || !grid->arena || !path)
+        return false;
+
+    int chunk_count = grid->chunks_x * grid->chunks_y;
+    size_t table_size = (size_t)chunk_count * SNAPSHOT_TABLE_ENTRY_SIZE;
+    SnapshotBuffer buffer = {0};
+    bool saved = false;
+
+    Uint8* header = snapshot_buffer_grow(&buffer, SNAPSHOT_HEADER_SIZE + table_size);
+    if (!header)
+        goto failed;
+
+    SDL_memcpy(header, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+    snapshot_set_u32(header + 4, SNAPSHOT_VERSION);
+    snapshot_set_u32(header + 8, (Uint32)grid->width);
+    snapshot_set_u32(header + 12, (Uint32)grid->height);
+    snapshot_set_u32(header + 16, GRID_CHUNK_SIZE);
+    snapshot_set_u64(header + 20, grid->seed);
+    snapshot_set_u64(header + 28, grid->tick_count);
+    header[36] = 0;
+    header[37] = grid->update_left_to_right ? SNAPSHOT_FLAG_LEFT_TO_RIGHT : 0;
+    for (int i = 0; i < 4; i++)
+        snapshot_set_u64(header + 38 + 8 * i, grid->random.state[i]);
+    snapshot_set_u64(header + 70, grid->random.bits);
+    header[78] = (Uint8)grid->random.bit_count;
+
+    for (int cy = 0; cy < grid->chunks_y; cy++) {
+        for (int cx = 0; cx < grid->chunks_x; cx++) {
+            size_t offset = buffer.size;
+            snapshot_pack_chunk(&buffer, grid, snapshot_chunk_bounds(grid->width, grid->height, cx, cy));
+            if (buffer.failed)
+                goto failed;
+
+            /* The buffer may have moved while growing */
+            Uint8* entry = buffer.data + SNAPSHOT_HEADER_SIZE + (size_t)(cy * grid->chunks_x + cx) * SNAPSHOT_TABLE_ENTRY_SIZE;
+            snapshot_set_u64(entry, offset);
+            snapshot_set_u32(entry + 8, (Uint32)(buffer.size - offset));
+        }
+    }
+
+    if (!SDL_SaveFile(path, buffer.data, buffer.size)) {
+        SDL_Log("Couldn't write snapshot %s: %s", path, SDL_GetError());
+        goto failed;
+    }
+    saved = true;
+
+failed:
+    if (buffer.failed)
+        SDL_Log("Couldn't allocate snapshot buffer.");
+    SDL_free(buffer.data);
+    return saved;
+}
+
+static bool snapshot_map(Snapshot* snapshot, const char* path) {
+#ifdef SNAPSHOT_USE_MMAP
+    int fd = open(path, O_RDONLY);
+    if (fd >= 0) {
+        struct stat info;
+        void* data = MAP_FAILED;
+        if (fstat(fd, &info) == 0 && info.st_size > 0)
+            data = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+        close(fd);
+
+        if (data != MAP_FAILED) {
+            snapshot->data = data;
+            snapshot->size = (size_t)info.st_size;
+            snapshot->mapped = true;
+            return true;
+        }
+    }
+#endif
+
+    /* No mapping available: read the whole file instead */
+    snapshot->data = SDL_LoadFile(path, &snapshot->size);
+    return snapshot->data != NULL;
+}
+
+static bool snapshot_parse(Snapshot* snapshot) {
+    const Uint8* bytes = snapshot->data;
+    if (snapshot->size < SNAPSHOT_HEADER_SIZE || SDL_memcmp(bytes, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) != 0)
+        return false;
+    snapshot->version = snapshot_get_u32(bytes + 4);
+    if (snapshot->version < SNAPSHOT_OLDEST_VERSION || snapshot->version > SNAPSHOT_VERSION ||
+        snapshot_get_u32(bytes + 16) != GRID_CHUNK_SIZE)
+        return false;
+
+    Uint32 width = snapshot_get_u32(bytes + 8);
+    Uint32 height = snapshot_get_u32(bytes + 12);
+    if (width == 0 || height == 0 || width > SDL_MAX_SINT32 || height > SDL_MAX_SINT32 || bytes[78] > 64)
+        return false;
+
+    SnapshotHeader* header = &snapshot->header;
+    header->width = (int)width;
+    header->height = (int)height;
+    header->seed = snapshot_get_u64(bytes + 20);
+    header->tick_count = snapshot_get_u64(bytes + 28);
+    header->update_left_to_right = (bytes[37] & SNAPSHOT_FLAG_LEFT_TO_RIGHT) != 0;
+    for (int i = 0; i < 4; i++)
+        header->random.state[i] = snapshot_get_u64(bytes + 38 + 8 * i);
+    header->random.bits = snapshot_get_u64(bytes + 70);
+    header->random.bit_count = bytes[78];
+
+    snapshot->chunks_x = (header->width + GRID_CHUNK_SIZE - 1) / GRID_CHUNK_SIZE;
+    snapshot->chunks_y = (header->height + GRID_CHUNK_SIZE - 1) / GRID_CHUNK_SIZE;
+
+    size_t chunk_count = (size_t)snapshot->chunks_x * (size_t)snapshot->chunks_y;
+    if ((snapshot->size - SNAPSHOT_HEADER_SIZE) / SNAPSHOT_TABLE_ENTRY_SIZE < chunk_count)
+        return false;
+
+    for (size_t i = 0; i < chunk_count; i++) {
+        const Uint8* entry = bytes + SNAPSHOT_HEADER_SIZE + i * SNAPSHOT_TABLE_ENTRY_SIZE;
+        Uint64 offset = snapshot_get_u64(entry);
+        Uint32 size = snapshot_get_u32(entry + 8);
+        if (offset > snapshot->size || size > snapshot->size - offset)
+            return false;
+    }
+
+    return true;
+}
+
+bool snapshot_open(Snapshot* snapshot, const char* path) {
+    if (!snapshot || !path)
+        return false;
+
+    *snapshot = (Snapshot){0};
+    if (!snapshot_map(snapshot, path)) {
+        SDL_Log("Couldn't open snapshot %s: %s", path, SDL_GetError());
+        return false;
+    }
+
+    if (!snapshot_parse(snapshot)) {
+        SDL_Log("%s is not a snapshot this build can read.", path);
+        snapshot_close(snapshot);
+        return false;
+    }
+
+    return true;
+}
+
+void snapshot_close(Snapshot* snapshot) {
+    if (!snapshot || !snapshot->data)
+        return;
+
+#ifdef SNAPSHOT_USE_MMAP
+    if (snapshot->mapped)
+        munmap((void*)snapshot->data, snapshot->size);
+    else
+#endif
+        SDL_free((void*)snapshot->data);
+
+    *snapshot = (Snapshot){0};
+}
+
+static bool snapshot_decode_chunk(const Snapshot* snapshot, Grid* grid, int chunk_x, int chunk_y) {
+    const Uint8* entry = snapshot->data + SNAPSHOT_HEADER_SIZE +
+                         (size_t)(chunk_y * snapshot->chunks_x + chunk_x) * SNAPSHOT_TABLE_ENTRY_SIZE;
+    SnapshotReader reader = {
+        .data = snapshot->data + snapshot_get_u64(entry),
+        .size = snapshot_get_u32(entry + 8),
+    };
+
+    Uint8 types[SNAPSHOT_CHUNK_CELLS];
+    SDL_Color colors[SNAPSHOT_CHUNK_CELLS];
+    GridRect bounds = snapshot_chunk_bounds(grid->width, grid->height, chunk_x, chunk_y);
+    int width = bounds.max_x - bounds.min_x + 1;
+    int cells = width * (bounds.max_y - bounds.min_y + 1);
+
+    if (!snapshot_unpack(&reader, types, cells, 1) ||
+        !snapshot_unpack(&reader, (Uint8*)colors, cells, (int)sizeof(SDL_Color)))
+        return false;
+
+    int occupied = 0;
+    for (int i = 0; i < cells; i++) {
+        /* Also rules out the border type */
+        if (types[i] >= PARTICLE_TYPE_COUNT)
+            return false;
+        occupied += types[i] != EMPTY;
+    }
+
+    /* Version 1 gens have no meaning for the moved bits, which are clear between ticks */
+    Uint8 gens[SNAPSHOT_CHUNK_CELLS];
+    if (snapshot->version == 1 && !snapshot_unpack(&reader, gens, occupied, 1))
+        return false;
+
+    int cell = 0;
+    for (int y = bounds.min_y; y <= bounds.max_y; y++) {
+        int row = grid_index(grid, bounds.min_x, y);
+        SDL_memcpy(&grid->types[row], &types[cell], (size_t)width);
+        SDL_memcpy(&grid->colors[row], &colors[cell], (size_t)width * sizeof(SDL_Color));
+        cell += width;
+    }
+
+    return true;
+}
+
+static void snapshot_load_job(void* data, int index) {
+    SnapshotLoadJob* job = data;
+    const Snapshot* snapshot = job->snapshot;
+    if (!snapshot_decode_chunk(snapshot, job->grid, index % snapshot->chunks_x, index / snapshot->chunks_x))
+        SDL_SetAtomicInt(&job->failed, 1);
+}
+
+bool snapshot_load(const Snapshot* snapshot, Grid* grid, WorkerPool* workers) {
+    if (!snapshot || !snapshot->data || !grid || !grid->arena)
+        return false;
+    if (grid->width != snapshot->header.width || grid->height != snapshot->header.height) {
+        SDL_Log("Snapshot is %dx%d, grid is %dx%d.", snapshot->header.width, snapshot->header.height, grid->width,
+                grid->height);
+        return false;
+    }
+
+    SnapshotLoadJob job = {.snapshot = snapshot, .grid = grid};
+    workers_run(workers, snapshot_load_job, &job, snapshot->chunks_x * snapshot->chunks_y);
+
+    /*
+     * Side by side chunks share bitboard words and every chunk adds to the grid's
+     * counts, so both are rebuilt once all are decoded
+     */
+    grid_sync_bitboards(grid, (GridRect){0, 0, grid->width - 1, grid->height - 1});
+    grid_sync_counts(grid, (GridRect){0, 0, grid->width - 1, grid->height - 1});
+    if (SDL_GetAtomicInt(&job.failed)) {
+        SDL_Log("Snapshot is corrupt.");
+        return false;
+    }
+
+    const SnapshotHeader* header = &snapshot->header;
+    grid->seed = header->seed;
+    grid->tick_count = header->tick_count;
+    grid->update_left_to_right = header->update_left_to_right;
+    grid->random = header->random;
+
+    /* Nothing is known to be asleep, so every chunk gets visited and uploaded */
+    grid_wake_region(grid, (GridRect){0, 0, grid->width - 1, grid->height - 1});
+    grid->dirty = true;
+
+    return true;
+}
@@ -0,0 +1,63 @@
+#ifndef FALLING_SAND_SNAPSHOT_H
+#define FALLING_SAND_SNAPSHOT_H
+
+#include <SDL3/SDL.h>
+#include <stdbool.h>
+
+#include "grid/grid.h"
+#include "random/random.h"
+#include "workers/workers.h"
+
+/*
+ * Compressed world snapshot: the cell planes plus everything a grid needs to
+ * carry on exactly where the saved one stopped (seed, tick and RNG state).
+ *
+ * Layout, little endian: "FSSN", u32 version, u32 width, u32 height, u32 chunk
+ * size, u64 seed, u64 tick count, u8 unused (0), u8 flags, u64 x4 RNG state,
+ * u64 RNG bits, u8 RNG bit count, then one u64 offset + u32 size per chunk in
+ * row-major order, then the chunk payloads. Every chunk is packed on its own,
+ * so any one of them can be decoded straight out of the file.
+ *
+ * A chunk payload holds its type and color cells in row-major order as packed
+ * streams: varint (n << 1) followed by one element repeated n times, or varint
+ * (n << 1 | 1) followed by n literal elements. Nothing has moved yet between
+ * ticks, so there is no per-cell update state to store.
+ *
+ * Version 1 files also carry the old update gen: one header byte, and a third
+ * stream per chunk with a gen for each non-empty cell. Both are skipped on load.
+ */
+#define SNAPSHOT_VERSION 2
+#define SNAPSHOT_OLDEST_VERSION 1
+
+#define SNAPSHOT_FLAG_LEFT_TO_RIGHT 0x01
+
+typedef struct snapshot_header {
+    int width;
+    int height;
+    Uint64 seed;
+    Uint64 tick_count;
+    bool update_left_to_right;
+    Random random;
+} SnapshotHeader;
+
+/* An open snapshot file, memory-mapped where the platform allows it. */
+typedef struct snapshot {
+    const Uint8* data;
+    size_t size;
+    bool mapped;
+    Uint32 version;
+    SnapshotHeader header;
+    int chunks_x;
+    int chunks_y;
+} Snapshot;
+
+bool snapshot_save(const Grid* grid, const char* path);
+
+/* Maps the file and checks the header and chunk table; no cells are decoded yet. */
+bool snapshot_open(Snapshot* snapshot, const char* path);
+void snapshot_close(Snapshot* snapshot);
+
+/* Decodes every chunk over the pool (NULL runs inline) and restores the grid state. */
+bool snapshot_load(const Snapshot* snapshot, Grid* grid, WorkerPool* workers);
+
+#endif
@@ -0,0 +1,122 @@
+#include <SDL3/SDL.h>
+
+#include "workers/workers.h"
+
+static void workers_drain(WorkerPool* pool) {
+    int index;
+    while ((index = SDL_AddAtomicInt(&pool->next_index, 1)) < pool->job_count)
+        pool->job(pool->job_data, index);
+}
+
+static int workers_thread_main(void* data) {
+    WorkerThread* thread = data;
+    WorkerPool* pool = thread->pool;
+    int seen_generation = 0;
+
+    SDL_LockMutex(pool->mutex);
+    for (;;) {
+        while (!pool->quit && pool->generation == seen_generation)
+            SDL_WaitCondition(pool->start_condition, pool->mutex);
+
+        if (pool->quit)
+            break;
+
+        seen_generation = pool->generation;
+        SDL_UnlockMutex(pool->mutex);
+
+        workers_drain(pool);
+
+        SDL_LockMutex(pool->mutex);
+        if (--pool->busy == 0)
+            SDL_SignalCondition(pool->done_condition);
+    }
+    SDL_UnlockMutex(pool->mutex);
+
+    return 0;
+}
+
+bool workers_initialize(WorkerPool* pool, int thread_count) {
+    if (!pool || thread_count < 0 || thread_count > WORKERS_MAX_THREADS)
+        return false;
+
+    *pool = (WorkerPool){0};
+    if (thread_count == 0)
+        return true;
+
+    pool->mutex = SDL_CreateMutex();
+    pool->start_condition = SDL_CreateCondition();
+    pool->done_condition = SDL_CreateCondition();
+    if (!pool->mutex || !pool->start_condition || !pool->done_condition) {
+        SDL_Log("Couldn't create worker synchronization: %s", SDL_GetError());
+        goto failed;
+    }
+
+    for (int i = 0; i < thread_count; i++) {
+        pool->threads[i].pool = pool;
+        pool->threads[i].thread = SDL_CreateThread(workers_thread_main, "grid_worker", &pool->threads[i]);
+        if (!pool->threads[i].thread) {
+            SDL_Log("Couldn't create worker thread: %s", SDL_GetError());
+            goto failed;
+        }
+        pool->thread_count++;
+    }
+
+    return true;
+failed:
+    workers_destroy(pool);
+    return false;
+}
+
+void workers_destroy(WorkerPool* pool) {
+    if (!pool)
+        return;
+
+    if (pool->thread_count > 0) {
+        SDL_LockMutex(pool->mutex);
+        pool->quit = true;
+        SDL_BroadcastCondition(pool->start_condition);
+        SDL_UnlockMutex(pool->mutex);
+
+        for (int i = 0; i < pool->thread_count; i++)
+            SDL_WaitThread(pool->threads[i].thread, NULL);
+    }
+
+    if (pool->done_condition)
+        SDL_DestroyCondition(pool->done_condition);
+
+    if (pool->start_condition)
+        SDL_DestroyCondition(pool->start_condition);
+
+    if (pool->mutex)
+        SDL_DestroyMutex(pool->mutex);
+
+    *pool = (WorkerPool){0};
+}
+
+void workers_run(WorkerPool* pool, WorkerJob job, void* data, int count) {
+    if (!job || count <= 0)
+        return;
+
+    if (!pool || pool->thread_count == 0) {
+        for (int i = 0; i < count; i++)
+            job(data, i);
+        return;
+    }
+
+    SDL_LockMutex(pool->mutex);
+    pool->job = job;
+    pool->job_data = data;
+    pool->job_count = count;
+    SDL_SetAtomicInt(&pool->next_index, 0);
+    pool->busy = pool->thread_count;
+    pool->generation++;
+    SDL_BroadcastCondition(pool->start_condition);
+    SDL_UnlockMutex(pool->mutex);
+
+    workers_drain(pool);
+
+    SDL_LockMutex(pool->mutex);
+    while (pool->busy > 0)
+        SDL_WaitCondition(pool->done_condition, pool->mutex);
+    SDL_UnlockMutex(pool->mutex);
+}
@@ -0,0 +1,41 @@
+#ifndef FALLING_SAND_WORKERS_H
+#define FALLING_SAND_WORKERS_H
+
+#include <SDL3/SDL.h>
+#include <stdbool.h>
+
+#include "config/simulation_config.h"
+
+typedef void (*WorkerJob)(void* data, int index);
+
+typedef struct worker_thread {
+    struct worker_pool* pool;
+    SDL_Thread* thread;
+} WorkerThread;
+
+/*
+ * Fixed set of threads that run one batch of indexed jobs at a time. The
+ * calling thread takes part in every batch, so a pool with no threads simply
+ * runs the batch inline.
+ */
+typedef struct worker_pool {
+    WorkerThread threads[WORKERS_MAX_THREADS];
+    int thread_count;
+    SDL_Mutex* mutex;
+    SDL_Condition* start_condition;
+    SDL_Condition* done_condition;
+    WorkerJob job;
+    void* job_data;
+    int job_count;
+    SDL_AtomicInt next_index;
+    int generation;
+    int busy;
+    bool quit;
+} WorkerPool;
+
+bool workers_initialize(WorkerPool* pool, int thread_count);
+void workers_destroy(WorkerPool* pool);
+
+void workers_run(WorkerPool* pool, WorkerJob job, void* data, int count);
+
+#endif
@@ -0,0 +1,333 @@
+/*
+ * Microbenchmarks for the grid hot paths. Like tests/test_grid.c, grid.c is
+ * included directly with its SDL texture calls redirected, so grid_render's
+ * packing runs against a plain pixel buffer and nothing needs a window.
+ *
+ * Every case is warmed up, then timed over several repeats from the same
+ * starting state; the spread between repeats is printed next to the mean.
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+/* ── Mock redirections ───────────────────────────────────────────────── */
+
+#define SDL_UpdateTexture                  fake_SDL_UpdateTexture
+#define SDL_RenderTexture                  fake_SDL_RenderTexture
+
+#include "grid/grid.h"
+#include "grid/grid.c"
+
+#undef SDL_UpdateTexture
+#undef SDL_RenderTexture
+
+#include "scenario/scenario.h"
+
+#define BENCH_DEFAULT_WIDTH 1920
+#define BENCH_DEFAULT_HEIGHT 1080
+#define BENCH_DEFAULT_REPEATS 15
+#define BENCH_DEFAULT_WARMUP 3
+#define BENCH_MAX_REPEATS 1000
+#define BENCH_SEED 1
+#define BENCH_SWAPS (1 << 16)
+#define BENCH_UPDATE_TICKS 10
+#define BENCH_BRUSHES 256
+
+/* ── Fake texture ────────────────────────────────────────────────────── */
+
+/* Stands in for the texture: uploads are copied here at the source pitch. */
+static Uint8* fake_pixels;
+static int fake_pixels_pitch;
+
+bool fake_SDL_UpdateTexture(SDL_Texture* texture, const SDL_Rect* rect, const void* pixels, int pitch) {
+    (void)texture;
+    for (int y = 0; y < rect->h; y++) {
+        SDL_memcpy(&fake_pixels[(size_t)(rect->y + y) * (size_t)fake_pixels_pitch + (size_t)rect->x * 4],
+                   (const Uint8*)pixels + (size_t)y * (size_t)pitch, (size_t)rect->w * 4);
+    }
+    return true;
+}
+
+bool fake_SDL_RenderTexture(SDL_Renderer* renderer, SDL_Texture* texture, const SDL_FRect* srcrect,
+                            const SDL_FRect* dstrect) {
+    (void)renderer;
+    (void)texture;
+    (void)srcrect;
+    (void)dstrect;
+    return true;
+}
+
+/* ── Harness ─────────────────────────────────────────────────────────── */
+
+typedef struct bench_options {
+    int width;
+    int height;
+    int repeats;
+    int warmup;
+    const char* filter; /* only cases whose name contains it */
+} BenchOptions;
+
+typedef enum bench_engine {
+    BENCH_ENGINE_SCAN,
+    BENCH_ENGINE_MARGOLUS,
+    BENCH_ENGINE_BUFFERED,
+    BENCH_ENGINE_COUNT
+} BenchEngine;
+
+static const char* const BENCH_ENGINE_NAMES[BENCH_ENGINE_COUNT] = {"update", "margolus", "buffered"};
+
+typedef struct bench_context {
+    const BenchOptions* options;
+    Grid grid;
+    Random random;
+    Coordinates* coordinates; /* BENCH_SWAPS * 2 random cells */
+    ScenarioKind scenario;
+    BenchEngine engine;
+    int radius;
+    bool checker;
+} BenchContext;
+
+/* Sets up untimed, runs the timed part once and returns its performance counter ticks. */
+typedef Uint64 (*BenchFunction)(BenchContext* context);
+
+static int bench_compare_doubles(const void* a, const void* b) {
+    double left = *(const double*)a;
+    double right = *(const double*)b;
+    return (left > right) - (left < right);
+}
+
+/* Runs a case `warmup` times unmeasured, then `repeats` times, and prints ns per op. */
+static void bench_run(BenchContext* context, const char* name, BenchFunction function, int ops) {
+    const BenchOptions* options = context->options;
+    if (options->filter && !SDL_strstr(name, options->filter))
+        return;
+
+    for (int i = 0; i < options->warmup; i++)
+        function(context);
+
+    static double samples[BENCH_MAX_REPEATS];
+    double to_ns = 1e9 / (double)SDL_GetPerformanceFrequency();
+    double total = 0.0;
+    for (int i = 0; i < options->repeats; i++) {
+        samples[i] = (double)function(context) * to_ns / ops;
+        total += samples[i];
+    }
+
+    double mean = total / options->repeats;
+    double variance = 0.0;
+    for (int i = 0; i < options->repeats; i++)
+        variance += (samples[i] - mean) * (samples[i] - mean);
+    double stddev = options->repeats > 1 ? SDL_sqrt(variance / (options->repeats - 1)) : 0.0;
+
+    SDL_qsort(samples, (size_t)options->repeats, sizeof(double), bench_compare_doubles);
+    printf("%-20s %8d %14.1f %12.1f %7.2f%% %14.1f %14.1f\n", name, ops, mean, stddev,
+           mean > 0.0 ? stddev * 100.0 / mean : 0.0, samples[0], samples[options->repeats / 2]);
+}
+
+static Uint64 bench_elapsed(Uint64 start) {
+    return SDL_GetPerformanceCounter() - start;
+}
+
+/* ── Cases ───────────────────────────────────────────────────────────── */
+
+static Uint64 bench_swap(BenchContext* context) {
+    Grid* grid = &context->grid;
+    scenario_generate(grid, SCENARIO_NOISE, BENCH_SEED);
+
+    Uint64 start = SDL_GetPerformanceCounter();
+    for (int i = 0; i < BENCH_SWAPS; i++)
+        grid_swap(grid, context->coordinates[2 * i], context->coordinates[2 * i + 1]);
+    return bench_elapsed(start);
+}
+
+static Uint64 bench_update(BenchContext* context) {
+    Grid* grid = &context->grid;
+    scenario_generate(grid, context->scenario, BENCH_SEED);
+
+    Uint64 start = SDL_GetPerformanceCounter();
+    for (int i = 0; i < BENCH_UPDATE_TICKS; i++) {
+        if (context->engine == BENCH_ENGINE_MARGOLUS)
+            grid_update_margolus(grid, NULL);
+        else if (context->engine == BENCH_ENGINE_BUFFERED)
+            grid_update_buffered(grid, NULL);
+        else
+            grid_update(grid);
+    }
+    return bench_elapsed(start);
+}
+
+/* Each op stamps sand and erases it again, so every repeat does the same work. */
+static Uint64 bench_brush(BenchContext* context) {
+    Grid* grid = &context->grid;
+    grid_reset(grid);
+
+    Uint64 start = SDL_GetPerformanceCounter();
+    for (int i = 0; i < BENCH_BRUSHES; i++) {
+        grid_apply_brush(grid, context->coordinates[i], context->radius, SAND);
+        grid_apply_brush(grid, context->coordinates[i], context->radius, EMPTY);
+    }
+    return bench_elapsed(start);
+}
+
+/* Fills the whole grid and clears it again, so every repeat does the same work. */
+static Uint64 bench_fill(BenchContext* context) {
+    Grid* grid = &context->grid;
+    GridRect everything = {0, 0, grid->width - 1, grid->height - 1};
+    grid_reset(grid);
+
+    Uint64 start = SDL_GetPerformanceCounter();
+    grid_fill_rect(grid, everything, SAND);
+    grid_fill_rect(grid, everything, EMPTY);
+    return bench_elapsed(start);
+}
+
+/* Floods the empty grid behind a rock maze of rows with one gap each, then floods it back. */
+static Uint64 bench_flood(BenchContext* context) {
+    Grid* grid = &context->grid;
+    grid_reset(grid);
+    for (int y = 4; y < grid->height; y += 8) {
+        int gap = (y / 8) % 2 ? grid->width - 2 : 1;
+        grid_fill_rect(grid, (GridRect){0, y, grid->width - 1, y}, ROCK);
+        grid_fill_rect(grid, (GridRect){gap, y, gap, y}, EMPTY);
+    }
+
+    Uint64 start = SDL_GetPerformanceCounter();
+    grid_flood_fill(grid, (Coordinates){0, 0}, WATER);
+    grid_flood_fill(grid, (Coordinates){0, 0}, EMPTY);
+    return bench_elapsed(start);
+}
+
+/* Paints every chunk, or every other one in a checkerboard so no two spans merge. */
+static Uint64 bench_render(BenchContext* context) {
+    Grid* grid = &context->grid;
+    for (int cy = 0; cy < grid->chunks_y; cy++) {
+        for (int cx = 0; cx < grid->chunks_x; cx++) {
+            bool painted = !context->checker || (cx + cy) % 2 == 0;
+            grid->paint[cy * grid->chunks_x + cx] = painted ? grid_chunk_bounds(grid, cx, cy) : GRID_RECT_EMPTY;
+        }
+    }
+    grid->dirty = true;
+
+    Display display = {.renderer = (SDL_Renderer*)0x1, .texture = (SDL_Texture*)0x2};
+    Uint64 start = SDL_GetPerformanceCounter();
+    grid_render(grid, &display);
+    return bench_elapsed(start);
+}
+
+/* ── Runner ──────────────────────────────────────────────────────────── */
+
+static void bench_print_usage(void) {
+    fprintf(stderr,
+            "Usage: grid_bench [options]\n"
+            "  --size WIDTHxHEIGHT   grid size (default %dx%d)\n"
+            "  --repeats N           measured repeats per case (default %d, at most %d)\n"
+            "  --warmup N            unmeasured repeats run first (default %d)\n"
+            "  --filter TEXT         only run cases whose name contains TEXT\n",
+            BENCH_DEFAULT_WIDTH, BENCH_DEFAULT_HEIGHT, BENCH_DEFAULT_REPEATS, BENCH_MAX_REPEATS,
+            BENCH_DEFAULT_WARMUP);
+}
+
+static bool bench_parse_options(int argc, char* argv[], BenchOptions* options) {
+    *options = (BenchOptions){
+        .width = BENCH_DEFAULT_WIDTH,
+        .height = BENCH_DEFAULT_HEIGHT,
+        .repeats = BENCH_DEFAULT_REPEATS,
+        .warmup = BENCH_DEFAULT_WARMUP,
+    };
+
+    for (int i = 1; i < argc; i++) {
+        const char* option = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : NULL;
+        if (!value)
+            return false;
+        i++;
+
+        if (SDL_strcmp(option, "--size") == 0) {
+            if (SDL_sscanf(value, "%dx%d", &options->width, &options->height) != 2)
+                return false;
+        } else if (SDL_strcmp(option, "--repeats") == 0) {
+            options->repeats = SDL_atoi(value);
+        } else if (SDL_strcmp(option, "--warmup") == 0) {
+            options->warmup = SDL_atoi(value);
+        } else if (SDL_strcmp(option, "--filter") == 0) {
+            options->filter = value;
+        } else {
+            return false;
+        }
+    }
+
+    return options->width > 0 && options->height > 0 && options->repeats > 0 &&
+           options->repeats <= BENCH_MAX_REPEATS && options->warmup >= 0;
+}
+
+int main(int argc, char* argv[]) {
+    BenchOptions options;
+    if (!bench_parse_options(argc, argv, &options)) {
+        bench_print_usage();
+        return 1;
+    }
+
+    int status = 1;
+    BenchContext context = {.options = &options};
+    if (!grid_initialize(&context.grid, options.width, options.height)) {
+        SDL_Log("Couldn't initialize Grid.");
+        goto failed;
+    }
+
+    fake_pixels_pitch = options.width * 4;
+    fake_pixels = SDL_malloc((size_t)fake_pixels_pitch * (size_t)options.height);
+    context.coordinates = SDL_malloc(2 * BENCH_SWAPS * sizeof(Coordinates));
+    if (!fake_pixels || !context.coordinates) {
+        SDL_Log("Couldn't allocate benchmark buffers.");
+        goto failed;
+    }
+
+    random_seed(&context.random, BENCH_SEED);
+    for (int i = 0; i < 2 * BENCH_SWAPS; i++) {
+        context.coordinates[i] = (Coordinates){random_below(&context.random, options.width),
+                                               random_below(&context.random, options.height)};
+    }
+
+    printf("grid %dx%d, %d repeats after %d warmup, ns per op\n\n", options.width, options.height,
+           options.repeats, options.warmup);
+    printf("%-20s %8s %14s %12s %8s %14s %14s\n", "case", "ops", "mean", "stddev", "cv", "min", "median");
+
+    bench_run(&context, "swap", bench_swap, BENCH_SWAPS);
+
+    /* Every engine on the same scenes, serially */
+    for (int engine = 0; engine < BENCH_ENGINE_COUNT; engine++) {
+        for (int kind = 0; kind < SCENARIO_COUNT; kind++) {
+            char name[32];
+            SDL_snprintf(name, sizeof(name), "%s/%s", BENCH_ENGINE_NAMES[engine],
+                         scenario_get_name((ScenarioKind)kind));
+            context.scenario = (ScenarioKind)kind;
+            context.engine = (BenchEngine)engine;
+            bench_run(&context, name, bench_update, BENCH_UPDATE_TICKS);
+        }
+    }
+
+    for (int radius = MIN_BRUSH_RADIUS; radius <= MAX_BRUSH_RADIUS; radius++) {
+        char name[32];
+        SDL_snprintf(name, sizeof(name), "brush/r%d", radius);
+        context.radius = radius;
+        bench_run(&context, name, bench_brush, 2 * BENCH_BRUSHES);
+    }
+
+    bench_run(&context, "region/fill", bench_fill, 2);
+    bench_run(&context, "region/flood", bench_flood, 2);
+
+    scenario_generate(&context.grid, SCENARIO_NOISE, BENCH_SEED);
+    context.checker = false;
+    bench_run(&context, "render/full", bench_render, 1);
+    context.checker = true;
+    bench_run(&context, "render/checker", bench_render, 1);
+
+    status = 0;
+
+failed:
+    SDL_free(context.coordinates);
+    SDL_free(fake_pixels);
+    grid_destroy(&context.grid);
+    return status;
+}
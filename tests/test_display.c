@@ -445,6 +445,7 @@ static void test_initialize_success(void) {
     Display display = {0};
     DisplayConfig config = {
         .title = "Title", .width = 640, .height = 480,
+        .texture_width = 128, .texture_height = 96,
         .window_flags = SDL_WINDOW_MOUSE_GRABBED,
         .init_flags = SDL_INIT_VIDEO,
         .presentation = (SDL_RendererLogicalPresentation)3
@@ -472,8 +473,8 @@ static void test_initialize_success(void) {
     assert(fake_sdl.last_texture_renderer == fake_sdl.created_renderer);
     assert(fake_sdl.last_texture_format == SDL_PIXELFORMAT_RGBA32);
     assert(fake_sdl.last_texture_access == SDL_TEXTUREACCESS_STREAMING);
-    assert(fake_sdl.last_texture_width == GRID_WIDTH);
-    assert(fake_sdl.last_texture_height == GRID_HEIGHT);
+    assert(fake_sdl.last_texture_width == config.texture_width);
+    assert(fake_sdl.last_texture_height == config.texture_height);
     assert(fake_sdl.last_scale_texture == fake_sdl.created_texture);
     assert(fake_sdl.last_scale_mode == SDL_SCALEMODE_NEAREST);
     assert(display.window == fake_sdl.created_window);
@@ -2,29 +2,28 @@
 #include <stdarg.h>
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 #include <string.h>
 
 /* ── Mock redirections ───────────────────────────────────────────────── */
 
 #define SDL_Log                            fake_SDL_Log
-#define SDL_LockTexture                    fake_SDL_LockTexture
-#define SDL_UnlockTexture                  fake_SDL_UnlockTexture
+#define SDL_UpdateTexture                  fake_SDL_UpdateTexture
 #define SDL_RenderTexture                  fake_SDL_RenderTexture
 #define SDL_GetError                       fake_SDL_GetError
-#define particle_is_empty                  fake_particle_is_empty
-#define particle_is_solid                  fake_particle_is_solid
+#define particle_is_type_empty             fake_particle_is_type_empty
+#define particle_is_type_solid             fake_particle_is_type_solid
 #define particle_get_random_color_by_type  fake_particle_get_random_color_by_type
 
 #include "grid/grid.h"
 #include "grid/grid.c"
 
 #undef SDL_Log
-#undef SDL_LockTexture
-#undef SDL_UnlockTexture
+#undef SDL_UpdateTexture
 #undef SDL_RenderTexture
 #undef SDL_GetError
-#undef particle_is_empty
-#undef particle_is_solid
+#undef particle_is_type_empty
+#undef particle_is_type_solid
 #undef particle_get_random_color_by_type
 
 /* ── Fake state ──────────────────────────────────────────────────────── */
@@ -33,8 +32,7 @@ typedef struct FakeState {
     int log_calls;
     int is_empty_calls;
     int random_color_calls;
-    int lock_calls;
-    int unlock_calls;
+    int update_calls;
     int render_texture_calls;
 
     /* Last particle_is_empty result override */
@@ -44,9 +42,11 @@ typedef struct FakeState {
     ParticleType last_random_color_type;
     SDL_Color    random_color_return;
 
-    /* Texture lock behavior */
-    bool lock_return;
-    SDL_Texture *last_locked_texture;
+    /* Texture update behavior */
+    bool update_return;
+    SDL_Texture *last_updated_texture;
+    SDL_Rect last_updated_rect;
+    int updated_cells;
     SDL_Texture *last_rendered_texture;
     SDL_Renderer *last_rendered_renderer;
 } FakeState;
@@ -57,7 +57,7 @@ static void reset_fake_state(void) {
     memset(&fake_state, 0, sizeof(fake_state));
     fake_state.is_empty_return = true;
     fake_state.random_color_return = (SDL_Color){100, 100, 100, 255};
-    fake_state.lock_return = true;
+    fake_state.update_return = true;
 }
 
 static Uint8 fake_pixels[GRID_HEIGHT][GRID_WIDTH * 4];
@@ -72,28 +72,23 @@ void fake_SDL_Log(const char *fmt, ...) {
     fake_state.log_calls++;
 }
 
-bool fake_SDL_LockTexture(SDL_Texture *texture, const SDL_Rect *rect,
-                          void **pixels, int *pitch) {
-    (void)rect;
-    fake_state.lock_calls++;
-    fake_state.last_locked_texture = texture;
-    if (!fake_state.lock_return) {
+/* Copies the rect into fake_pixels the way the texture would, honoring the source pitch. */
+bool fake_SDL_UpdateTexture(SDL_Texture *texture, const SDL_Rect *rect,
+                            const void *pixels, int pitch) {
+    fake_state.update_calls++;
+    fake_state.last_updated_texture = texture;
+    if (!fake_state.update_return) {
         return false;
     }
-    if (pixels) {
-        *pixels = fake_pixels;
-    }
-    if (pitch) {
-        *pitch = GRID_WIDTH * 4;
+    SDL_Rect area = rect ? *rect : (SDL_Rect){0, 0, GRID_WIDTH, GRID_HEIGHT};
+    fake_state.last_updated_rect = area;
+    fake_state.updated_cells += area.w * area.h;
+    for (int y = 0; y < area.h; y++) {
+        memcpy(&fake_pixels[area.y + y][area.x * 4], (const Uint8 *)pixels + y * pitch, (size_t)area.w * 4);
     }
     return true;
 }
 
-void fake_SDL_UnlockTexture(SDL_Texture *texture) {
-    (void)texture;
-    fake_state.unlock_calls++;
-}
-
 bool fake_SDL_RenderTexture(SDL_Renderer *renderer, SDL_Texture *texture,
                             const SDL_FRect *srcrect, const SDL_FRect *dstrect) {
     (void)srcrect;
@@ -104,18 +99,17 @@ bool fake_SDL_RenderTexture(SDL_Renderer *renderer, SDL_Texture *texture,
     return true;
 }
 
-bool fake_particle_is_empty(const Particle *particle) {
+bool fake_particle_is_type_empty(ParticleType type) {
     fake_state.is_empty_calls++;
-    if (!particle) { return false; }
-    return particle->type == EMPTY;
+    return type == EMPTY;
 }
 
-bool fake_particle_is_solid(const Particle *particle) {
-    if (!particle) { return false; }
-    return particle->type == ROCK;
+bool fake_particle_is_type_solid(ParticleType type) {
+    return type == ROCK;
 }
 
-SDL_Color fake_particle_get_random_color_by_type(ParticleType type) {
+SDL_Color fake_particle_get_random_color_by_type(ParticleType type, Random *random) {
+    assert(random);
     fake_state.random_color_calls++;
     fake_state.last_random_color_type = type;
     return fake_state.random_color_return;
@@ -125,10 +119,58 @@ const char *fake_SDL_GetError(void) { return "fake sdl error"; }
 
 /* ── Helper ──────────────────────────────────────────────────────────── */
 
+#define MAX_TEST_GRIDS 256
+
+static Grid *test_grids[MAX_TEST_GRIDS];
+static int test_grid_count;
+
+/* Initializes a grid at the configured size; main() frees them all at exit. */
+static bool setup_grid(Grid *grid) {
+    assert(test_grid_count < MAX_TEST_GRIDS);
+    if (!grid_initialize(grid, GRID_WIDTH, GRID_HEIGHT))
+        return false;
+    test_grids[test_grid_count++] = grid;
+    return true;
+}
+
+static void destroy_test_grids(void) {
+    for (int i = 0; i < test_grid_count; i++)
+        grid_destroy(test_grids[i]);
+    test_grid_count = 0;
+}
+
+static void copy_grid(Grid *destination, const Grid *source) {
+    assert(setup_grid(destination));
+    assert(destination->arena_size == source->arena_size);
+    memcpy(destination->arena, source->arena, source->arena_size);
+    destination->update_left_to_right = source->update_left_to_right;
+    destination->dirty = source->dirty;
+    destination->seed = source->seed;
+    destination->tick_count = source->tick_count;
+    destination->random = source->random;
+    memcpy(destination->counts, source->counts, sizeof(source->counts));
+}
+
+static bool grid_planes_equal(Grid *a, Grid *b) {
+    for (int y = 0; y < a->height; y++) {
+        int row = grid_index(a, 0, y);
+        if (memcmp(&a->types[row], &b->types[row], (size_t)a->width) != 0)
+            return false;
+        if (memcmp(&a->colors[row], &b->colors[row], (size_t)a->width * sizeof(SDL_Color)) != 0)
+            return false;
+    }
+    return true;
+}
+
+static void put_particle(Grid *grid, int x, int y, ParticleType type, SDL_Color color) {
+    grid->types[grid_index(grid, x, y)] = (Uint8)type;
+    grid->colors[grid_index(grid, x, y)] = color;
+}
+
 static void fill_grid_with(Grid *grid, ParticleType type, SDL_Color color) {
     for (int y = 0; y < GRID_HEIGHT; y++) {
         for (int x = 0; x < GRID_WIDTH; x++) {
-            grid->particles[y][x] = (Particle){.type = type, .color = color};
+            put_particle(grid, x, y, type, color);
         }
     }
 }
@@ -139,12 +181,20 @@ static SDL_Color get_pixel(int x, int y) {
     return color;
 }
 
+static int count_type(Grid *grid, ParticleType type) {
+    int count = 0;
+    for (int y = 0; y < GRID_HEIGHT; y++)
+        for (int x = 0; x < GRID_WIDTH; x++)
+            count += grid->types[grid_index(grid, x, y)] == type;
+    return count;
+}
+
 /* Local helper — grid_is_empty was removed from the public API */
 static bool test_helper_grid_is_empty(Grid *grid) {
     if (!grid) return false;
     for (int y = 0; y < GRID_HEIGHT; y++)
         for (int x = 0; x < GRID_WIDTH; x++)
-            if (grid->particles[y][x].type != EMPTY) return false;
+            if (grid->types[grid_index(grid, x, y)] != EMPTY) return false;
     return true;
 }
 
@@ -154,24 +204,97 @@ static bool test_helper_grid_is_empty(Grid *grid) {
 
 static void test_initialize_null(void) {
     reset_fake_state();
-    assert(!grid_initialize(NULL));
+    assert(!grid_initialize(NULL, GRID_WIDTH, GRID_HEIGHT));
+}
+
+static void test_initialize_bad_size(void) {
+    Grid grid;
+    reset_fake_state();
+
+    assert(!grid_initialize(&grid, 0, GRID_HEIGHT));
+    assert(!grid_initialize(&grid, GRID_WIDTH, -1));
+    assert(grid.arena == NULL);
+}
+
+static void test_initialize_too_large(void) {
+    Grid grid;
+    reset_fake_state();
+
+    assert(!grid_initialize(&grid, 1 << 20, 1 << 20));
+    assert(grid.arena == NULL);
+    assert(fake_state.log_calls == 1);
 }
 
 static void test_initialize_success(void) {
     static Grid grid;
-    fill_grid_with(&grid, SAND, SAND_BASE_COLOR);
     reset_fake_state();
 
-    assert(grid_initialize(&grid));
+    assert(setup_grid(&grid));
     assert(fake_state.log_calls == 0);
+    assert(grid.width == GRID_WIDTH);
+    assert(grid.height == GRID_HEIGHT);
 
     for (int y = 0; y < GRID_HEIGHT; y++) {
         for (int x = 0; x < GRID_WIDTH; x++) {
-            assert(grid.particles[y][x].type == EMPTY);
+            assert(grid.types[grid_index(&grid, x, y)] == EMPTY);
         }
     }
 }
 
+static void test_initialize_aligns_rows(void) {
+    static Grid grid;
+    setup_grid(&grid);
+
+    assert(grid.stride > grid.width);
+    assert(grid.stride % GRID_ALIGNMENT == 0);
+    assert((uintptr_t)grid.arena % GRID_ALIGNMENT == 0);
+    for (int y = 0; y < grid.height; y++) {
+        assert((uintptr_t)&grid.types[grid_index(&grid, 0, y)] % GRID_ALIGNMENT == 0);
+        assert((uintptr_t)&grid.colors[grid_index(&grid, 0, y)] % GRID_ALIGNMENT == 0);
+    }
+}
+
+static void test_initialize_pads_with_border(void) {
+    static Grid grid;
+    setup_grid(&grid);
+
+    /* Every neighbor of every edge cell reads as border */
+    for (int x = -1; x <= grid.width; x++) {
+        assert(grid.types[grid_index(&grid, x, -1)] == GRID_BORDER_TYPE);
+        assert(grid.types[grid_index(&grid, x, grid.height)] == GRID_BORDER_TYPE);
+    }
+    for (int y = 0; y < grid.height; y++) {
+        assert(grid.types[grid_index(&grid, -1, y)] == GRID_BORDER_TYPE);
+        assert(grid.types[grid_index(&grid, grid.width, y)] == GRID_BORDER_TYPE);
+    }
+}
+
+static void test_initialize_runtime_sizes(void) {
+    static const int sizes[][2] = {{1, 1}, {7, 5}, {33, 65}, {1000, 700}};
+
+    for (size_t i = 0; i < SDL_arraysize(sizes); i++) {
+        Grid grid;
+        assert(grid_initialize(&grid, sizes[i][0], sizes[i][1]));
+        assert(grid.chunks_x == (sizes[i][0] + GRID_CHUNK_SIZE - 1) / GRID_CHUNK_SIZE);
+        assert(grid.chunks_y == (sizes[i][1] + GRID_CHUNK_SIZE - 1) / GRID_CHUNK_SIZE);
+
+        /* A grain dropped in the top-right corner ends up on the floor */
+        Coordinates corner = {grid.width - 1, 0};
+        grid_set_particle(&grid, corner, &(Particle){.type = SAND, .color = SAND_BASE_COLOR});
+        for (int tick = 0; tick < grid.height + 1; tick++)
+            grid_update(&grid);
+        assert(grid_get_particle_type(&grid, (Coordinates){grid.width - 1, grid.height - 1}) == SAND);
+
+        grid_destroy(&grid);
+        assert(grid.arena == NULL);
+    }
+}
+
+static void test_destroy_null(void) {
+    grid_destroy(NULL);
+    /* Should not crash */
+}
+
 static void test_cleanup_null(void) {
     reset_fake_state();
     assert(!grid_reset(NULL));
@@ -179,6 +302,7 @@ static void test_cleanup_null(void) {
 
 static void test_cleanup_success(void) {
     static Grid grid;
+    setup_grid(&grid);
     fill_grid_with(&grid, ROCK, ROCK_BASE_COLOR);
     reset_fake_state();
 
@@ -186,7 +310,7 @@ static void test_cleanup_success(void) {
 
     for (int y = 0; y < GRID_HEIGHT; y++) {
         for (int x = 0; x < GRID_WIDTH; x++) {
-            assert(grid.particles[y][x].type == EMPTY);
+            assert(grid.types[grid_index(&grid, x, y)] == EMPTY);
         }
     }
 }
@@ -198,11 +322,12 @@ static void test_cleanup_null_cleanup(void) {
 
 static void test_cleanup_clears(void) {
     static Grid grid;
+    setup_grid(&grid);
     fill_grid_with(&grid, SAND, SAND_BASE_COLOR);
     reset_fake_state();
 
     assert(grid_reset(&grid));
-    assert(grid.particles[0][0].type == EMPTY);
+    assert(grid.types[grid_index(&grid, 0, 0)] == EMPTY);
 }
 
 /* ────────────────────────────────────────────────────────────────────── */
@@ -210,35 +335,60 @@ static void test_cleanup_clears(void) {
 /* ────────────────────────────────────────────────────────────────────── */
 
 static void test_in_bounds_corners(void) {
-    assert(grid_is_in_bounds((Coordinates){0, 0}));
-    assert(grid_is_in_bounds((Coordinates){GRID_WIDTH - 1, 0}));
-    assert(grid_is_in_bounds((Coordinates){0, GRID_HEIGHT - 1}));
-    assert(grid_is_in_bounds((Coordinates){GRID_WIDTH - 1, GRID_HEIGHT - 1}));
+    static Grid grid;
+    setup_grid(&grid);
+
+    assert(grid_is_in_bounds(&grid, (Coordinates){0, 0}));
+    assert(grid_is_in_bounds(&grid, (Coordinates){GRID_WIDTH - 1, 0}));
+    assert(grid_is_in_bounds(&grid, (Coordinates){0, GRID_HEIGHT - 1}));
+    assert(grid_is_in_bounds(&grid, (Coordinates){GRID_WIDTH - 1, GRID_HEIGHT - 1}));
 }
 
 static void test_in_bounds_center(void) {
-    assert(grid_is_in_bounds((Coordinates){GRID_WIDTH / 2, GRID_HEIGHT / 2}));
+    static Grid grid;
+    setup_grid(&grid);
+
+    assert(grid_is_in_bounds(&grid, (Coordinates){GRID_WIDTH / 2, GRID_HEIGHT / 2}));
 }
 
 static void test_out_of_bounds_negative_x(void) {
-    assert(!grid_is_in_bounds((Coordinates){-1, 0}));
+    static Grid grid;
+    setup_grid(&grid);
+
+    assert(!grid_is_in_bounds(&grid, (Coordinates){-1, 0}));
 }
 
 static void test_out_of_bounds_negative_y(void) {
-    assert(!grid_is_in_bounds((Coordinates){0, -1}));
+    static Grid grid;
+    setup_grid(&grid);
+
+    assert(!grid_is_in_bounds(&grid, (Coordinates){0, -1}));
 }
 
 static void test_out_of_bounds_overflow_x(void) {
-    assert(!grid_is_in_bounds((Coordinates){GRID_WIDTH, 0}));
+    static Grid grid;
+    setup_grid(&grid);
+
+    assert(!grid_is_in_bounds(&grid, (Coordinates){GRID_WIDTH, 0}));
 }
 
 static void test_out_of_bounds_overflow_y(void) {
-    assert(!grid_is_in_bounds((Coordinates){0, GRID_HEIGHT}));
+    static Grid grid;
+    setup_grid(&grid);
+
+    assert(!grid_is_in_bounds(&grid, (Coordinates){0, GRID_HEIGHT}));
 }
 
 static void test_out_of_bounds_both(void) {
-    assert(!grid_is_in_bounds((Coordinates){GRID_WIDTH, GRID_HEIGHT}));
-    assert(!grid_is_in_bounds((Coordinates){-1, -1}));
+    static Grid grid;
+    setup_grid(&grid);
+
+    assert(!grid_is_in_bounds(&grid, (Coordinates){GRID_WIDTH, GRID_HEIGHT}));
+    assert(!grid_is_in_bounds(&grid, (Coordinates){-1, -1}));
+}
+
+static void test_in_bounds_null_grid(void) {
+    assert(!grid_is_in_bounds(NULL, (Coordinates){0, 0}));
 }
 
 /* ────────────────────────────────────────────────────────────────────── */
@@ -252,7 +402,7 @@ static void test_is_empty_null(void) {
 
 static void test_is_empty_true(void) {
     static Grid grid;
-    grid_initialize(&grid);
+    setup_grid(&grid);
     reset_fake_state();
 
     assert(test_helper_grid_is_empty(&grid));
@@ -260,8 +410,8 @@ static void test_is_empty_true(void) {
 
 static void test_is_empty_false_first_cell(void) {
     static Grid grid;
-    grid_initialize(&grid);
-    grid.particles[0][0].type = SAND;
+    setup_grid(&grid);
+    grid.types[grid_index(&grid, 0, 0)] = SAND;
     reset_fake_state();
 
     assert(!test_helper_grid_is_empty(&grid));
@@ -269,8 +419,8 @@ static void test_is_empty_false_first_cell(void) {
 
 static void test_is_empty_false_last_cell(void) {
     static Grid grid;
-    grid_initialize(&grid);
-    grid.particles[GRID_HEIGHT - 1][GRID_WIDTH - 1].type = ROCK;
+    setup_grid(&grid);
+    grid.types[grid_index(&grid, GRID_WIDTH - 1, GRID_HEIGHT - 1)] = ROCK;
     reset_fake_state();
 
     assert(!test_helper_grid_is_empty(&grid));
@@ -287,7 +437,7 @@ static void test_particle_empty_null_grid(void) {
 
 static void test_particle_empty_out_of_bounds(void) {
     static Grid grid;
-    grid_initialize(&grid);
+    setup_grid(&grid);
     reset_fake_state();
 
     assert(!grid_is_particle_empty(&grid, (Coordinates){-1, 0}));
@@ -296,7 +446,7 @@ static void test_particle_empty_out_of_bounds(void) {
 
 static void test_particle_empty_true(void) {
     static Grid grid;
-    grid_initialize(&grid);
+    setup_grid(&grid);
     reset_fake_state();
 
     assert(grid_is_particle_empty(&grid, (Coordinates){5, 5}));
@@ -304,8 +454,8 @@ static void test_particle_empty_true(void) {
 
 static void test_particle_empty_false(void) {
     static Grid grid;
-    grid_initialize(&grid);
-    grid.particles[5][5].type = SAND;
+    setup_grid(&grid);
+    grid.types[grid_index(&grid, 5, 5)] = SAND;
     reset_fake_state();
 
     assert(!grid_is_particle_empty(&grid, (Coordinates){5, 5}));
@@ -324,7 +474,7 @@ static void test_set_particle_null_grid(void) {
 
 static void test_set_particle_out_of_bounds(void) {
     static Grid grid;
-    grid_initialize(&grid);
+    setup_grid(&grid);
     Particle p = {.type = SAND, .color = SAND_BASE_COLOR};
     reset_fake_state();
 
@@ -335,37 +485,37 @@ static void test_set_particle_out_of_bounds(void) {
 
 static void test_set_particle_success(void) {
     static Grid grid;
-    grid_initialize(&grid);
+    setup_grid(&grid);
     Particle p = {.type = ROCK, .color = ROCK_BASE_COLOR};
     Coordinates pos = {10, 20};
     reset_fake_state();
 
     assert(grid_set_particle(&grid, pos, &p));
-    assert(grid.particles[pos.y][pos.x].type == ROCK);
-    assert(grid.particles[pos.y][pos.x].color.r == ROCK_BASE_COLOR.r);
-    assert(grid.particles[pos.y][pos.x].color.g == ROCK_BASE_COLOR.g);
-    assert(grid.particles[pos.y][pos.x].color.b == ROCK_BASE_COLOR.b);
+    assert(grid.types[grid_index(&grid, pos.x, pos.y)] == ROCK);
+    assert(grid.colors[grid_index(&grid, pos.x, pos.y)].r == ROCK_BASE_COLOR.r);
+    assert(grid.colors[grid_index(&grid, pos.x, pos.y)].g == ROCK_BASE_COLOR.g);
+    assert(grid.colors[grid_index(&grid, pos.x, pos.y)].b == ROCK_BASE_COLOR.b);
     assert(fake_state.log_calls == 0);
 }
 
 static void test_set_particle_overwrite(void) {
     static Grid grid;
-    grid_initialize(&grid);
+    setup_grid(&grid);
     Particle sand = {.type = SAND, .color = SAND_BASE_COLOR};
     Particle rock = {.type = ROCK, .color = ROCK_BASE_COLOR};
     Coordinates pos = {0, 0};
 
     grid_set_particle(&grid, pos, &sand);
-    assert(grid.particles[0][0].type == SAND);
+    assert(grid.types[grid_index(&grid, 0, 0)] == SAND);
 
     reset_fake_state();
     assert(grid_set_particle(&grid, pos, &rock));
-    assert(grid.particles[0][0].type == ROCK);
+    assert(grid.types[grid_index(&grid, 0, 0)] == ROCK);
 }
 
 static void test_set_particle_corners(void) {
     static Grid grid;
-    grid_initialize(&grid);
+    setup_grid(&grid);
     Particle p = {.type = SAND, .color = SAND_BASE_COLOR};
     reset_fake_state();
 
@@ -387,7 +537,7 @@ static void test_place_particle_null_grid(void) {
 
 static void test_place_particle_out_of_bounds(void) {
     static Grid grid;
-    grid_initialize(&grid);
+    setup_grid(&grid);
     reset_fake_state();
 
     assert(!grid_place_particle(&grid, (Coordinates){GRID_WIDTH, 0}, SAND));
@@ -395,12 +545,12 @@ static void test_place_particle_out_of_bounds(void) {
 
 static void test_place_particle_sand(void) {
     static Grid grid;
-    grid_initialize(&grid);
+    setup_grid(&grid);
     Coordinates pos = {10, 20};
     reset_fake_state();
 
     assert(grid_place_particle(&grid, pos, SAND));
-    assert(grid.particles[pos.y][pos.x].type == SAND);
+    assert(grid.types[grid_index(&grid, pos.x, pos.y)] == SAND);
     assert(fake_state.random_color_calls == 1);
     assert(fake_state.last_random_color_type == SAND);
     assert(fake_state.log_calls == 0);
@@ -408,40 +558,40 @@ static void test_place_particle_sand(void) {
 
 static void test_place_particle_rock(void) {
     static Grid grid;
-    grid_initialize(&grid);
+    setup_grid(&grid);
     Coordinates pos = {50, 100};
     reset_fake_state();
 
     assert(grid_place_particle(&grid, pos, ROCK));
-    assert(grid.particles[pos.y][pos.x].type == ROCK);
+    assert(grid.types[grid_index(&grid, pos.x, pos.y)] == ROCK);
     assert(fake_state.random_color_calls == 1);
     assert(fake_state.last_random_color_type == ROCK);
 }
 
 static void test_place_particle_empty(void) {
     static Grid grid;
-    grid_initialize(&grid);
-    grid.particles[0][0].type = SAND;
+    setup_grid(&grid);
+    grid.types[grid_index(&grid, 0, 0)] = SAND;
     reset_fake_state();
 
     assert(grid_place_particle(&grid, (Coordinates){0, 0}, EMPTY));
-    assert(grid.particles[0][0].type == EMPTY);
+    assert(grid.types[grid_index(&grid, 0, 0)] == EMPTY);
     assert(fake_state.random_color_calls == 1);
     assert(fake_state.last_random_color_type == EMPTY);
 }
 
 static void test_place_particle_uses_random_color(void) {
     static Grid grid;
-    grid_initialize(&grid);
+    setup_grid(&grid);
     Coordinates pos = {5, 5};
     reset_fake_state();
     fake_state.random_color_return = (SDL_Color){11, 22, 33, 44};
 
     assert(grid_place_particle(&grid, pos, SAND));
-    assert(grid.particles[pos.y][pos.x].color.r == 11);
-    assert(grid.particles[pos.y][pos.x].color.g == 22);
-    assert(grid.particles[pos.y][pos.x].color.b == 33);
-    assert(grid.particles[pos.y][pos.x].color.a == 44);
+    assert(grid.colors[grid_index(&grid, pos.x, pos.y)].r == 11);
+    assert(grid.colors[grid_index(&grid, pos.x, pos.y)].g == 22);
+    assert(grid.colors[grid_index(&grid, pos.x, pos.y)].b == 33);
+    assert(grid.colors[grid_index(&grid, pos.x, pos.y)].a == 44);
 }
 
 /* ────────────────────────────────────────────────────────────────────── */
@@ -449,39 +599,63 @@ static void test_place_particle_uses_random_color(void) {
 /* ────────────────────────────────────────────────────────────────────── */
 
 static void test_get_particle_null_grid(void) {
+    Particle p;
     reset_fake_state();
-    assert(grid_get_particle(NULL, (Coordinates){0, 0}) == NULL);
+    assert(!grid_get_particle(NULL, (Coordinates){0, 0}, &p));
+}
+
+static void test_get_particle_null_output(void) {
+    static Grid grid;
+    setup_grid(&grid);
+    reset_fake_state();
+
+    assert(!grid_get_particle(&grid, (Coordinates){0, 0}, NULL));
 }
 
 static void test_get_particle_out_of_bounds(void) {
     static Grid grid;
-    grid_initialize(&grid);
+    setup_grid(&grid);
+    Particle p;
     reset_fake_state();
 
-    assert(grid_get_particle(&grid, (Coordinates){-1, 0}) == NULL);
+    assert(!grid_get_particle(&grid, (Coordinates){-1, 0}, &p));
 }
 
 static void test_get_particle_success(void) {
     static Grid grid;
-    grid_initialize(&grid);
+    setup_grid(&grid);
     Coordinates pos = {10, 20};
-    grid.particles[pos.y][pos.x].type = SAND;
+    put_particle(&grid, pos.x, pos.y, SAND, (SDL_Color){1, 2, 3, 4});
     reset_fake_state();
 
-    const Particle *p = grid_get_particle(&grid, pos);
-    assert(p != NULL);
-    assert(p->type == SAND);
-    assert(p == &grid.particles[pos.y][pos.x]);
+    Particle p;
+    assert(grid_get_particle(&grid, pos, &p));
+    assert(p.type == SAND);
+    assert(p.color.r == 1 && p.color.g == 2 && p.color.b == 3 && p.color.a == 4);
     assert(fake_state.log_calls == 0);
 }
 
-static void test_get_particle_returns_address(void) {
+static void test_get_particle_type(void) {
     static Grid grid;
-    grid_initialize(&grid);
-    Coordinates pos = {0, 0};
+    setup_grid(&grid);
+    grid.types[grid_index(&grid, 4, 3)] = ROCK;
 
-    const Particle *p = grid_get_particle(&grid, pos);
-    assert(p == &grid.particles[0][0]);
+    assert(grid_get_particle_type(&grid, (Coordinates){4, 3}) == ROCK);
+    assert(grid_get_particle_type(&grid, (Coordinates){3, 4}) == EMPTY);
+    assert(grid_get_particle_type(&grid, (Coordinates){-1, 0}) == EMPTY);
+    assert(grid_get_particle_type(NULL, (Coordinates){0, 0}) == EMPTY);
+}
+
+static void test_set_then_get_round_trip(void) {
+    static Grid grid;
+    setup_grid(&grid);
+    Particle in = {.type = ROCK, .color = {9, 8, 7, 6}};
+    Particle out;
+
+    assert(grid_set_particle(&grid, (Coordinates){GRID_WIDTH - 1, GRID_HEIGHT - 1}, &in));
+    assert(grid_get_particle(&grid, (Coordinates){GRID_WIDTH - 1, GRID_HEIGHT - 1}, &out));
+    assert(out.type == in.type);
+    assert(memcmp(&out.color, &in.color, sizeof(SDL_Color)) == 0);
 }
 
 /* ────────────────────────────────────────────────────────────────────── */
@@ -496,21 +670,21 @@ static void test_update_null(void) {
 
 static void test_update_calls_particle_update(void) {
     static Grid grid;
-    grid_initialize(&grid);
+    setup_grid(&grid);
     /* Place a sand particle and verify it moves after update */
-    grid.particles[0][5] = (Particle){.type = SAND, .color = SAND_BASE_COLOR};
+    put_particle(&grid, 5, 0, SAND, SAND_BASE_COLOR);
     reset_fake_state();
 
     grid_update(&grid);
 
     /* Sand at row 0 should have fallen to row 1 */
-    assert(grid.particles[0][5].type == EMPTY);
-    assert(grid.particles[1][5].type == SAND);
+    assert(grid.types[grid_index(&grid, 5, 0)] == EMPTY);
+    assert(grid.types[grid_index(&grid, 5, 1)] == SAND);
 }
 
 static void test_update_alternates_direction(void) {
     static Grid grid;
-    grid_initialize(&grid);
+    setup_grid(&grid);
     reset_fake_state();
 
     assert(grid.update_left_to_right == true);
@@ -534,7 +708,7 @@ static void test_render_null_grid(void) {
 
 static void test_render_null_display(void) {
     static Grid grid;
-    grid_initialize(&grid);
+    setup_grid(&grid);
     reset_fake_state();
 
     grid_render(&grid, NULL);
@@ -543,7 +717,7 @@ static void test_render_null_display(void) {
 
 static void test_render_null_renderer(void) {
     static Grid grid;
-    grid_initialize(&grid);
+    setup_grid(&grid);
     Display display = {.texture = (SDL_Texture *)0x3};
     reset_fake_state();
 
@@ -553,7 +727,7 @@ static void test_render_null_renderer(void) {
 
 static void test_render_null_texture(void) {
     static Grid grid;
-    grid_initialize(&grid);
+    setup_grid(&grid);
     Display display = {.renderer = (SDL_Renderer *)0x1};
     reset_fake_state();
 
@@ -563,17 +737,16 @@ static void test_render_null_texture(void) {
 
 static void test_render_empty_grid(void) {
     static Grid grid;
-    grid_initialize(&grid);
+    setup_grid(&grid);
     grid.dirty = true;
     Display display = {.renderer = (SDL_Renderer *)0x1, .texture = (SDL_Texture *)0x3};
     reset_fake_state();
 
     grid_render(&grid, &display);
     assert(fake_state.log_calls == 0);
-    assert(fake_state.lock_calls == 1);
-    assert(fake_state.unlock_calls == 1);
+    assert(fake_state.update_calls == 1);
     assert(fake_state.render_texture_calls == 1);
-    assert(fake_state.last_locked_texture == display.texture);
+    assert(fake_state.last_updated_texture == display.texture);
     assert(fake_state.last_rendered_texture == display.texture);
     assert(fake_state.last_rendered_renderer == display.renderer);
     assert(get_pixel(0, 0).r == EMPTY_BASE_COLOR.r);
@@ -581,8 +754,8 @@ static void test_render_empty_grid(void) {
 
 static void test_render_single_particle(void) {
     static Grid grid;
-    grid_initialize(&grid);
-     grid.particles[0][0] = (Particle){.type = SAND, .color = SAND_BASE_COLOR};
+    setup_grid(&grid);
+     put_particle(&grid, 0, 0, SAND, SAND_BASE_COLOR);
     grid.dirty = true;
     Display display = {.renderer = (SDL_Renderer *)0x1, .texture = (SDL_Texture *)0x3};
     reset_fake_state();
@@ -597,10 +770,10 @@ static void test_render_single_particle(void) {
 
 static void test_render_multiple_particles(void) {
     static Grid grid;
-    grid_initialize(&grid);
-       grid.particles[0][0]   = (Particle){.type = SAND, .color = SAND_BASE_COLOR};
-    grid.particles[5][10]  = (Particle){.type = ROCK, .color = ROCK_BASE_COLOR};
-    grid.particles[100][50] = (Particle){.type = SAND, .color = SAND_BASE_COLOR};
+    setup_grid(&grid);
+       put_particle(&grid, 0, 0, SAND, SAND_BASE_COLOR);
+    put_particle(&grid, 10, 5, ROCK, ROCK_BASE_COLOR);
+    put_particle(&grid, 50, 100, SAND, SAND_BASE_COLOR);
     grid.dirty = true;
     Display display = {.renderer = (SDL_Renderer *)0x1, .texture = (SDL_Texture *)0x3};
     reset_fake_state();
@@ -614,6 +787,7 @@ static void test_render_multiple_particles(void) {
 
 static void test_render_full_grid(void) {
     static Grid grid;
+    setup_grid(&grid);
     fill_grid_with(&grid, SAND, SAND_BASE_COLOR);
     grid.dirty = true;
     Display display = {.renderer = (SDL_Renderer *)0x1, .texture = (SDL_Texture *)0x3};
@@ -621,110 +795,1520 @@ static void test_render_full_grid(void) {
 
     grid_render(&grid, &display);
     assert(fake_state.render_texture_calls == 1);
-    assert(fake_state.lock_calls == 1);
-    assert(fake_state.unlock_calls == 1);
+    assert(fake_state.update_calls == 1);
+    assert(fake_state.updated_cells == GRID_WIDTH * GRID_HEIGHT);
+}
+
+static void test_render_clears_paint(void) {
+    static Grid grid;
+    setup_grid(&grid);
+    Display display = {.renderer = (SDL_Renderer *)0x1, .texture = (SDL_Texture *)0x3};
+    reset_fake_state();
+
+    grid_render(&grid, &display);
+    assert(!grid.dirty);
+    for (int i = 0; i < grid.chunks_x * grid.chunks_y; i++)
+        assert(grid_rect_is_empty(grid.paint[i]));
+}
+
+static void test_render_uploads_changed_cells_only(void) {
+    static Grid grid;
+    setup_grid(&grid);
+    Display display = {.renderer = (SDL_Renderer *)0x1, .texture = (SDL_Texture *)0x3};
+    grid_render(&grid, &display);
+
+    grid_set_particle(&grid, (Coordinates){40, 40}, &(Particle){.type = SAND, .color = SAND_BASE_COLOR});
+    reset_fake_state();
+    grid_render(&grid, &display);
+
+    assert(fake_state.update_calls == 1);
+    assert(fake_state.last_updated_rect.x == 39 && fake_state.last_updated_rect.y == 39);
+    assert(fake_state.last_updated_rect.w == 3 && fake_state.last_updated_rect.h == 3);
+    assert(get_pixel(40, 40).r == SAND_BASE_COLOR.r);
+    assert(!grid.dirty);
+}
+
+static void test_render_separate_regions_update_separately(void) {
+    static Grid grid;
+    setup_grid(&grid);
+    Display display = {.renderer = (SDL_Renderer *)0x1, .texture = (SDL_Texture *)0x3};
+    grid_render(&grid, &display);
+
+    grid_set_particle(&grid, (Coordinates){5, 5}, &(Particle){.type = SAND, .color = SAND_BASE_COLOR});
+    grid_set_particle(&grid, (Coordinates){GRID_WIDTH - 5, GRID_HEIGHT - 5},
+                      &(Particle){.type = ROCK, .color = ROCK_BASE_COLOR});
+    reset_fake_state();
+    grid_render(&grid, &display);
+
+    assert(fake_state.update_calls == 2);
+    assert(fake_state.updated_cells == 2 * 9);
+    assert(get_pixel(5, 5).r == SAND_BASE_COLOR.r);
+    assert(get_pixel(GRID_WIDTH - 5, GRID_HEIGHT - 5).r == ROCK_BASE_COLOR.r);
+}
+
+static void test_render_update_failure_keeps_paint(void) {
+    static Grid grid;
+    setup_grid(&grid);
+    Display display = {.renderer = (SDL_Renderer *)0x1, .texture = (SDL_Texture *)0x3};
+    grid_render(&grid, &display);
+
+    grid_set_particle(&grid, (Coordinates){70, 20}, &(Particle){.type = SAND, .color = SAND_BASE_COLOR});
+    reset_fake_state();
+    fake_state.update_return = false;
+    grid_render(&grid, &display);
+    assert(fake_state.log_calls == 1);
+    assert(grid.dirty);
+
+    fake_state.update_return = true;
+    grid_render(&grid, &display);
+    assert(get_pixel(70, 20).r == SAND_BASE_COLOR.r);
+    assert(!grid.dirty);
 }
 
 /* ────────────────────────────────────────────────────────────────────── */
 /*  Integration: place → get round-trip                                  */
 /* ────────────────────────────────────────────────────────────────────── */
 
-static void test_render_not_dirty_skips_lock(void) {
+static void test_render_not_dirty_skips_update(void) {
     static Grid grid;
-    grid_initialize(&grid);
+    setup_grid(&grid);
     grid.dirty = false;
     Display display = {.renderer = (SDL_Renderer *)0x1, .texture = (SDL_Texture *)0x3};
     reset_fake_state();
 
     grid_render(&grid, &display);
-    /* Should still present texture but skip lock/unlock */
+    /* Should still present texture but skip the upload */
     assert(fake_state.render_texture_calls == 1);
-    assert(fake_state.lock_calls == 0);
-    assert(fake_state.unlock_calls == 0);
+    assert(fake_state.update_calls == 0);
 }
 
 /* ────────────────────────────────────────────────────────────────────── */
-/*  Generation counter: double-step prevention                           */
+/*  Moved bits: double-step prevention                                   */
 /* ────────────────────────────────────────────────────────────────────── */
 
-static void test_update_increments_gen(void) {
-    static Grid grid;
-    grid_initialize(&grid);
-    reset_fake_state();
+static bool moved_bits_clear(Grid *grid) {
+    for (int i = 0; i < grid->height * grid->stride / GRID_MOVED_BITS; i++)
+        if (grid->moved[i] != 0)
+            return false;
+    return true;
+}
 
-    Uint8 gen_before = grid.current_gen;
-    grid_update(&grid);
-    assert(grid.current_gen == (Uint8)(gen_before + 1));
-    grid_update(&grid);
-    assert(grid.current_gen == (Uint8)(gen_before + 2));
+static void test_update_clears_moved_bits(void) {
+    static Grid grid;
+    setup_grid(&grid);
+    fill_grid_with(&grid, EMPTY, EMPTY_BASE_COLOR);
+    for (int x = 0; x < GRID_WIDTH; x += 3)
+        put_particle(&grid, x, x % GRID_HEIGHT, x % 2 ? SAND : WATER, SAND_BASE_COLOR);
+
+    for (int tick = 0; tick < 300; tick++) {
+        if (tick % 2)
+            grid_update(&grid);
+        else
+            grid_update_parallel(&grid, NULL);
+        assert(moved_bits_clear(&grid));
+    }
 }
 
 static void test_update_no_double_step(void) {
     /*
-     * Verify the gen counter prevents a particle from being processed
-     * twice in one frame. We manually stamp a sand particle with the
-     * upcoming generation and confirm grid_update does NOT move it.
+     * A particle whose moved bit is already set when its cell is visited is
+     * skipped, which is what keeps a falling grain from being moved again
+     * further down the scan.
      */
     static Grid grid;
-    grid_initialize(&grid);
+    setup_grid(&grid);
 
     /* Sand at (5, 0) — would normally fall to (5, 1) */
-    grid.particles[0][5] = (Particle){.type = SAND, .color = SAND_BASE_COLOR};
-
-    /* Pre-stamp it with the next gen (current_gen + 1, since update increments first) */
-    grid.particles[0][5].update_gen = (Uint8)(grid.current_gen + 1);
+    put_particle(&grid, 5, 0, SAND, SAND_BASE_COLOR);
+    grid_set_moved(&grid, grid_index(&grid, 5, 0), true);
     reset_fake_state();
 
     grid_update(&grid);
 
-    /* Sand should NOT have moved — gen guard skipped it */
-    assert(grid.particles[0][5].type == SAND);
-    assert(grid.particles[1][5].type == EMPTY);
+    /* Sand should NOT have moved — the moved bit skipped it */
+    assert(grid.types[grid_index(&grid, 5, 0)] == SAND);
+    assert(grid.types[grid_index(&grid, 5, 1)] == EMPTY);
 }
 
-static void test_swap_marks_destination_gen(void) {
+static void test_swap_leaves_moved_clear(void) {
     static Grid grid;
-    grid_initialize(&grid);
-    grid.current_gen = 5;
+    setup_grid(&grid);
 
-    grid.particles[0][0] = (Particle){.type = SAND, .color = SAND_BASE_COLOR, .update_gen = 0};
-    grid.particles[1][0] = (Particle){.type = EMPTY, .color = EMPTY_BASE_COLOR, .update_gen = 0};
+    put_particle(&grid, 0, 0, SAND, SAND_BASE_COLOR);
+    put_particle(&grid, 0, 1, EMPTY, EMPTY_BASE_COLOR);
 
+    /* Edits happen between ticks, so the next tick still moves it */
     grid_swap(&grid, (Coordinates){0, 0}, (Coordinates){0, 1});
+    assert(grid.types[grid_index(&grid, 0, 1)] == SAND);
+    assert(!grid_has_moved(&grid, grid_index(&grid, 0, 1)));
+    grid_update(&grid);
+    assert(grid.types[grid_index(&grid, 0, 2)] == SAND);
+}
+
+/* ────────────────────────────────────────────────────────────────────── */
+/*  Chunks: sleeping and dirty rects                                     */
+/* ────────────────────────────────────────────────────────────────────── */
+
+static void settle_grid(Grid *grid) {
+    /* Two quiet ticks: the first consumes the pending wake-ups, the second sleeps */
+    grid_update(grid);
+    grid_update(grid);
+}
+
+static void test_initialize_wakes_all_chunks(void) {
+    static Grid grid;
+    setup_grid(&grid);
+
+    for (int cy = 0; cy < grid.chunks_y; cy++) {
+        for (int cx = 0; cx < grid.chunks_x; cx++) {
+            assert(grid_chunk_at(&grid, cx, cy)->active);
+            assert(grid_chunk_at(&grid, cx, cy)->next_dirty.min_x == cx * GRID_CHUNK_SIZE);
+            assert(grid_chunk_at(&grid, cx, cy)->next_dirty.min_y == cy * GRID_CHUNK_SIZE);
+        }
+    }
+    assert(grid_chunk_at(&grid, grid.chunks_x - 1, grid.chunks_y - 1)->next_dirty.max_x == GRID_WIDTH - 1);
+    assert(grid_chunk_at(&grid, grid.chunks_x - 1, grid.chunks_y - 1)->next_dirty.max_y == GRID_HEIGHT - 1);
+}
+
+static void test_update_settled_grid_sleeps(void) {
+    static Grid grid;
+    setup_grid(&grid);
+    put_particle(&grid, 5, GRID_HEIGHT - 1, SAND, SAND_BASE_COLOR);
+    reset_fake_state();
+
+    settle_grid(&grid);
+
+    for (int cy = 0; cy < grid.chunks_y; cy++)
+        for (int cx = 0; cx < grid.chunks_x; cx++)
+            assert(!grid_chunk_at(&grid, cx, cy)->active);
+}
+
+static void test_sleeping_chunk_skips_particles(void) {
+    static Grid grid;
+    setup_grid(&grid);
+    settle_grid(&grid);
+
+    /* Written behind the grid's back: nothing wakes the chunk, so it stays put */
+    put_particle(&grid, 5, 0, SAND, SAND_BASE_COLOR);
+    grid_update(&grid);
+    assert(grid.types[grid_index(&grid, 5, 0)] == SAND);
+    assert(grid.types[grid_index(&grid, 5, 1)] == EMPTY);
+}
+
+static void test_set_particle_wakes_chunk(void) {
+    static Grid grid;
+    setup_grid(&grid);
+    settle_grid(&grid);
+    Particle p = {.type = SAND, .color = SAND_BASE_COLOR};
+
+    assert(grid_set_particle(&grid, (Coordinates){40, 40}, &p));
+    assert(grid_is_chunk_active(&grid, (Coordinates){40, 40}));
+    assert(!grid_is_chunk_active(&grid, (Coordinates){0, 0}));
+
+    GridRect next = grid_chunk_at(&grid, 1, 1)->next_dirty;
+    assert(next.min_x == 39 && next.max_x == 41);
+    assert(next.min_y == 39 && next.max_y == 41);
+
+    grid_update(&grid);
+    assert(grid.types[grid_index(&grid, 40, 40)] == EMPTY);
+    assert(grid.types[grid_index(&grid, 40, 41)] == SAND);
+}
+
+static void test_wake_region_crosses_chunk_border(void) {
+    static Grid grid;
+    setup_grid(&grid);
+    settle_grid(&grid);
+
+    grid_wake_region(&grid, (GridRect){GRID_CHUNK_SIZE - 1, 0, GRID_CHUNK_SIZE, 0});
+    assert(grid_chunk_at(&grid, 0, 0)->active);
+    assert(grid_chunk_at(&grid, 1, 0)->active);
+    assert(!grid_chunk_at(&grid, 2, 0)->active);
+    assert(grid_chunk_at(&grid, 0, 0)->next_dirty.max_x == GRID_CHUNK_SIZE - 1);
+    assert(grid_chunk_at(&grid, 1, 0)->next_dirty.min_x == GRID_CHUNK_SIZE);
+}
+
+static void test_wake_region_clips_to_grid(void) {
+    static Grid grid;
+    setup_grid(&grid);
+    settle_grid(&grid);
+
+    grid_wake_region(&grid, (GridRect){-5, -5, 0, 0});
+    assert(grid_chunk_at(&grid, 0, 0)->next_dirty.min_x == 0);
+    assert(grid_chunk_at(&grid, 0, 0)->next_dirty.min_y == 0);
+
+    grid_wake_region(&grid, (GridRect){GRID_WIDTH, 0, GRID_WIDTH + 3, 3});
+    assert(!grid_chunk_at(&grid, grid.chunks_x - 1, 0)->active);
+    grid_wake_region(NULL, (GridRect){0, 0, 1, 1});
+}
+
+static void test_sleeping_column_collapses_in_one_tick(void) {
+    static Grid grid;
+    setup_grid(&grid);
+    int x = GRID_CHUNK_SIZE - 1;
+    int top = GRID_HEIGHT - GRID_CHUNK_SIZE - 4; /* column spans two chunk rows */
+    for (int y = top; y < GRID_HEIGHT; y++) {
+        put_particle(&grid, x - 1, y, ROCK, ROCK_BASE_COLOR);
+        put_particle(&grid, x, y, SAND, SAND_BASE_COLOR);
+        put_particle(&grid, x + 1, y, ROCK, ROCK_BASE_COLOR);
+    }
+    settle_grid(&grid);
+    assert(!grid_is_chunk_active(&grid, (Coordinates){x, top}));
+
+    grid_set_particle(&grid, (Coordinates){x, GRID_HEIGHT - 1},
+                      &(Particle){.type = EMPTY, .color = EMPTY_BASE_COLOR});
+    grid_update(&grid);
+
+    /* Like a full sweep, every grain above the hole drops during the same tick */
+    assert(grid.types[grid_index(&grid, x, top)] == EMPTY);
+    for (int y = top + 1; y < GRID_HEIGHT; y++)
+        assert(grid.types[grid_index(&grid, x, y)] == SAND);
+}
+
+/* ────────────────────────────────────────────────────────────────────── */
+/*  grid_update_parallel                                                 */
+/* ────────────────────────────────────────────────────────────────────── */
+
+static void fill_sand_block(Grid *grid, int min_x, int min_y, int max_x, int max_y) {
+    for (int y = min_y; y <= max_y; y++)
+        for (int x = min_x; x <= max_x; x++)
+            put_particle(grid, x, y, SAND, SAND_BASE_COLOR);
+}
+
+static void test_update_parallel_null(void) {
+    grid_update_parallel(NULL, NULL);
+    /* Should not crash */
+}
+
+static void test_update_parallel_sand_falls(void) {
+    static Grid grid;
+    setup_grid(&grid);
+    put_particle(&grid, 5, 0, SAND, SAND_BASE_COLOR);
+
+    grid_update_parallel(&grid, NULL);
+    assert(grid.types[grid_index(&grid, 5, 0)] == EMPTY);
+    assert(grid.types[grid_index(&grid, 5, 1)] == SAND);
+    assert(grid.dirty);
+    assert(grid.tick_count == 1);
+}
+
+static void test_update_parallel_crosses_chunk_border(void) {
+    static Grid grid;
+    setup_grid(&grid);
+    int x = GRID_CHUNK_SIZE - 1;
+    int y = GRID_CHUNK_SIZE - 1;
+    settle_grid(&grid);
+    put_particle(&grid, x, y, SAND, SAND_BASE_COLOR);
+    grid_wake_region(&grid, (GridRect){x, y, x, y});
+
+    grid_update_parallel(&grid, NULL);
+    assert(grid.types[grid_index(&grid, x, y + 1)] == SAND);
+    assert(grid_is_chunk_active(&grid, (Coordinates){x, y + 1}));
+
+    /* Marked as moved, so the lower chunk's phase must not move it again */
+    assert(grid.types[grid_index(&grid, x, y + 2)] == EMPTY);
+}
+
+static void test_update_parallel_matches_inline(void) {
+    static Grid inline_grid;
+    static Grid threaded_grid;
+    WorkerPool pool;
+    assert(workers_initialize(&pool, 4));
+
+    setup_grid(&inline_grid);
+    fill_sand_block(&inline_grid, 10, 0, GRID_WIDTH - 10, 40);
+    grid_set_seed(&inline_grid, 1234);
+    copy_grid(&threaded_grid, &inline_grid);
+
+    for (int tick = 0; tick < 300; tick++) {
+        grid_update_parallel(&inline_grid, NULL);
+        grid_update_parallel(&threaded_grid, &pool);
+        assert(grid_planes_equal(&inline_grid, &threaded_grid));
+    }
+    workers_destroy(&pool);
+
+    /* The pile ends up resting on the floor */
+    assert(inline_grid.types[grid_index(&inline_grid, GRID_WIDTH / 2, GRID_HEIGHT - 1)] == SAND);
+    assert(inline_grid.types[grid_index(&inline_grid, GRID_WIDTH / 2, 0)] == EMPTY);
+}
+
+static void test_update_parallel_seed_drives_tie_breaks(void) {
+    static Grid a;
+    static Grid b;
+    setup_grid(&a);
+    fill_sand_block(&a, 10, 0, GRID_WIDTH - 10, 40);
+    copy_grid(&b, &a);
+    grid_set_seed(&a, 1);
+    grid_set_seed(&b, 2);
+
+    for (int tick = 0; tick < 100; tick++) {
+        grid_update_parallel(&a, NULL);
+        grid_update_parallel(&b, NULL);
+    }
+    assert(!grid_planes_equal(&a, &b));
+}
+
+static void test_update_parallel_deterministic_matches_serial(void) {
+    static Grid serial;
+    static Grid deterministic;
+    static Grid checkerboard;
+    WorkerPool pool;
+    assert(workers_initialize(&pool, 4));
+
+    setup_grid(&serial);
+    fill_sand_block(&serial, 10, 0, GRID_WIDTH / 2, 40);
+    grid_fill_rect(&serial, (GridRect){GRID_WIDTH / 2 + 1, 0, GRID_WIDTH - 10, 40}, WATER);
+    grid_set_seed(&serial, 1234);
+    copy_grid(&deterministic, &serial);
+    copy_grid(&checkerboard, &serial);
+    deterministic.deterministic = true;
+
+    for (int tick = 0; tick < 200; tick++) {
+        grid_update(&serial);
+        grid_update_parallel(&deterministic, &pool);
+        grid_update_parallel(&checkerboard, &pool);
+        assert(grid_planes_equal(&serial, &deterministic));
+    }
+    workers_destroy(&pool);
+
+    /* Without it the phases visit cells in their own order */
+    assert(!grid_planes_equal(&serial, &checkerboard));
+}
+
+static void test_update_serial_seed_reproducible(void) {
+    static Grid a;
+    static Grid b;
+    static Grid c;
+    setup_grid(&a);
+    /* A single column piles up into a peak, where grains keep hitting ties */
+    fill_sand_block(&a, GRID_WIDTH / 2, 0, GRID_WIDTH / 2, 60);
+    grid_set_seed(&a, 5);
+    copy_grid(&b, &a);
+    copy_grid(&c, &a);
+    grid_set_seed(&c, 6);
+
+    for (int tick = 0; tick < 300; tick++) {
+        grid_update(&a);
+        grid_update(&b);
+        grid_update(&c);
+    }
+    assert(grid_planes_equal(&a, &b));
+    assert(!grid_planes_equal(&a, &c));
+}
+
+/* ────────────────────────────────────────────────────────────────────── */
+/*  Row kernel                                                           */
+/* ────────────────────────────────────────────────────────────────────── */
+
+static void test_row_masks_match_cells(void) {
+    static Grid grid;
+    setup_grid(&grid);
+    int y = 10;
+    /* Unused ids and the border type have no flags, whatever their value */
+    static const ParticleType pattern[] = {SAND, EMPTY, ROCK, SAND, WATER, SAND, EMPTY, EMPTY, PARTICLE_TYPE_COUNT,
+                                           WATER, (ParticleType)GRID_BORDER_TYPE};
+    int length = (int)SDL_arraysize(pattern);
+    for (int x = 0; x < GRID_ROW_BLOCK + 2; x++) {
+        put_particle(&grid, x, y, pattern[x % length], SAND_BASE_COLOR);
+        put_particle(&grid, x, y + 1, pattern[(x * 3) % length], SAND_BASE_COLOR);
+    }
+
+    GridRowMasks masks = grid_row_masks(&grid, 1, y, GRID_ROW_BLOCK);
+    for (int i = 0; i < GRID_ROW_BLOCK; i++) {
+        int x = 1 + i;
+        int cell = grid_index(&grid, x, y);
+        const Uint8 *below = &grid.types[cell + grid.stride];
+        assert(((masks.moving >> i) & 1) == particle_type_has(grid.types[cell], MATERIAL_MOVES));
+        assert(((masks.powder >> i) & 1) == particle_type_has(grid.types[cell], MATERIAL_POWDER));
+        assert(((masks.below_empty >> i) & 1) == particle_type_has(below[0], MATERIAL_EMPTY));
+        bool open = false;
+        for (int dx = -1; dx <= 1; dx++)
+            open |= particle_type_has(below[dx], MATERIAL_EMPTY) || particle_type_has(below[dx], MATERIAL_LIQUID);
+        assert(((masks.open >> i) & 1) == open);
+    }
+}
+
+static void test_row_masks_left_edge_reads_border(void) {
+    static Grid grid;
+    setup_grid(&grid);
+    fill_grid_with(&grid, ROCK, ROCK_BASE_COLOR);
+    put_particle(&grid, 0, 5, SAND, SAND_BASE_COLOR);
+
+    /* The cell left of column 0 is padding, which never counts as empty */
+    GridRowMasks masks = grid_row_masks(&grid, 0, 5, GRID_ROW_BLOCK);
+    assert(masks.powder & 1);
+    assert(!(masks.below_empty & 1));
+    assert(!(masks.open & 1));
+}
+
+/* A short block sees cells past `count` as border, so it never reads a neighbor chunk's cells. */
+static void test_row_masks_stop_at_count(void) {
+    static Grid grid;
+    setup_grid(&grid);
+    fill_grid_with(&grid, SAND, SAND_BASE_COLOR);
+    for (int x = 0; x < GRID_ROW_BLOCK + 2; x++)
+        put_particle(&grid, x, 6, EMPTY, EMPTY_BASE_COLOR);
+
+    /* Sand carries on past the block, but the row reads as border there */
+    GridRowMasks masks = grid_row_masks(&grid, 1, 5, 7);
+    assert(masks.moving == 0x7F && masks.powder == 0x7F);
+    assert((masks.below_empty & 0x7F) == 0x7F && (masks.open & 0x7F) == 0x7F);
+
+    assert(grid_row_in_range(&grid.types[grid_index(&grid, 3, 5)], 5, SAND, SAND) == 0x1F);
+    assert(grid_row_in_range(&grid.types[grid_index(&grid, 3, 5)], GRID_ROW_BLOCK, SAND, SAND) == ~0u);
+}
+
+/* Unaligned blocks read across word edges, and only as many cells as asked for. */
+static void test_row_moved_reads_unaligned_blocks(void) {
+    static Grid grid;
+    setup_grid(&grid);
+    int y = 7;
+    static const int marked[] = {3, 15, 16, 31, 33, 47, 60};
+    for (int i = 0; i < (int)SDL_arraysize(marked); i++)
+        grid_set_moved(&grid, grid_index(&grid, marked[i], y), true);
+
+    for (int x = 0; x + GRID_ROW_BLOCK <= GRID_WIDTH; x += 5) {
+        for (int count = 1; count <= GRID_ROW_BLOCK; count += 6) {
+            Uint32 expected = 0;
+            for (int i = 0; i < (int)SDL_arraysize(marked); i++) {
+                if (marked[i] >= x && marked[i] < x + count)
+                    expected |= 1u << (marked[i] - x);
+            }
+            Uint32 in_block = count < GRID_ROW_BLOCK ? (1u << count) - 1 : ~0u;
+            assert((grid_row_moved(&grid, x, y, count) & in_block) == expected);
+        }
+    }
+    assert(grid_row_moved(&grid, 0, y + 1, GRID_ROW_BLOCK) == 0);
+}
+
+static void test_row_block_bulk_falls(void) {
+    static Grid grid;
+    setup_grid(&grid);
+    int y = 3;
+    for (int x = 0; x < GRID_ROW_BLOCK; x++)
+        put_particle(&grid, x, y, SAND, (SDL_Color){(Uint8)x, 0, 0, 255});
+
+    grid_update(&grid);
+    for (int x = 0; x < GRID_ROW_BLOCK; x++) {
+        int cell = grid_index(&grid, x, y + 1);
+        assert(grid.types[grid_index(&grid, x, y)] == EMPTY);
+        assert(grid.types[cell] == SAND);
+        assert(grid.colors[cell].r == x);
+        assert(!grid_has_moved(&grid, cell));
+    }
+    assert(grid_is_chunk_active(&grid, (Coordinates){GRID_ROW_BLOCK, y + 1}));
+}
+
+/* A grain that can only slide takes the spot under the next grain before it falls. */
+static void check_fall_behind_slide(bool left_to_right) {
+    Grid grid;
+    assert(grid_initialize(&grid, GRID_WIDTH, GRID_HEIGHT));
+    settle_grid(&grid);
+    int y = 20;
+    int step = left_to_right ? 1 : -1;
+    int slider = 40;
+    int faller = slider + step;
+
+    put_particle(&grid, slider - step, y + 1, ROCK, ROCK_BASE_COLOR);
+    put_particle(&grid, slider, y + 1, ROCK, ROCK_BASE_COLOR);
+    put_particle(&grid, slider, y, SAND, SAND_BASE_COLOR);
+    put_particle(&grid, faller, y, SAND, SAND_BASE_COLOR);
+    grid_wake_region(&grid, (GridRect){slider - 2, y - 1, slider + 2, y + 2});
+    grid.update_left_to_right = left_to_right;
+
+    grid_update(&grid);
+    assert(grid.types[grid_index(&grid, slider, y)] == EMPTY);
+    assert(grid.types[grid_index(&grid, faller, y)] == EMPTY);
+    assert(grid.types[grid_index(&grid, faller, y + 1)] == SAND);
+    assert(grid.types[grid_index(&grid, faller + step, y + 1)] == SAND);
+    grid_destroy(&grid);
+}
+
+static void test_row_block_fall_behind_slide_left_to_right(void) {
+    check_fall_behind_slide(true);
+}
+
+static void test_row_block_fall_behind_slide_right_to_left(void) {
+    check_fall_behind_slide(false);
+}
 
-    /* The moved particle at destination should be stamped with current_gen */
-    assert(grid.particles[1][0].update_gen == 5);
-    assert(grid.particles[1][0].type == SAND);
+/* ────────────────────────────────────────────────────────────────────── */
+/*  Liquids                                                              */
+/* ────────────────────────────────────────────────────────────────────── */
+
+static void fill_block(Grid *grid, int min_x, int min_y, int max_x, int max_y, ParticleType type) {
+    for (int y = min_y; y <= max_y; y++)
+        for (int x = min_x; x <= max_x; x++)
+            put_particle(grid, x, y, type, particle_get_default_color_by_type(type));
+}
+
+static void test_water_falls(void) {
+    static Grid grid;
+    setup_grid(&grid);
+    put_particle(&grid, 5, 0, WATER, WATER_BASE_COLOR);
+
+    grid_update(&grid);
+    assert(grid.types[grid_index(&grid, 5, 0)] == EMPTY);
+    assert(grid.types[grid_index(&grid, 5, 1)] == WATER);
+}
+
+static void test_water_flows_its_dispersion_in_one_tick(void) {
+    static Grid grid;
+    setup_grid(&grid);
+    int x = 100;
+    int y = GRID_HEIGHT - 1;
+    put_particle(&grid, x, y, WATER, WATER_BASE_COLOR);
+
+    grid_update(&grid);
+    bool left = grid.types[grid_index(&grid, x - WATER_DISPERSION, y)] == WATER;
+    bool right = grid.types[grid_index(&grid, x + WATER_DISPERSION, y)] == WATER;
+    assert(left != right);
+    assert(grid.types[grid_index(&grid, x, y)] == EMPTY);
+    assert(grid_is_chunk_active(&grid, (Coordinates){x + (left ? -WATER_DISPERSION : WATER_DISPERSION), y}));
+}
+
+static void test_water_stops_above_a_drop(void) {
+    static Grid grid;
+    setup_grid(&grid);
+    int x = 100;
+    int y = GRID_HEIGHT - 2;
+    fill_block(&grid, x - 1, y, x - 1, y + 1, ROCK);
+    fill_block(&grid, x, y + 1, x + 20, y + 1, ROCK);
+    put_particle(&grid, x + 3, y + 1, EMPTY, EMPTY_BASE_COLOR);
+    put_particle(&grid, x, y, WATER, WATER_BASE_COLOR);
+
+    grid_update(&grid);
+    assert(grid.types[grid_index(&grid, x + 3, y)] == WATER);
+    grid_update(&grid);
+    assert(grid.types[grid_index(&grid, x + 3, y + 1)] == WATER);
+}
+
+static void test_water_stops_at_walls(void) {
+    static Grid grid;
+    setup_grid(&grid);
+    int y = GRID_HEIGHT - 1;
+    put_particle(&grid, 1, y, WATER, WATER_BASE_COLOR);
+    put_particle(&grid, 3, y, ROCK, ROCK_BASE_COLOR);
+
+    grid_update(&grid);
+    bool left = grid.types[grid_index(&grid, 0, y)] == WATER;
+    bool right = grid.types[grid_index(&grid, 2, y)] == WATER;
+    assert(left != right);
+    assert(grid.types[grid_index(&grid, -1, y)] == GRID_BORDER_TYPE);
+}
+
+static void test_sand_sinks_through_water(void) {
+    static Grid grid;
+    setup_grid(&grid);
+    int x = 50;
+    int y = GRID_HEIGHT - 1;
+    fill_block(&grid, x - 1, y - 1, x - 1, y, ROCK);
+    fill_block(&grid, x + 1, y - 1, x + 1, y, ROCK);
+    put_particle(&grid, x, y, WATER, WATER_BASE_COLOR);
+    put_particle(&grid, x, y - 1, SAND, SAND_BASE_COLOR);
+
+    grid_update(&grid);
+    assert(grid.types[grid_index(&grid, x, y)] == SAND);
+    assert(grid.types[grid_index(&grid, x, y - 1)] == WATER);
+
+    /* Water is lighter, so it rests on sand */
+    grid_update(&grid);
+    assert(grid.types[grid_index(&grid, x, y)] == SAND);
+    assert(grid.types[grid_index(&grid, x, y - 1)] == WATER);
+}
+
+static void test_water_pool_levels_quickly(void) {
+    static Grid grid;
+    setup_grid(&grid);
+    int floor = GRID_HEIGHT - 1;
+    int left_wall = 60;
+    int width = 40;
+    int depth = 5;
+    fill_block(&grid, left_wall, floor - 60, left_wall, floor, ROCK);
+    fill_block(&grid, left_wall + width + 1, floor - 60, left_wall + width + 1, floor, ROCK);
+
+    /* A tall column poured against one wall holds exactly `depth` full rows */
+    int column_height = width * depth / 4;
+    fill_block(&grid, left_wall + 1, floor - column_height + 1, left_wall + 4, floor, WATER);
+
+    for (int tick = 0; tick < column_height + 40; tick++)
+        grid_update(&grid);
+
+    for (int x = left_wall + 1; x <= left_wall + width; x++) {
+        for (int y = floor - 10; y <= floor; y++)
+            assert((grid.types[grid_index(&grid, x, y)] == WATER) == (y > floor - depth));
+    }
+}
+
+static void test_update_parallel_matches_inline_with_water(void) {
+    static Grid inline_grid;
+    static Grid threaded_grid;
+    WorkerPool pool;
+    assert(workers_initialize(&pool, 4));
+
+    setup_grid(&inline_grid);
+    fill_block(&inline_grid, 10, 0, GRID_WIDTH - 10, 20, WATER);
+    fill_block(&inline_grid, 40, 21, GRID_WIDTH - 40, 40, SAND);
+    fill_block(&inline_grid, 30, GRID_HEIGHT - 30, 90, GRID_HEIGHT - 29, ROCK);
+    grid_set_seed(&inline_grid, 99);
+    copy_grid(&threaded_grid, &inline_grid);
+
+    for (int tick = 0; tick < 300; tick++) {
+        grid_update_parallel(&inline_grid, NULL);
+        grid_update_parallel(&threaded_grid, &pool);
+        assert(grid_planes_equal(&inline_grid, &threaded_grid));
+    }
+    workers_destroy(&pool);
+
+    /* Sand ends up under the water */
+    assert(inline_grid.types[grid_index(&inline_grid, GRID_WIDTH / 2, GRID_HEIGHT - 1)] == SAND);
+    assert(count_type(&inline_grid, WATER) == (GRID_WIDTH - 19) * 21);
+}
+
+/* ────────────────────────────────────────────────────────────────────── */
+/*  Margolus engine                                                      */
+/* ────────────────────────────────────────────────────────────────────── */
+
+static void test_margolus_null(void) {
+    grid_update_margolus(NULL, NULL);
+    /* Should not crash */
+}
+
+static void test_margolus_sand_falls_a_cell_per_tick(void) {
+    static Grid grid;
+    setup_grid(&grid);
+    put_particle(&grid, 5, 0, SAND, SAND_BASE_COLOR);
+
+    for (int y = 1; y <= 4; y++) {
+        grid_update_margolus(&grid, NULL);
+        assert(grid.types[grid_index(&grid, 5, y - 1)] == EMPTY);
+        assert(grid.types[grid_index(&grid, 5, y)] == SAND);
+        assert(grid.colors[grid_index(&grid, 5, y)].r == SAND_COLOR_BASE_R);
+    }
+    assert(grid.tick_count == 4);
+    assert(grid.dirty);
+}
+
+static void test_margolus_reaches_the_border(void) {
+    static Grid grid;
+    setup_grid(&grid);
+    put_particle(&grid, 0, GRID_HEIGHT - 3, SAND, SAND_BASE_COLOR);
+    put_particle(&grid, GRID_WIDTH - 1, GRID_HEIGHT - 2, WATER, WATER_BASE_COLOR);
+
+    for (int tick = 0; tick < 4; tick++)
+        grid_update_margolus(&grid, NULL);
+    assert(grid.types[grid_index(&grid, 0, GRID_HEIGHT - 1)] == SAND);
+    assert(count_type(&grid, WATER) == 1);
+    for (int y = -1; y <= GRID_HEIGHT; y++) {
+        assert(grid.types[grid_index(&grid, -1, y)] == GRID_BORDER_TYPE);
+        assert(grid.types[grid_index(&grid, GRID_WIDTH, y)] == GRID_BORDER_TYPE);
+    }
+}
+
+/* Sleeping chunks must not change the outcome: compare with every block stepped every tick. */
+static void test_margolus_matches_stepping_everything(void) {
+    static Grid sleeping;
+    static Grid everything;
+    setup_grid(&sleeping);
+    fill_block(&sleeping, 40, 0, 120, 30, SAND);
+    fill_block(&sleeping, 130, 0, 200, 20, WATER);
+    fill_block(&sleeping, 20, 100, 90, 100, ROCK);
+    copy_grid(&everything, &sleeping);
+    int sand = count_type(&sleeping, SAND);
+
+    for (int tick = 0; tick < 400; tick++) {
+        grid_wake_region(&everything, (GridRect){0, 0, GRID_WIDTH - 1, GRID_HEIGHT - 1});
+        grid_update_margolus(&sleeping, NULL);
+        grid_update_margolus(&everything, NULL);
+        assert(grid_planes_equal(&sleeping, &everything));
+    }
+    assert(count_type(&sleeping, SAND) == sand);
+    assert(sleeping.types[grid_index(&sleeping, 80, GRID_HEIGHT - 1)] == SAND);
+}
+
+static void test_margolus_parallel_matches_inline(void) {
+    static Grid inline_grid;
+    static Grid threaded_grid;
+    WorkerPool pool;
+    assert(workers_initialize(&pool, 4));
+
+    setup_grid(&inline_grid);
+    fill_block(&inline_grid, 10, 0, GRID_WIDTH - 10, 20, WATER);
+    fill_block(&inline_grid, 40, 21, GRID_WIDTH - 40, 40, SAND);
+    copy_grid(&threaded_grid, &inline_grid);
+
+    for (int tick = 0; tick < 300; tick++) {
+        grid_update_margolus(&inline_grid, NULL);
+        grid_update_margolus(&threaded_grid, &pool);
+        assert(grid_planes_equal(&inline_grid, &threaded_grid));
+    }
+    workers_destroy(&pool);
+    assert(inline_grid.types[grid_index(&inline_grid, GRID_WIDTH / 2, GRID_HEIGHT - 1)] == SAND);
+}
+
+static void test_margolus_settled_pile_sleeps(void) {
+    static Grid grid;
+    setup_grid(&grid);
+    fill_block(&grid, 100, 0, 120, 40, SAND);
+
+    for (int tick = 0; tick < 600; tick++)
+        grid_update_margolus(&grid, NULL);
+    grid.dirty = false;
+    grid_update_margolus(&grid, NULL);
+    grid_update_margolus(&grid, NULL);
+    assert(!grid.dirty);
+    for (int i = 0; i < grid.chunks_x * grid.chunks_y; i++)
+        assert(!grid.chunks[i].active);
+}
+
+/* ────────────────────────────────────────────────────────────────────── */
+/*  Buffered engine                                                      */
+/* ────────────────────────────────────────────────────────────────────── */
+
+static bool buffered_planes_clear(Grid *grid) {
+    for (int y = 0; y < grid->height; y++)
+        for (int x = 0; x < grid->width; x++)
+            if (grid->intents[grid_index(grid, x, y)] || grid->claims[grid_index(grid, x, y)])
+                return false;
+    return true;
+}
+
+static void test_buffered_null(void) {
+    grid_update_buffered(NULL, NULL);
+    /* Should not crash */
+}
+
+static void test_buffered_sand_falls_a_cell_per_tick(void) {
+    static Grid grid;
+    setup_grid(&grid);
+    put_particle(&grid, 5, 0, SAND, SAND_BASE_COLOR);
+
+    for (int y = 1; y <= 4; y++) {
+        grid_update_buffered(&grid, NULL);
+        assert(grid.types[grid_index(&grid, 5, y - 1)] == EMPTY);
+        assert(grid.types[grid_index(&grid, 5, y)] == SAND);
+        assert(grid.colors[grid_index(&grid, 5, y)].r == SAND_COLOR_BASE_R);
+    }
+    assert(grid.tick_count == 4);
+    assert(grid.dirty);
+    assert(buffered_planes_clear(&grid));
+}
+
+/* The upper grain sees the lower one where the tick found it, so it waits a tick. */
+static void test_buffered_column_opens_up(void) {
+    static Grid grid;
+    setup_grid(&grid);
+    put_particle(&grid, 5, 0, SAND, SAND_BASE_COLOR);
+    put_particle(&grid, 5, 1, SAND, SAND_BASE_COLOR);
+    put_particle(&grid, 4, 1, ROCK, ROCK_BASE_COLOR);
+    put_particle(&grid, 6, 1, ROCK, ROCK_BASE_COLOR);
+
+    grid_update_buffered(&grid, NULL);
+    assert(grid.types[grid_index(&grid, 5, 0)] == SAND);
+    assert(grid.types[grid_index(&grid, 5, 1)] == EMPTY);
+    assert(grid.types[grid_index(&grid, 5, 2)] == SAND);
+}
+
+/* A fall and a diagonal slide claim the same cell: the fall wins, the loser stays awake. */
+static void test_buffered_fall_outranks_slide(void) {
+    static Grid grid;
+    setup_grid(&grid);
+    SDL_Color falling = {1, 2, 3, 255};
+    SDL_Color sliding = {4, 5, 6, 255};
+    put_particle(&grid, 10, 10, SAND, falling);
+    put_particle(&grid, 9, 10, SAND, sliding);
+    put_particle(&grid, 9, 11, ROCK, ROCK_BASE_COLOR);
+    put_particle(&grid, 8, 11, ROCK, ROCK_BASE_COLOR);
+
+    grid_update_buffered(&grid, NULL);
+    assert(grid.colors[grid_index(&grid, 10, 11)].r == falling.r);
+    assert(grid.colors[grid_index(&grid, 9, 10)].r == sliding.r);
+    assert(grid.types[grid_index(&grid, 10, 10)] == EMPTY);
+    assert(grid_is_chunk_active(&grid, (Coordinates){9, 10}));
+    assert(buffered_planes_clear(&grid));
+
+    /* It retries while the winner is leaving the cell, and slides once the cell is free */
+    grid_update_buffered(&grid, NULL);
+    grid_update_buffered(&grid, NULL);
+    assert(grid.types[grid_index(&grid, 9, 10)] == EMPTY);
+    assert(count_type(&grid, SAND) == 2);
+}
+
+/* Sleeping chunks must not change the outcome: compare with every cell stepped every tick. */
+static void test_buffered_matches_stepping_everything(void) {
+    static Grid sleeping;
+    static Grid everything;
+    setup_grid(&sleeping);
+    fill_block(&sleeping, 40, 0, 120, 30, SAND);
+    fill_block(&sleeping, 130, 0, 200, 20, WATER);
+    fill_block(&sleeping, 20, 100, 90, 100, ROCK);
+    copy_grid(&everything, &sleeping);
+    int sand = count_type(&sleeping, SAND);
+    int water = count_type(&sleeping, WATER);
+
+    for (int tick = 0; tick < 400; tick++) {
+        grid_wake_region(&everything, (GridRect){0, 0, GRID_WIDTH - 1, GRID_HEIGHT - 1});
+        grid_update_buffered(&sleeping, NULL);
+        grid_update_buffered(&everything, NULL);
+        assert(grid_planes_equal(&sleeping, &everything));
+    }
+    assert(count_type(&sleeping, SAND) == sand);
+    assert(count_type(&sleeping, WATER) == water);
+    assert(sleeping.types[grid_index(&sleeping, 80, GRID_HEIGHT - 1)] == SAND);
+    assert(buffered_planes_clear(&sleeping));
+}
+
+/* Neither thread count nor scan direction may change a single cell. */
+static void test_buffered_is_order_independent(void) {
+    static Grid inline_grid;
+    static Grid threaded_grid;
+    static Grid mirrored_grid;
+    WorkerPool pool;
+    assert(workers_initialize(&pool, 4));
+
+    setup_grid(&inline_grid);
+    fill_block(&inline_grid, 10, 0, GRID_WIDTH - 10, 20, WATER);
+    fill_block(&inline_grid, 40, 21, GRID_WIDTH - 40, 40, SAND);
+    copy_grid(&threaded_grid, &inline_grid);
+    copy_grid(&mirrored_grid, &inline_grid);
+    mirrored_grid.update_left_to_right = !inline_grid.update_left_to_right;
+
+    for (int tick = 0; tick < 300; tick++) {
+        grid_update_buffered(&inline_grid, NULL);
+        grid_update_buffered(&threaded_grid, &pool);
+        grid_update_buffered(&mirrored_grid, &pool);
+        assert(grid_planes_equal(&inline_grid, &threaded_grid));
+        assert(grid_planes_equal(&inline_grid, &mirrored_grid));
+    }
+    workers_destroy(&pool);
+
+    /* Sand ends up under the water */
+    assert(inline_grid.types[grid_index(&inline_grid, GRID_WIDTH / 2, GRID_HEIGHT - 1)] == SAND);
+    assert(count_type(&inline_grid, WATER) == (GRID_WIDTH - 19) * 21);
+}
+
+static void test_buffered_settled_pile_sleeps(void) {
+    static Grid grid;
+    setup_grid(&grid);
+    fill_block(&grid, 100, 0, 120, 40, SAND);
+
+    for (int tick = 0; tick < 600; tick++)
+        grid_update_buffered(&grid, NULL);
+    grid.dirty = false;
+    grid_update_buffered(&grid, NULL);
+    grid_update_buffered(&grid, NULL);
+    assert(!grid.dirty);
+    for (int i = 0; i < grid.chunks_x * grid.chunks_y; i++)
+        assert(!grid.chunks[i].active);
+}
+
+/* ────────────────────────────────────────────────────────────────────── */
+/*  Bitboards                                                            */
+/* ────────────────────────────────────────────────────────────────────── */
+
+/* Every bit, padding rows and columns included, agrees with the type plane. */
+static bool bitboards_match(Grid *grid) {
+    for (int y = -1; y <= grid->height; y++) {
+        const Uint64 *occupied = grid_bitboard_row(grid, grid->occupied, y);
+        const Uint64 *solid = grid_bitboard_row(grid, grid->solid, y);
+        for (int x = 0; x < grid->stride; x++) {
+            Uint8 type = grid->types[grid_index(grid, x, y)];
+            bool is_occupied = (occupied[x / 64] >> (x % 64)) & 1;
+            bool is_solid = (solid[x / 64] >> (x % 64)) & 1;
+            if (is_occupied != (type != EMPTY) || is_solid != (type == ROCK || type == GRID_BORDER_TYPE))
+                return false;
+        }
+    }
+    return true;
+}
+
+static void test_bitboards_after_reset(void) {
+    static Grid grid;
+    setup_grid(&grid);
+    fill_block(&grid, 0, 0, 50, 50, ROCK);
+    grid_reset(&grid);
+    assert(bitboards_match(&grid));
+
+    GridCellCounts counts = grid_count_cells(&grid, (GridRect){0, 0, GRID_WIDTH - 1, GRID_HEIGHT - 1});
+    assert(counts.occupied == 0 && counts.solid == 0);
+    assert(grid_bitboard_row(&grid, grid.occupied, -1)[0] == ~(Uint64)0);
+    assert(grid_bitboard_row(&grid, grid.solid, GRID_HEIGHT)[0] == ~(Uint64)0);
+}
+
+static void test_bitboards_follow_edits(void) {
+    static Grid grid;
+    setup_grid(&grid);
+    grid_place_particle(&grid, (Coordinates){63, 10}, ROCK);
+    grid_place_particle(&grid, (Coordinates){64, 10}, SAND);
+    assert(bitboards_match(&grid));
+
+    grid_swap(&grid, (Coordinates){64, 10}, (Coordinates){200, 100});
+    assert(bitboards_match(&grid));
+
+    grid_apply_brush(&grid, (Coordinates){GRID_WIDTH - 1, 60}, MAX_BRUSH_RADIUS, ROCK);
+    grid_apply_stroke(&grid, (Coordinates){10, 140}, (Coordinates){150, 20}, 4, WATER);
+    assert(bitboards_match(&grid));
+    grid_apply_stroke(&grid, (Coordinates){10, 140}, (Coordinates){150, 20}, 2, EMPTY);
+    assert(bitboards_match(&grid));
+}
+
+/* Cells written behind the grid's back are synced once, the rest is up to the engines. */
+static void test_bitboards_follow_updates(void) {
+    static Grid serial;
+    static Grid parallel;
+    static Grid margolus;
+    static Grid buffered;
+    WorkerPool pool;
+    assert(workers_initialize(&pool, 4));
+
+    setup_grid(&serial);
+    fill_block(&serial, 10, 0, GRID_WIDTH - 10, 20, WATER);
+    fill_block(&serial, 40, 21, GRID_WIDTH - 40, 40, SAND);
+    fill_block(&serial, 60, 90, 140, 92, ROCK);
+    grid_sync_bitboards(&serial, (GridRect){0, 0, GRID_WIDTH - 1, GRID_HEIGHT - 1});
+    copy_grid(&parallel, &serial);
+    copy_grid(&margolus, &serial);
+    copy_grid(&buffered, &serial);
+
+    for (int tick = 0; tick < 200; tick++) {
+        grid_update(&serial);
+        grid_update_parallel(&parallel, &pool);
+        grid_update_margolus(&margolus, &pool);
+        grid_update_buffered(&buffered, &pool);
+        assert(bitboards_match(&serial));
+        assert(bitboards_match(&parallel));
+        assert(bitboards_match(&margolus));
+        assert(bitboards_match(&buffered));
+    }
+    workers_destroy(&pool);
+}
+
+static void test_count_cells(void) {
+    static Grid grid;
+    setup_grid(&grid);
+    fill_block(&grid, 60, 10, 139, 19, ROCK);
+    fill_block(&grid, 60, 20, 139, 24, SAND);
+    grid_sync_bitboards(&grid, (GridRect){60, 10, 139, 24});
+
+    GridCellCounts all = grid_count_cells(&grid, (GridRect){0, 0, GRID_WIDTH - 1, GRID_HEIGHT - 1});
+    assert(all.occupied == 80 * 15 && all.solid == 80 * 10);
+
+    /* Partial words on both ends */
+    GridCellCounts part = grid_count_cells(&grid, (GridRect){63, 18, 65, 21});
+    assert(part.occupied == 3 * 4 && part.solid == 3 * 2);
+
+    GridCellCounts clipped = grid_count_cells(&grid, (GridRect){-50, -50, 60, 10});
+    assert(clipped.occupied == 1 && clipped.solid == 1);
+
+    GridCellCounts none = grid_count_cells(NULL, (GridRect){0, 0, 10, 10});
+    assert(none.occupied == 0 && none.solid == 0);
+    none = grid_count_cells(&grid, GRID_RECT_EMPTY);
+    assert(none.occupied == 0 && none.solid == 0);
+}
+
+static void test_falling_bits(void) {
+    static Grid grid;
+    setup_grid(&grid);
+    grid_place_particle(&grid, (Coordinates){70, 10}, SAND);
+    grid_place_particle(&grid, (Coordinates){71, 10}, ROCK);
+    grid_place_particle(&grid, (Coordinates){72, 10}, WATER);
+    grid_place_particle(&grid, (Coordinates){72, 11}, SAND);
+    grid_place_particle(&grid, (Coordinates){5, GRID_HEIGHT - 1}, SAND);
+
+    assert(grid_falling_bits(&grid, 1, 10) == (Uint64)1 << 6);
+    assert(grid_falling_bits(&grid, 1, 11) == (Uint64)1 << 8);
+    /* The padding row below the grid counts as occupied */
+    assert(grid_falling_bits(&grid, 0, GRID_HEIGHT - 1) == 0);
+    /* Padding columns count as solid, so they never fall */
+    assert(grid_falling_bits(&grid, grid.bit_stride - 1, 0) == 0);
+}
+
+/* ────────────────────────────────────────────────────────────────────── */
+/*  Material counts                                                      */
+/* ────────────────────────────────────────────────────────────────────── */
+
+static int brute_count(Grid *grid, GridRect region, ParticleType type) {
+    int count = 0;
+    for (int y = SDL_max(region.min_y, 0); y <= SDL_min(region.max_y, GRID_HEIGHT - 1); y++)
+        for (int x = SDL_max(region.min_x, 0); x <= SDL_min(region.max_x, GRID_WIDTH - 1); x++)
+            count += grid->types[grid_index(grid, x, y)] == type;
+    return count;
+}
+
+/* Every chunk's counts and the grid's totals agree with the type plane. */
+static bool counts_match(Grid *grid) {
+    for (int type = 0; type < PARTICLE_TYPE_COUNT; type++) {
+        if (grid_get_material_count(grid, (ParticleType)type) != count_type(grid, (ParticleType)type))
+            return false;
+        for (int cy = 0; cy < grid->chunks_y; cy++) {
+            for (int cx = 0; cx < grid->chunks_x; cx++) {
+                GridRect bounds = grid_chunk_bounds(grid, cx, cy);
+                if (grid_chunk_at(grid, cx, cy)->counts[type] != brute_count(grid, bounds, (ParticleType)type))
+                    return false;
+            }
+        }
+    }
+    return true;
+}
+
+static void test_counts_after_reset(void) {
+    static Grid grid;
+    setup_grid(&grid);
+    assert(grid_get_material_count(&grid, EMPTY) == GRID_WIDTH * GRID_HEIGHT);
+    assert(grid_get_material_count(&grid, SAND) == 0);
+
+    grid_apply_brush(&grid, (Coordinates){50, 50}, 5, ROCK);
+    grid_reset(&grid);
+    assert(counts_match(&grid));
+    assert(grid_get_material_count(&grid, ROCK) == 0);
+}
+
+static void test_counts_follow_edits(void) {
+    static Grid grid;
+    setup_grid(&grid);
+    grid_place_particle(&grid, (Coordinates){31, 31}, SAND);
+    grid_set_particle(&grid, (Coordinates){32, 31}, &(Particle){.type = WATER, .color = WATER_BASE_COLOR});
+    grid_place_particle(&grid, (Coordinates){31, 31}, ROCK);
+    assert(counts_match(&grid));
+    assert(grid_get_material_count(&grid, ROCK) == 1 && grid_get_material_count(&grid, SAND) == 0);
+
+    /* Swapping across a chunk border moves a cell between two chunks' counts */
+    grid_swap(&grid, (Coordinates){32, 31}, (Coordinates){100, 100});
+    assert(counts_match(&grid));
+
+    grid_apply_brush(&grid, (Coordinates){GRID_WIDTH - 1, 60}, MAX_BRUSH_RADIUS, SAND);
+    grid_apply_stroke(&grid, (Coordinates){10, 140}, (Coordinates){150, 20}, 4, WATER);
+    assert(counts_match(&grid));
+    grid_apply_stroke(&grid, (Coordinates){10, 140}, (Coordinates){150, 20}, 2, EMPTY);
+    assert(counts_match(&grid));
+
+    /* Ids without a material would have nowhere to be counted */
+    assert(!grid_set_particle(&grid, (Coordinates){5, 5}, &(Particle){.type = PARTICLE_TYPE_COUNT}));
+    assert(grid_get_material_count(&grid, PARTICLE_TYPE_COUNT) == 0);
+    assert(grid_get_material_count(NULL, SAND) == 0);
+}
+
+/* Ticks may move cells across chunk borders from several threads; counts catch up at the end. */
+static void test_counts_follow_updates(void) {
+    static Grid serial;
+    static Grid parallel;
+    static Grid margolus;
+    static Grid buffered;
+    WorkerPool pool;
+    assert(workers_initialize(&pool, 4));
+
+    setup_grid(&serial);
+    fill_block(&serial, 10, 0, GRID_WIDTH - 10, 20, WATER);
+    fill_block(&serial, 40, 21, GRID_WIDTH - 40, 40, SAND);
+    fill_block(&serial, 60, 90, 140, 92, ROCK);
+    grid_sync_counts(&serial, (GridRect){0, 0, GRID_WIDTH - 1, GRID_HEIGHT - 1});
+    assert(counts_match(&serial));
+    copy_grid(&parallel, &serial);
+    copy_grid(&margolus, &serial);
+    copy_grid(&buffered, &serial);
+
+    for (int tick = 0; tick < 200; tick++) {
+        grid_update(&serial);
+        grid_update_parallel(&parallel, &pool);
+        grid_update_margolus(&margolus, &pool);
+        grid_update_buffered(&buffered, &pool);
+        if (tick % 10 == 0) {
+            assert(counts_match(&serial));
+            assert(counts_match(&parallel));
+            assert(counts_match(&margolus));
+            assert(counts_match(&buffered));
+        }
+    }
+    workers_destroy(&pool);
+}
+
+static void test_count_materials_in_regions(void) {
+    static Grid grid;
+    setup_grid(&grid);
+    fill_block(&grid, 20, 10, 150, 70, SAND);
+    fill_block(&grid, 60, 40, 90, 110, WATER);
+    fill_block(&grid, 0, 100, GRID_WIDTH - 1, 101, ROCK);
+    grid_sync_counts(&grid, (GridRect){0, 0, GRID_WIDTH - 1, GRID_HEIGHT - 1});
+
+    GridRect regions[] = {
+        {0, 0, GRID_WIDTH - 1, GRID_HEIGHT - 1}, /* whole chunks only */
+        {32, 32, 95, 63},                        /* chunk aligned */
+        {17, 5, 140, 99},                        /* partial edges all round */
+        {33, 33, 33, 33},                        /* one cell */
+        {-40, -40, 40, 40},                      /* clipped */
+        {GRID_WIDTH - 5, 90, GRID_WIDTH + 50, GRID_HEIGHT + 50},
+    };
+    for (size_t i = 0; i < SDL_arraysize(regions); i++) {
+        GridMaterialCounts counts = grid_count_materials(&grid, regions[i]);
+        for (int type = 0; type < PARTICLE_TYPE_COUNT; type++)
+            assert(counts.counts[type] == brute_count(&grid, regions[i], (ParticleType)type));
+    }
+
+    GridMaterialCounts outside = grid_count_materials(&grid, (GridRect){-10, -10, -1, -1});
+    GridMaterialCounts none = grid_count_materials(NULL, regions[0]);
+    for (int type = 0; type < PARTICLE_TYPE_COUNT; type++)
+        assert(outside.counts[type] == 0 && none.counts[type] == 0);
+}
+
+/* ────────────────────────────────────────────────────────────────────── */
+/*  Brush and strokes                                                    */
+/* ────────────────────────────────────────────────────────────────────── */
+
+/* Every in-bounds cell within `radius` of `center`, and nothing else, holds `type`. */
+static bool grid_holds_disc(Grid *grid, Coordinates center, int radius, ParticleType type) {
+    for (int y = 0; y < GRID_HEIGHT; y++) {
+        for (int x = 0; x < GRID_WIDTH; x++) {
+            int dx = x - center.x, dy = y - center.y;
+            bool inside = dx * dx + dy * dy <= radius * radius;
+            if ((grid->types[grid_index(grid, x, y)] == type) != inside)
+                return false;
+        }
+    }
+    return true;
+}
+
+static void test_brush_stamps_disc_at_every_radius(void) {
+    static Grid grid;
+    setup_grid(&grid);
+    reset_fake_state();
+    for (int radius = MIN_BRUSH_RADIUS; radius <= MAX_BRUSH_RADIUS; radius++) {
+        grid_reset(&grid);
+        grid_apply_brush(&grid, (Coordinates){128, 72}, radius, SAND);
+        assert(grid_holds_disc(&grid, (Coordinates){128, 72}, radius, SAND));
+        SDL_Color color = grid.colors[grid_index(&grid, 128 + radius, 72)];
+        assert(SDL_abs(color.r - SAND_COLOR_BASE_R) <= SAND_COLOR_VARIATION);
+    }
+}
+
+static void test_brush_clips_at_edges(void) {
+    static Grid grid;
+    setup_grid(&grid);
+    grid_apply_brush(&grid, (Coordinates){0, 0}, 5, ROCK);
+    assert(grid_holds_disc(&grid, (Coordinates){0, 0}, 5, ROCK));
+
+    grid_reset(&grid);
+    grid_apply_brush(&grid, (Coordinates){GRID_WIDTH - 1, GRID_HEIGHT - 1}, MAX_BRUSH_RADIUS, ROCK);
+    assert(grid_holds_disc(&grid, (Coordinates){GRID_WIDTH - 1, GRID_HEIGHT - 1}, MAX_BRUSH_RADIUS, ROCK));
+    assert(grid.types[grid_index(&grid, GRID_WIDTH, GRID_HEIGHT - 1)] == GRID_BORDER_TYPE);
+}
+
+static void test_brush_clamps_radius(void) {
+    static Grid grid;
+    setup_grid(&grid);
+    grid_apply_brush(&grid, (Coordinates){128, 72}, MAX_BRUSH_RADIUS + 30, SAND);
+    assert(grid_holds_disc(&grid, (Coordinates){128, 72}, MAX_BRUSH_RADIUS, SAND));
+
+    grid_reset(&grid);
+    grid_apply_brush(&grid, (Coordinates){128, 72}, -1, SAND);
+    grid_apply_brush(&grid, (Coordinates){-1, 72}, 3, SAND);
+    grid_apply_brush(NULL, (Coordinates){128, 72}, 3, SAND);
+    assert(count_type(&grid, SAND) == 0);
+}
+
+static void test_brush_respects_priority(void) {
+    static Grid grid;
+    setup_grid(&grid);
+    put_particle(&grid, 10, 10, ROCK, ROCK_BASE_COLOR);
+    put_particle(&grid, 11, 10, SAND, SAND_BASE_COLOR);
+
+    grid_apply_brush(&grid, (Coordinates){10, 10}, 0, SAND);
+    assert(grid_get_particle_type(&grid, (Coordinates){10, 10}) == ROCK);
+    grid_apply_brush(&grid, (Coordinates){11, 10}, 0, ROCK);
+    assert(grid_get_particle_type(&grid, (Coordinates){11, 10}) == ROCK);
+    grid_apply_brush(&grid, (Coordinates){10, 10}, 1, EMPTY);
+    assert(count_type(&grid, ROCK) == 0);
+}
+
+static void test_brush_wakes_and_paints(void) {
+    static Grid grid;
+    setup_grid(&grid);
+    for (int i = 0; i < 3; i++)
+        grid_update(&grid);
+    grid.dirty = false;
+    assert(!grid_is_chunk_active(&grid, (Coordinates){100, 100}));
+
+    grid_apply_brush(&grid, (Coordinates){100, 100}, 2, SAND);
+    assert(grid.dirty);
+    assert(grid_is_chunk_active(&grid, (Coordinates){100, 100}));
+    GridRect paint = grid.paint[(100 / GRID_CHUNK_SIZE) * grid.chunks_x + 100 / GRID_CHUNK_SIZE];
+    assert(paint.min_x <= 98 && paint.max_x >= 102 && paint.min_y <= 98 && paint.max_y >= 102);
+}
+
+/* Stamps a brush at every step of the line, the slow way a stroke has to match. */
+static void stamp_along_line(Grid *grid, Coordinates from, Coordinates to, int radius, ParticleType type) {
+    int dx = SDL_abs(to.x - from.x), dy = -SDL_abs(to.y - from.y);
+    int error = dx + dy;
+    Coordinates point = from;
+    for (;;) {
+        grid_apply_brush(grid, point, radius, type);
+        if (point.x == to.x && point.y == to.y)
+            break;
+        int doubled = 2 * error;
+        if (doubled >= dy) {
+            error += dy;
+            point.x += from.x < to.x ? 1 : -1;
+        }
+        if (doubled <= dx) {
+            error += dx;
+            point.y += from.y < to.y ? 1 : -1;
+        }
+    }
+}
+
+static void test_stroke_matches_stamps_along_line(void) {
+    static Grid stroked, stamped;
+    setup_grid(&stroked);
+    setup_grid(&stamped);
+
+    static const Coordinates ends[][2] = {
+        {{10, 10}, {200, 10}},  {{200, 130}, {15, 120}}, {{40, 5}, {60, 140}},
+        {{250, 0}, {0, 143}},   {{128, 72}, {129, 73}},  {{3, 70}, {3, 20}},
+    };
+    static const int radii[] = {0, 1, 3, 7, MAX_BRUSH_RADIUS};
+    for (size_t i = 0; i < SDL_arraysize(ends); i++) {
+        for (size_t r = 0; r < SDL_arraysize(radii); r++) {
+            grid_reset(&stroked);
+            grid_reset(&stamped);
+            grid_apply_stroke(&stroked, ends[i][0], ends[i][1], radii[r], SAND);
+            stamp_along_line(&stamped, ends[i][0], ends[i][1], radii[r], SAND);
+            for (int y = 0; y < GRID_HEIGHT; y++)
+                assert(memcmp(&stroked.types[grid_index(&stroked, 0, y)], &stamped.types[grid_index(&stamped, 0, y)],
+                              GRID_WIDTH) == 0);
+        }
+    }
+}
+
+static void test_stroke_leaves_no_gaps(void) {
+    static Grid grid;
+    setup_grid(&grid);
+    grid_apply_stroke(&grid, (Coordinates){10, 50}, (Coordinates){200, 50}, 0, SAND);
+    assert(count_type(&grid, SAND) == 191);
+    for (int x = 10; x <= 200; x++)
+        assert(grid_get_particle_type(&grid, (Coordinates){x, 50}) == SAND);
+}
+
+static void test_stroke_needs_both_ends_in_bounds(void) {
+    static Grid grid;
+    setup_grid(&grid);
+    grid_apply_stroke(&grid, (Coordinates){10, 50}, (Coordinates){GRID_WIDTH, 50}, 2, SAND);
+    grid_apply_stroke(&grid, (Coordinates){10, -1}, (Coordinates){10, 50}, 2, SAND);
+    assert(count_type(&grid, SAND) == 0);
+}
+
+/* ────────────────────────────────────────────────────────────────────── */
+/*  Region edits                                                         */
+/* ────────────────────────────────────────────────────────────────────── */
+
+/* Every in-bounds cell inside `rect` holds `type`, and no other one does. */
+static bool grid_holds_rect(Grid *grid, GridRect rect, ParticleType type) {
+    for (int y = 0; y < GRID_HEIGHT; y++) {
+        for (int x = 0; x < GRID_WIDTH; x++) {
+            bool inside = x >= rect.min_x && x <= rect.max_x && y >= rect.min_y && y <= rect.max_y;
+            if ((grid->types[grid_index(grid, x, y)] == type) != inside)
+                return false;
+        }
+    }
+    return true;
+}
+
+static void test_fill_rect(void) {
+    static Grid grid;
+    setup_grid(&grid);
+    settle_grid(&grid);
+
+    grid_fill_rect(&grid, (GridRect){30, 40, 99, 45}, ROCK);
+    assert(grid_holds_rect(&grid, (GridRect){30, 40, 99, 45}, ROCK));
+    SDL_Color color = grid.colors[grid_index(&grid, 99, 45)];
+    assert(SDL_abs(color.r - ROCK_COLOR_BASE_R) <= ROCK_COLOR_VARIATION);
+    assert(bitboards_match(&grid));
+    assert(counts_match(&grid));
+    assert(grid_is_chunk_active(&grid, (Coordinates){100, 46}));
+    assert(grid.dirty);
+
+    /* Overwrites whatever is there, brush priority or not */
+    grid_fill_rect(&grid, (GridRect){30, 40, 99, 45}, EMPTY);
+    assert(count_type(&grid, ROCK) == 0);
+    assert(grid.colors[grid_index(&grid, 99, 45)].r == EMPTY_BASE_COLOR.r);
+}
+
+static void test_fill_rect_clips(void) {
+    static Grid grid;
+    setup_grid(&grid);
+    grid_fill_rect(&grid, (GridRect){GRID_WIDTH - 3, -10, GRID_WIDTH + 10, 2}, SAND);
+    assert(grid_holds_rect(&grid, (GridRect){GRID_WIDTH - 3, 0, GRID_WIDTH - 1, 2}, SAND));
+    assert(grid.types[grid_index(&grid, GRID_WIDTH, 0)] == GRID_BORDER_TYPE);
+
+    grid_fill_rect(&grid, (GridRect){-10, -10, -1, -1}, SAND);
+    grid_fill_rect(&grid, (GridRect){50, 50, 40, 60}, SAND);
+    grid_fill_rect(&grid, (GridRect){0, 0, 10, 10}, PARTICLE_TYPE_COUNT);
+    grid_fill_rect(NULL, (GridRect){0, 0, 10, 10}, SAND);
+    assert(count_type(&grid, SAND) == 9);
+    assert(counts_match(&grid));
+}
+
+static void test_copy_region_between_grids(void) {
+    static Grid source;
+    static Grid destination;
+    setup_grid(&source);
+    setup_grid(&destination);
+    for (int y = 0; y < 20; y++)
+        for (int x = 0; x < 30; x++)
+            put_particle(&source, 10 + x, 10 + y, (ParticleType)((x + y) % PARTICLE_TYPE_COUNT),
+                         (SDL_Color){(Uint8)x, (Uint8)y, 0, 255});
+
+    grid_copy_region(&destination, (Coordinates){100, 50}, &source, (GridRect){10, 10, 39, 29});
+    for (int y = 0; y < 20; y++) {
+        for (int x = 0; x < 30; x++) {
+            int index = grid_index(&destination, 100 + x, 50 + y);
+            assert(destination.types[index] == (x + y) % PARTICLE_TYPE_COUNT);
+            assert(destination.colors[index].r == x && destination.colors[index].g == y);
+        }
+    }
+    assert(count_type(&destination, EMPTY) == count_type(&source, EMPTY));
+    assert(bitboards_match(&destination));
+    assert(counts_match(&destination));
+    assert(grid_is_chunk_active(&destination, (Coordinates){129, 69}));
+
+    /* Hanging off the bottom right corner keeps only what fits */
+    grid_reset(&destination);
+    grid_copy_region(&destination, (Coordinates){GRID_WIDTH - 5, GRID_HEIGHT - 2}, &source,
+                     (GridRect){10, 10, 39, 29});
+    int index = grid_index(&destination, GRID_WIDTH - 1, GRID_HEIGHT - 1);
+    assert(destination.colors[index].r == 4 && destination.colors[index].g == 1);
+    assert(destination.types[grid_index(&destination, GRID_WIDTH, GRID_HEIGHT - 1)] == GRID_BORDER_TYPE);
+    assert(counts_match(&destination));
+}
+
+/* A region starting off the source drops the cells it doesn't have, without shifting the rest. */
+static void test_copy_region_starting_off_grid(void) {
+    static Grid source;
+    static Grid destination;
+    setup_grid(&source);
+    setup_grid(&destination);
+    for (int y = 0; y < 20; y++)
+        for (int x = 0; x < 20; x++)
+            put_particle(&source, x, y, SAND, (SDL_Color){(Uint8)x, (Uint8)y, 0, 255});
+
+    grid_copy_region(&destination, (Coordinates){30, 40}, &source, (GridRect){-5, -8, 14, 11});
+    for (int y = 0; y < 20; y++) {
+        for (int x = 0; x < 20; x++) {
+            int index = grid_index(&destination, 30 + x, 40 + y);
+            if (x < 5 || y < 8) {
+                assert(destination.types[index] == EMPTY);
+                continue;
+            }
+            assert(destination.types[index] == SAND);
+            assert(destination.colors[index].r == x - 5 && destination.colors[index].g == y - 8);
+        }
+    }
+    assert(count_type(&destination, SAND) == 15 * 12);
+    assert(counts_match(&destination));
+}
+
+/* Copies within one grid read every row before overwriting it, whichever way they move. */
+static void test_copy_region_overlapping(void) {
+    static Grid grid;
+    static Grid original;
+    setup_grid(&grid);
+    for (int y = 0; y < 40; y++)
+        for (int x = 0; x < 40; x++)
+            put_particle(&grid, 50 + x, 50 + y, (ParticleType)((x * 7 + y * 3) % PARTICLE_TYPE_COUNT),
+                         (SDL_Color){(Uint8)x, (Uint8)y, 1, 255});
+    copy_grid(&original, &grid);
+
+    int shifts[][2] = {{3, 5}, {-4, -6}, {7, 0}, {-2, 9}};
+    for (size_t i = 0; i < SDL_arraysize(shifts); i++) {
+        memcpy(grid.arena, original.arena, grid.arena_size);
+        int dx = shifts[i][0];
+        int dy = shifts[i][1];
+        grid_copy_region(&grid, (Coordinates){50 + dx, 50 + dy}, &grid, (GridRect){50, 50, 89, 89});
+        for (int y = 50; y < 90; y++) {
+            for (int x = 50; x < 90; x++) {
+                int from = grid_index(&original, x, y);
+                int to = grid_index(&grid, x + dx, y + dy);
+                assert(grid.types[to] == original.types[from]);
+                assert(grid.colors[to].r == original.colors[from].r && grid.colors[to].g == original.colors[from].g);
+            }
+        }
+    }
+}
+
+/* A closed box split by a pillar hanging from its lid: the fill has to turn back up under the lid. */
+static void test_flood_fill_stays_inside_walls(void) {
+    static Grid grid;
+    setup_grid(&grid);
+    fill_block(&grid, 20, 20, 21, 80, ROCK);
+    fill_block(&grid, 60, 20, 61, 80, ROCK);
+    fill_block(&grid, 20, 81, 61, 82, ROCK);
+    fill_block(&grid, 38, 10, 43, 70, ROCK);
+    fill_block(&grid, 22, 20, 37, 20, ROCK);
+    fill_block(&grid, 44, 20, 59, 20, ROCK);
+    grid_sync_bitboards(&grid, (GridRect){0, 0, GRID_WIDTH - 1, GRID_HEIGHT - 1});
+    grid_sync_counts(&grid, (GridRect){0, 0, GRID_WIDTH - 1, GRID_HEIGHT - 1});
+
+    assert(grid_flood_fill(&grid, (Coordinates){25, 25}, WATER));
+    /* Everything between the walls and under the lid but the pillar, and nothing else */
+    assert(count_type(&grid, WATER) == 38 * 60 - 6 * 50);
+    assert(grid.types[grid_index(&grid, 55, 78)] == WATER);
+    assert(grid.types[grid_index(&grid, 40, 75)] == WATER);
+    assert(grid.types[grid_index(&grid, 10, 10)] == EMPTY);
+    assert(bitboards_match(&grid));
+    assert(counts_match(&grid));
+    assert(grid_is_chunk_active(&grid, (Coordinates){40, 80}));
+}
+
+static void test_flood_fill_whole_grid(void) {
+    static Grid grid;
+    setup_grid(&grid);
+    assert(grid_flood_fill(&grid, (Coordinates){GRID_WIDTH - 1, GRID_HEIGHT - 1}, SAND));
+    assert(count_type(&grid, SAND) == GRID_WIDTH * GRID_HEIGHT);
+    assert(grid_get_material_count(&grid, SAND) == GRID_WIDTH * GRID_HEIGHT);
+    for (int y = -1; y <= GRID_HEIGHT; y++)
+        assert(grid.types[grid_index(&grid, GRID_WIDTH, y)] == GRID_BORDER_TYPE);
+}
+
+static void test_flood_fill_bad_arguments(void) {
+    static Grid grid;
+    setup_grid(&grid);
+    assert(!grid_flood_fill(NULL, (Coordinates){0, 0}, SAND));
+    assert(!grid_flood_fill(&grid, (Coordinates){-1, 0}, SAND));
+    assert(!grid_flood_fill(&grid, (Coordinates){0, 0}, PARTICLE_TYPE_COUNT));
+
+    /* Filling with the type that is already there has nothing to do */
+    settle_grid(&grid);
+    grid.dirty = false;
+    assert(grid_flood_fill(&grid, (Coordinates){0, 0}, EMPTY));
+    assert(!grid.dirty);
 }
 
 static void test_place_then_get(void) {
     static Grid grid;
-    grid_initialize(&grid);
+    setup_grid(&grid);
     Coordinates pos = {42, 77};
     reset_fake_state();
     fake_state.random_color_return = (SDL_Color){1, 2, 3, 4};
 
     assert(grid_place_particle(&grid, pos, ROCK));
-    const Particle *p = grid_get_particle(&grid, pos);
-    assert(p != NULL);
-    assert(p->type == ROCK);
-    assert(p->color.r == 1);
-    assert(p->color.g == 2);
-    assert(p->color.b == 3);
-    assert(p->color.a == 4);
+    Particle p;
+    assert(grid_get_particle(&grid, pos, &p));
+    assert(p.type == ROCK);
+    assert(p.color.r == 1);
+    assert(p.color.g == 2);
+    assert(p.color.b == 3);
+    assert(p.color.a == 4);
 }
 
 static void test_clearnup_after_fill(void) {
     static Grid grid;
+    setup_grid(&grid);
     fill_grid_with(&grid, ROCK, ROCK_BASE_COLOR);
     for (int y = 0; y < GRID_HEIGHT; y++)
         for (int x = 0; x < GRID_WIDTH; x++)
-            assert(grid.particles[y][x].type != EMPTY);
+            assert(grid.types[grid_index(&grid, x, y)] != EMPTY);
 
     grid_reset(&grid);
     for (int y = 0; y < GRID_HEIGHT; y++)
         for (int x = 0; x < GRID_WIDTH; x++)
-            assert(grid.particles[y][x].type == EMPTY);
+            assert(grid.types[grid_index(&grid, x, y)] == EMPTY);
 }
 
 /* ── Runner ──────────────────────────────────────────────────────────── */
@@ -732,7 +2316,13 @@ static void test_clearnup_after_fill(void) {
 int main(void) {
     /* Initialize / Clear / Cleanup */
     test_initialize_null();
+    test_initialize_bad_size();
+    test_initialize_too_large();
     test_initialize_success();
+    test_initialize_aligns_rows();
+    test_initialize_pads_with_border();
+    test_initialize_runtime_sizes();
+    test_destroy_null();
     test_cleanup_null();
     test_cleanup_success();
     test_cleanup_null_cleanup();
@@ -746,6 +2336,7 @@ int main(void) {
     test_out_of_bounds_overflow_x();
     test_out_of_bounds_overflow_y();
     test_out_of_bounds_both();
+    test_in_bounds_null_grid();
 
     /* Grid empty */
     test_is_empty_null();
@@ -777,8 +2368,10 @@ int main(void) {
     /* Get particle */
     test_get_particle_null_grid();
     test_get_particle_out_of_bounds();
+    test_get_particle_null_output();
     test_get_particle_success();
-    test_get_particle_returns_address();
+    test_get_particle_type();
+    test_set_then_get_round_trip();
 
     /* Update */
     test_update_null();
@@ -794,16 +2387,107 @@ int main(void) {
     test_render_single_particle();
     test_render_multiple_particles();
     test_render_full_grid();
-    test_render_not_dirty_skips_lock();
+    test_render_not_dirty_skips_update();
+    test_render_clears_paint();
+    test_render_uploads_changed_cells_only();
+    test_render_separate_regions_update_separately();
+    test_render_update_failure_keeps_paint();
 
     /* Generation counter */
-    test_update_increments_gen();
+    test_update_clears_moved_bits();
     test_update_no_double_step();
-    test_swap_marks_destination_gen();
+    test_swap_leaves_moved_clear();
+
+    /* Chunks */
+    test_initialize_wakes_all_chunks();
+    test_update_settled_grid_sleeps();
+    test_sleeping_chunk_skips_particles();
+    test_set_particle_wakes_chunk();
+    test_wake_region_crosses_chunk_border();
+    test_wake_region_clips_to_grid();
+    test_sleeping_column_collapses_in_one_tick();
+
+    /* Parallel update */
+    test_update_parallel_null();
+    test_update_parallel_sand_falls();
+    test_update_parallel_crosses_chunk_border();
+    test_update_parallel_matches_inline();
+    test_update_parallel_seed_drives_tie_breaks();
+    test_update_parallel_deterministic_matches_serial();
+    test_update_serial_seed_reproducible();
+
+    /* Row kernel */
+    test_row_masks_match_cells();
+    test_row_masks_left_edge_reads_border();
+    test_row_masks_stop_at_count();
+    test_row_moved_reads_unaligned_blocks();
+    test_row_block_bulk_falls();
+    test_row_block_fall_behind_slide_left_to_right();
+    test_row_block_fall_behind_slide_right_to_left();
+
+    /* Liquids */
+    test_water_falls();
+    test_water_flows_its_dispersion_in_one_tick();
+    test_water_stops_above_a_drop();
+    test_water_stops_at_walls();
+    test_sand_sinks_through_water();
+    test_water_pool_levels_quickly();
+    test_update_parallel_matches_inline_with_water();
+
+    /* Margolus engine */
+    test_margolus_null();
+    test_margolus_sand_falls_a_cell_per_tick();
+    test_margolus_reaches_the_border();
+    test_margolus_matches_stepping_everything();
+    test_margolus_parallel_matches_inline();
+    test_margolus_settled_pile_sleeps();
+
+    /* Buffered engine */
+    test_buffered_null();
+    test_buffered_sand_falls_a_cell_per_tick();
+    test_buffered_column_opens_up();
+    test_buffered_fall_outranks_slide();
+    test_buffered_matches_stepping_everything();
+    test_buffered_is_order_independent();
+    test_buffered_settled_pile_sleeps();
+
+    /* Bitboards */
+    test_bitboards_after_reset();
+    test_bitboards_follow_edits();
+    test_bitboards_follow_updates();
+    test_count_cells();
+    test_falling_bits();
+
+    /* Material counts */
+    test_counts_after_reset();
+    test_counts_follow_edits();
+    test_counts_follow_updates();
+    test_count_materials_in_regions();
+
+    /* Brush and strokes */
+    test_brush_stamps_disc_at_every_radius();
+    test_brush_clips_at_edges();
+    test_brush_clamps_radius();
+    test_brush_respects_priority();
+    test_brush_wakes_and_paints();
+    test_stroke_matches_stamps_along_line();
+    test_stroke_leaves_no_gaps();
+    test_stroke_needs_both_ends_in_bounds();
+
+    /* Region edits */
+    test_fill_rect();
+    test_fill_rect_clips();
+    test_copy_region_between_grids();
+    test_copy_region_starting_off_grid();
+    test_copy_region_overlapping();
+    test_flood_fill_stays_inside_walls();
+    test_flood_fill_whole_grid();
+    test_flood_fill_bad_arguments();
 
     /* Integration */
     test_place_then_get();
     test_clearnup_after_fill();
 
+    destroy_test_grids();
     return 0;
 }
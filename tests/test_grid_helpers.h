@@ -0,0 +1,66 @@
+#ifndef FALLING_SAND_TEST_GRID_HELPERS_H
+#define FALLING_SAND_TEST_GRID_HELPERS_H
+
+/*
+ * Grid fixtures shared by the suites that run whole worlds. Include it after
+ * the module under test, which brings in the grid.
+ */
+
+#include <assert.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "grid/grid.h"
+
+#define TEST_WIDTH 100 /* not a multiple of GRID_CHUNK_SIZE, so edge chunks are partial */
+#define TEST_HEIGHT 70
+#define TEST_WHOLE_GRID ((GridRect){0, 0, TEST_WIDTH - 1, TEST_HEIGHT - 1})
+#define TEST_SEED 77
+
+static inline void make_grid(Grid *grid) {
+    assert(grid_initialize(grid, TEST_WIDTH, TEST_HEIGHT));
+    grid_set_seed(grid, TEST_SEED);
+}
+
+/* A grid in exactly the state `source` is in, down to its RNG and tick, like test_grid.c's copy_grid. */
+static inline void copy_grid(Grid *copy, const Grid *source) {
+    assert(grid_initialize(copy, source->width, source->height));
+    assert(copy->arena_size == source->arena_size);
+    memcpy(copy->arena, source->arena, source->arena_size);
+    copy->update_left_to_right = source->update_left_to_right;
+    copy->dirty = source->dirty;
+    copy->seed = source->seed;
+    copy->tick_count = source->tick_count;
+    copy->random = source->random;
+    memcpy(copy->counts, source->counts, sizeof(source->counts));
+}
+
+static inline bool grid_types_equal(const Grid *a, const Grid *b) {
+    for (int y = 0; y < a->height; y++) {
+        if (memcmp(&a->types[grid_index(a, 0, y)], &b->types[grid_index(b, 0, y)], (size_t)a->width) != 0)
+            return false;
+    }
+    return true;
+}
+
+/* Same cells, and the bitboards and counts derived from them match too. */
+static inline bool grids_equal(const Grid *a, const Grid *b) {
+    if (!grid_types_equal(a, b))
+        return false;
+    for (int y = 0; y < a->height; y++) {
+        int row = grid_index(a, 0, y);
+        if (memcmp(&a->colors[row], &b->colors[row], (size_t)a->width * sizeof(SDL_Color)) != 0)
+            return false;
+    }
+
+    size_t bitboard_size = (size_t)a->height * (size_t)a->bit_stride * sizeof(Uint64);
+    if (memcmp(a->occupied, b->occupied, bitboard_size) != 0 || memcmp(a->solid, b->solid, bitboard_size) != 0)
+        return false;
+    for (int i = 0; i < a->chunks_x * a->chunks_y; i++) {
+        if (memcmp(a->chunks[i].counts, b->chunks[i].counts, sizeof(a->chunks[i].counts)) != 0)
+            return false;
+    }
+    return memcmp(a->counts, b->counts, sizeof(a->counts)) == 0;
+}
+
+#endif
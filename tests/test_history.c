@@ -0,0 +1,375 @@
+#include <assert.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "history/history.h"
+#include "history/history.c"
+#include "test_grid_helpers.h"
+
+/* ── Helpers ─────────────────────────────────────────────────────────── */
+
+/* ────────────────────────────────────────────────────────────────────── */
+/*  undo / redo                                                          */
+/* ────────────────────────────────────────────────────────────────────── */
+
+static void test_undo_restores_brush(void) {
+    Grid grid, before, after;
+    History history;
+    make_grid(&grid);
+    assert(history_initialize(&history, &grid, HISTORY_MEMORY_BUDGET, HISTORY_MAX_ENTRIES));
+    grid_apply_brush(&grid, (Coordinates){40, 40}, 6, ROCK);
+    copy_grid(&before, &grid);
+
+    history_apply_brush(&history, &grid, (Coordinates){36, 36}, 5, SAND);
+    copy_grid(&after, &grid);
+    assert(!grids_equal(&grid, &before));
+
+    assert(history_undo(&history, &grid));
+    assert(grids_equal(&grid, &before));
+    assert(!history_undo(&history, &grid));
+
+    assert(history_redo(&history, &grid));
+    assert(grids_equal(&grid, &after));
+    assert(!history_redo(&history, &grid));
+
+    history_destroy(&history);
+    grid_destroy(&grid);
+    grid_destroy(&before);
+    grid_destroy(&after);
+}
+
+static void test_record_saves_only_touched_chunks(void) {
+    Grid grid;
+    History history;
+    make_grid(&grid);
+    assert(history_initialize(&history, &grid, HISTORY_MEMORY_BUDGET, HISTORY_MAX_ENTRIES));
+
+    history_apply_brush(&history, &grid, (Coordinates){10, 10}, 3, SAND);
+    assert(history.count == 1 && history.entries[0].count == 1);
+    assert(history.entries[0].chunks[0]->index == 0);
+
+    /* Straddles the corner of four chunks */
+    history_apply_brush(&history, &grid, (Coordinates){GRID_CHUNK_SIZE, GRID_CHUNK_SIZE}, 2, SAND);
+    assert(history.count == 2 && history.entries[1].count == 4);
+    assert(history.bytes == 5 * sizeof(HistoryChunk));
+
+    history_destroy(&history);
+    grid_destroy(&grid);
+}
+
+/* A long diagonal drag saves the chunks it wrote, not every chunk in its bounding box. */
+static void test_stroke_saves_only_written_chunks(void) {
+    Grid grid, before;
+    History history;
+    make_grid(&grid);
+    copy_grid(&before, &grid);
+    assert(history_initialize(&history, &grid, HISTORY_MEMORY_BUDGET, HISTORY_MAX_ENTRIES));
+
+    history_apply_brush(&history, &grid, (Coordinates){2, 2}, 1, SAND);
+    history_apply_stroke(&history, &grid, (Coordinates){2, 2}, (Coordinates){TEST_WIDTH - 3, TEST_HEIGHT - 3}, 1,
+                         SAND);
+    int written = 0;
+    for (int i = 0; i < grid.chunks_x * grid.chunks_y; i++)
+        written += grid.chunks[i].counts[SAND] > 0;
+    assert(history.count == 1 && history.entries[0].count == written);
+    assert(written < grid.chunks_x * grid.chunks_y);
+
+    assert(history_undo(&history, &grid));
+    assert(grids_equal(&grid, &before));
+
+    history_destroy(&history);
+    grid_destroy(&grid);
+    grid_destroy(&before);
+}
+
+/* Everything recorded before the next history_begin is one entry, and a chunk is saved the first time only. */
+static void test_drag_is_one_entry(void) {
+    Grid grid, before;
+    History history;
+    make_grid(&grid);
+    copy_grid(&before, &grid);
+    assert(history_initialize(&history, &grid, HISTORY_MEMORY_BUDGET, HISTORY_MAX_ENTRIES));
+
+    history_apply_brush(&history, &grid, (Coordinates){5, 5}, 2, WATER);
+    for (int x = 6; x < 20; x++)
+        history_apply_stroke(&history, &grid, (Coordinates){x - 1, 5}, (Coordinates){x, 5}, 2, WATER);
+    assert(history.count == 1 && history.entries[0].count == 1);
+    assert(grid.edit_hook == NULL);
+
+    assert(history_undo(&history, &grid));
+    assert(grids_equal(&grid, &before));
+
+    history_destroy(&history);
+    grid_destroy(&grid);
+    grid_destroy(&before);
+}
+
+static void test_undo_wakes_restored_chunks(void) {
+    Grid grid;
+    History history;
+    make_grid(&grid);
+    assert(history_initialize(&history, &grid, HISTORY_MEMORY_BUDGET, HISTORY_MAX_ENTRIES));
+
+    grid_fill_rect(&grid, (GridRect){40, 40, 60, 40}, ROCK);
+    grid_place_particle(&grid, (Coordinates){50, 39}, SAND);
+    history_apply_brush(&history, &grid, (Coordinates){50, 40}, 0, EMPTY);
+    assert(history_undo(&history, &grid));
+    for (int tick = 0; tick < 60; tick++)
+        grid_update(&grid);
+    assert(!grid_is_chunk_active(&grid, (Coordinates){50, 39}));
+    assert(grid_get_particle_type(&grid, (Coordinates){50, 39}) == SAND);
+
+    /* Opening the hole under it again has to wake the grain */
+    assert(history_redo(&history, &grid));
+    assert(grid_get_particle_type(&grid, (Coordinates){50, 40}) == EMPTY);
+    grid_update(&grid);
+    assert(grid_get_particle_type(&grid, (Coordinates){50, 39}) == EMPTY);
+
+    history_destroy(&history);
+    grid_destroy(&grid);
+}
+
+static void test_new_edit_drops_redo(void) {
+    Grid grid;
+    History history;
+    make_grid(&grid);
+    assert(history_initialize(&history, &grid, HISTORY_MEMORY_BUDGET, HISTORY_MAX_ENTRIES));
+
+    history_apply_brush(&history, &grid, (Coordinates){10, 10}, 1, ROCK);
+    history_apply_brush(&history, &grid, (Coordinates){80, 60}, 1, ROCK);
+    assert(history_undo(&history, &grid));
+    assert(history_undo(&history, &grid));
+    assert(history.position == 0 && history.count == 2);
+
+    history_apply_brush(&history, &grid, (Coordinates){50, 50}, 1, SAND);
+    assert(history.position == 1 && history.count == 1);
+    assert(!history_redo(&history, &grid));
+    assert(grid_get_particle_type(&grid, (Coordinates){10, 10}) == EMPTY);
+
+    history_destroy(&history);
+    grid_destroy(&grid);
+}
+
+/* ────────────────────────────────────────────────────────────────────── */
+/*  region edits                                                         */
+/* ────────────────────────────────────────────────────────────────────── */
+
+static void test_undo_fill_rect(void) {
+    Grid grid, before, after;
+    History history;
+    make_grid(&grid);
+    assert(history_initialize(&history, &grid, HISTORY_MEMORY_BUDGET, HISTORY_MAX_ENTRIES));
+    grid_apply_brush(&grid, (Coordinates){20, 20}, 8, SAND);
+    copy_grid(&before, &grid);
+
+    history_fill_rect(&history, &grid, (GridRect){10, 5, 60, 40}, ROCK);
+    copy_grid(&after, &grid);
+    assert(history.count == 1 && history.entries[0].count == 4);
+    assert(grid.edit_hook == NULL);
+
+    assert(history_undo(&history, &grid));
+    assert(grids_equal(&grid, &before));
+    assert(history_redo(&history, &grid));
+    assert(grids_equal(&grid, &after));
+
+    history_destroy(&history);
+    grid_destroy(&grid);
+    grid_destroy(&before);
+    grid_destroy(&after);
+}
+
+static void test_undo_copy_region(void) {
+    Grid grid, source, before, after;
+    History history;
+    make_grid(&grid);
+    make_grid(&source);
+    assert(history_initialize(&history, &grid, HISTORY_MEMORY_BUDGET, HISTORY_MAX_ENTRIES));
+    grid_fill_rect(&source, (GridRect){0, 0, 20, 20}, WATER);
+    grid_apply_brush(&grid, (Coordinates){60, 40}, 6, ROCK);
+    copy_grid(&before, &grid);
+
+    history_copy_region(&history, &grid, (Coordinates){50, 30}, &source, (GridRect){0, 0, 20, 20});
+    /* Within one grid, overlapping itself, as a second entry */
+    history_copy_region(&history, &grid, (Coordinates){55, 35}, &grid, (GridRect){50, 30, 80, 60});
+    copy_grid(&after, &grid);
+    assert(history.count == 2);
+
+    assert(history_undo(&history, &grid));
+    assert(history_undo(&history, &grid));
+    assert(grids_equal(&grid, &before));
+    assert(history_redo(&history, &grid));
+    assert(history_redo(&history, &grid));
+    assert(grids_equal(&grid, &after));
+
+    history_destroy(&history);
+    grid_destroy(&grid);
+    grid_destroy(&source);
+    grid_destroy(&before);
+    grid_destroy(&after);
+}
+
+/* A fill is only known once it has run, so chunks are saved as it reaches them. */
+static void test_undo_flood_fill(void) {
+    Grid grid, before, after;
+    History history;
+    make_grid(&grid);
+    assert(history_initialize(&history, &grid, HISTORY_MEMORY_BUDGET, HISTORY_MAX_ENTRIES));
+    grid_fill_rect(&grid, (GridRect){2, 2, 20, 20}, ROCK);
+    grid_fill_rect(&grid, (GridRect){3, 3, 19, 19}, EMPTY);
+    copy_grid(&before, &grid);
+
+    assert(history_flood_fill(&history, &grid, (Coordinates){10, 10}, WATER));
+    assert(history.count == 1 && history.entries[0].count == 1);
+    assert(history_flood_fill(&history, &grid, (Coordinates){50, 50}, SAND));
+    assert(history.count == 2 && history.entries[1].count == grid.chunks_x * grid.chunks_y);
+    assert(grid.edit_hook == NULL);
+    copy_grid(&after, &grid);
+
+    assert(history_undo(&history, &grid));
+    assert(grid_get_particle_type(&grid, (Coordinates){50, 50}) == EMPTY);
+    assert(grid_get_particle_type(&grid, (Coordinates){10, 10}) == WATER);
+    assert(history_undo(&history, &grid));
+    assert(grids_equal(&grid, &before));
+    assert(history_redo(&history, &grid));
+    assert(history_redo(&history, &grid));
+    assert(grids_equal(&grid, &after));
+
+    history_destroy(&history);
+    grid_destroy(&grid);
+    grid_destroy(&before);
+    grid_destroy(&after);
+}
+
+/* ────────────────────────────────────────────────────────────────────── */
+/*  sharing and limits                                                   */
+/* ────────────────────────────────────────────────────────────────────── */
+
+static void test_unchanged_chunks_are_shared(void) {
+    Grid grid;
+    History history;
+    make_grid(&grid);
+    assert(history_initialize(&history, &grid, HISTORY_MEMORY_BUDGET, HISTORY_MAX_ENTRIES));
+
+    /* Filling empty cells with empty writes them without a change, so the next edit finds the chunk as saved */
+    history_fill_rect(&history, &grid, (GridRect){5, 5, 15, 15}, EMPTY);
+    history_apply_brush(&history, &grid, (Coordinates){12, 12}, 3, SAND);
+    HistoryChunk *saved = history.entries[0].chunks[0];
+    assert(history.entries[1].chunks[0] == saved && saved->refs == 2);
+    assert(history.bytes == sizeof(HistoryChunk));
+
+    /* A chunk the sand changed needs a version of its own */
+    history_apply_brush(&history, &grid, (Coordinates){14, 14}, 3, SAND);
+    assert(history.entries[2].chunks[0] != saved);
+    assert(history.bytes == 2 * sizeof(HistoryChunk));
+
+    history_destroy(&history);
+    grid_destroy(&grid);
+}
+
+static void test_budget_drops_oldest(void) {
+    Grid grid;
+    History history;
+    make_grid(&grid);
+    assert(history_initialize(&history, &grid, 2 * sizeof(HistoryChunk), HISTORY_MAX_ENTRIES));
+
+    history_apply_brush(&history, &grid, (Coordinates){10, 10}, 1, SAND);
+    history_apply_brush(&history, &grid, (Coordinates){40, 10}, 1, SAND);
+    history_apply_brush(&history, &grid, (Coordinates){70, 10}, 1, SAND);
+    assert(history.count == 2 && history.bytes <= history.budget);
+    assert(history.entries[0].chunks[0]->index == 1);
+
+    assert(history_undo(&history, &grid));
+    assert(history.bytes <= history.budget);
+    assert(grid_get_particle_type(&grid, (Coordinates){70, 10}) == EMPTY);
+    assert(grid_get_particle_type(&grid, (Coordinates){40, 10}) == SAND);
+
+    history_destroy(&history);
+    grid_destroy(&grid);
+}
+
+static void test_entry_over_budget_is_dropped(void) {
+    Grid grid;
+    History history;
+    make_grid(&grid);
+    assert(history_initialize(&history, &grid, 2 * sizeof(HistoryChunk), HISTORY_MAX_ENTRIES));
+
+    history_begin(&history);
+    assert(history_record(&history, &grid, TEST_WHOLE_GRID));
+    assert(history.count == 0 && history.bytes == 0);
+
+    /* The rest of that edit isn't recorded, the next one is */
+    assert(history_record(&history, &grid, (GridRect){0, 0, 3, 3}));
+    assert(history.count == 0);
+    history_apply_brush(&history, &grid, (Coordinates){10, 10}, 1, SAND);
+    assert(history.count == 1);
+
+    history_destroy(&history);
+    grid_destroy(&grid);
+}
+
+static void test_max_entries(void) {
+    Grid grid;
+    History history;
+    make_grid(&grid);
+    assert(history_initialize(&history, &grid, HISTORY_MEMORY_BUDGET, 2));
+
+    for (int i = 0; i < 3; i++)
+        history_apply_brush(&history, &grid, (Coordinates){10 + GRID_CHUNK_SIZE * i, 10}, 1, SAND);
+    assert(history.count == 2 && history.position == 2);
+    assert(history.entries[0].chunks[0]->index == 1);
+
+    history_destroy(&history);
+    grid_destroy(&grid);
+}
+
+static void test_bad_arguments(void) {
+    Grid grid, other;
+    History history;
+    make_grid(&grid);
+    assert(grid_initialize(&other, 2 * TEST_WIDTH, TEST_HEIGHT));
+    assert(!history_initialize(&history, &grid, HISTORY_MEMORY_BUDGET, 0));
+    assert(!history_initialize(NULL, &grid, HISTORY_MEMORY_BUDGET, 1));
+    assert(history_initialize(&history, &grid, HISTORY_MEMORY_BUDGET, HISTORY_MAX_ENTRIES));
+
+    assert(!history_undo(&history, &grid));
+    assert(!history_redo(&history, &grid));
+    assert(!history_record(&history, &other, TEST_WHOLE_GRID));
+    assert(!history_record(NULL, &grid, TEST_WHOLE_GRID));
+    assert(history_record(&history, &grid, (GridRect){-10, -10, -1, -1}));
+    assert(history.count == 0);
+
+    history_apply_brush(&history, &grid, (Coordinates){10, 10}, 1, SAND);
+    assert(!history_undo(&history, &other));
+    history_begin(NULL);
+    history_destroy(NULL);
+
+    history_destroy(&history);
+    grid_destroy(&grid);
+    grid_destroy(&other);
+}
+
+/* ── Runner ──────────────────────────────────────────────────────────── */
+
+int main(void) {
+    /* Undo / redo */
+    test_undo_restores_brush();
+    test_record_saves_only_touched_chunks();
+    test_drag_is_one_entry();
+    test_stroke_saves_only_written_chunks();
+    test_undo_wakes_restored_chunks();
+    test_new_edit_drops_redo();
+
+    /* Region edits */
+    test_undo_fill_rect();
+    test_undo_copy_region();
+    test_undo_flood_fill();
+
+    /* Sharing and limits */
+    test_unchanged_chunks_are_shared();
+    test_budget_drops_oldest();
+    test_entry_over_budget_is_dropped();
+    test_max_entries();
+    test_bad_arguments();
+
+    return 0;
+}
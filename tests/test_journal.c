@@ -0,0 +1,275 @@
+#include <assert.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "journal/journal.h"
+#include "journal/journal.c"
+#include "test_grid_helpers.h"
+
+/* ── Helpers ─────────────────────────────────────────────────────────── */
+
+#define TEST_JOURNAL_PATH "test_journal.fsrj"
+
+static const JournalHeader test_header = {.width = TEST_WIDTH, .height = TEST_HEIGHT, .seed = 99, .flags = 0};
+
+static void write_bytes(const void *bytes, size_t size) {
+    FILE *file = fopen(TEST_JOURNAL_PATH, "wb");
+    assert(file);
+    assert(fwrite(bytes, 1, size, file) == size);
+    fclose(file);
+}
+
+/* ────────────────────────────────────────────────────────────────────── */
+/*  varints                                                              */
+/* ────────────────────────────────────────────────────────────────────── */
+
+static void test_varint_round_trip(void) {
+    static const Uint64 values[] = {0, 1, 127, 128, 300, 16383, 16384, 0xFFFFFFFFull, ~0ull};
+    SDL_IOStream *io = SDL_IOFromFile(TEST_JOURNAL_PATH, "wb");
+    for (size_t i = 0; i < SDL_arraysize(values); i++)
+        assert(journal_write_varint(io, values[i]));
+    SDL_CloseIO(io);
+
+    io = SDL_IOFromFile(TEST_JOURNAL_PATH, "rb");
+    for (size_t i = 0; i < SDL_arraysize(values); i++) {
+        Uint64 value;
+        assert(journal_read_varint(io, &value));
+        assert(value == values[i]);
+    }
+    SDL_CloseIO(io);
+}
+
+static void test_varint_small_values_take_one_byte(void) {
+    SDL_IOStream *io = SDL_IOFromFile(TEST_JOURNAL_PATH, "wb");
+    assert(journal_write_varint(io, 127));
+    SDL_CloseIO(io);
+
+    io = SDL_IOFromFile(TEST_JOURNAL_PATH, "rb");
+    assert(SDL_GetIOSize(io) == 1);
+    SDL_CloseIO(io);
+}
+
+/* ────────────────────────────────────────────────────────────────────── */
+/*  write / read                                                         */
+/* ────────────────────────────────────────────────────────────────────── */
+
+static void test_round_trip(void) {
+    Journal journal;
+    assert(journal_open_write(&journal, TEST_JOURNAL_PATH, &test_header));
+    JournalEvent written[] = {
+        {.kind = JOURNAL_EVENT_BRUSH, .tick = 0, .center = {3, 4}, .radius = 2, .type = SAND},
+        {.kind = JOURNAL_EVENT_BRUSH, .tick = 0, .center = {70, 50}, .radius = 0, .type = ROCK},
+        {.kind = JOURNAL_EVENT_RESET, .tick = 12},
+        {.kind = JOURNAL_EVENT_BRUSH, .tick = 500, .center = {0, 0}, .radius = 15, .type = EMPTY},
+        {.kind = JOURNAL_EVENT_STROKE, .tick = 501, .from = {9, 2}, .center = {60, 41}, .radius = 4, .type = SAND},
+        {.kind = JOURNAL_EVENT_UNDO, .tick = 502},
+        {.kind = JOURNAL_EVENT_REDO, .tick = 502},
+    };
+    for (size_t i = 0; i < SDL_arraysize(written); i++)
+        assert(journal_write_event(&journal, &written[i]));
+    assert(journal_close(&journal, 640));
+
+    JournalHeader header;
+    assert(journal_open_read(&journal, TEST_JOURNAL_PATH, &header));
+    assert(header.width == TEST_WIDTH && header.height == TEST_HEIGHT);
+    assert(header.seed == 99 && header.flags == 0);
+
+    JournalEvent event;
+    for (size_t i = 0; i < SDL_arraysize(written); i++) {
+        assert(journal_read_event(&journal, &event));
+        assert(event.kind == written[i].kind);
+        assert(event.tick == written[i].tick);
+        assert(event.center.x == written[i].center.x && event.center.y == written[i].center.y);
+        assert(event.from.x == written[i].from.x && event.from.y == written[i].from.y);
+        assert(event.radius == written[i].radius);
+        assert(event.type == written[i].type);
+    }
+    assert(journal_read_event(&journal, &event));
+    assert(event.kind == JOURNAL_EVENT_END);
+    assert(event.tick == 640);
+    assert(!journal_read_event(&journal, &event));
+    assert(journal_close(&journal, 0));
+}
+
+static void test_write_rejects_going_back_in_time(void) {
+    Journal journal;
+    assert(journal_open_write(&journal, TEST_JOURNAL_PATH, &test_header));
+    assert(journal_write_event(&journal, &(JournalEvent){.kind = JOURNAL_EVENT_RESET, .tick = 10}));
+    assert(!journal_write_event(&journal, &(JournalEvent){.kind = JOURNAL_EVENT_RESET, .tick = 9}));
+    assert(!journal_write_event(&journal, &(JournalEvent){.kind = JOURNAL_EVENT_END, .tick = 20}));
+    assert(journal_close(&journal, 10));
+}
+
+static void test_open_rejects_bad_magic(void) {
+    write_bytes("NOPE\1\0\0\0", 8);
+    Journal journal;
+    JournalHeader header;
+    assert(!journal_open_read(&journal, TEST_JOURNAL_PATH, &header));
+    assert(journal.io == NULL);
+}
+
+static void test_open_reads_version_1(void) {
+    /* Header with version 1, 2x3, seed 7, then a brush at tick 4 and END */
+    static const Uint8 bytes[] = {'F', 'S', 'R', 'J', 1, 0, 0, 0, 2, 0, 0, 0, 3, 0, 0, 0, 7, 0, 0, 0, 0, 0, 0, 0, 0,
+                                  JOURNAL_EVENT_BRUSH, 4, 1, 2, 0, SAND, JOURNAL_EVENT_END, 0};
+    write_bytes(bytes, sizeof(bytes));
+
+    Journal journal;
+    JournalHeader header;
+    JournalEvent event;
+    assert(journal_open_read(&journal, TEST_JOURNAL_PATH, &header));
+    assert(header.width == 2 && header.height == 3 && header.seed == 7);
+    assert(journal_read_event(&journal, &event));
+    assert(event.kind == JOURNAL_EVENT_BRUSH && event.tick == 4);
+    assert(event.center.x == 1 && event.center.y == 2 && event.type == SAND);
+    assert(journal_read_event(&journal, &event));
+    assert(event.kind == JOURNAL_EVENT_END);
+    journal_close(&journal, 0);
+
+    write_bytes("FSRJ\4\0\0\0", 8);
+    assert(!journal_open_read(&journal, TEST_JOURNAL_PATH, &header));
+}
+
+static void test_open_missing_file(void) {
+    Journal journal;
+    JournalHeader header;
+    assert(!journal_open_read(&journal, "does/not/exist.fsrj", &header));
+    assert(!journal_open_write(&journal, TEST_JOURNAL_PATH, &(JournalHeader){.width = 0, .height = 1}));
+    assert(!journal_open_read(NULL, TEST_JOURNAL_PATH, &header));
+}
+
+static void test_truncated_event(void) {
+    Journal journal;
+    assert(journal_open_write(&journal, TEST_JOURNAL_PATH, &test_header));
+    assert(journal_write_event(&journal, &(JournalEvent){.kind = JOURNAL_EVENT_BRUSH, .center = {1, 1}, .radius = 1, .type = SAND}));
+    SDL_CloseIO(journal.io);
+
+    /* Drop the type byte of the brush */
+    FILE *file = fopen(TEST_JOURNAL_PATH, "rb");
+    Uint8 bytes[64];
+    size_t size = fread(bytes, 1, sizeof(bytes), file);
+    fclose(file);
+    write_bytes(bytes, size - 1);
+
+    JournalHeader header;
+    JournalEvent event;
+    assert(journal_open_read(&journal, TEST_JOURNAL_PATH, &header));
+    assert(!journal_read_event(&journal, &event));
+    journal_close(&journal, 0);
+}
+
+/* ────────────────────────────────────────────────────────────────────── */
+/*  replay                                                               */
+/* ────────────────────────────────────────────────────────────────────── */
+
+static void test_replay_reproduces_run(void) {
+    Grid live, replayed;
+    History live_history, replayed_history;
+    assert(grid_initialize(&live, TEST_WIDTH, TEST_HEIGHT));
+    assert(grid_initialize(&replayed, TEST_WIDTH, TEST_HEIGHT));
+    assert(history_initialize(&live_history, &live, HISTORY_MEMORY_BUDGET, HISTORY_MAX_ENTRIES));
+    assert(history_initialize(&replayed_history, &replayed, HISTORY_MEMORY_BUDGET, HISTORY_MAX_ENTRIES));
+    grid_set_seed(&live, test_header.seed);
+
+    Journal journal;
+    assert(journal_open_write(&journal, TEST_JOURNAL_PATH, &test_header));
+    for (int tick = 0; tick < 200; tick++) {
+        if (tick % 5 == 0 && tick < 150) {
+            JournalEvent event = {.kind = tick % 10 == 0 ? JOURNAL_EVENT_STROKE : JOURNAL_EVENT_BRUSH,
+                                  .tick = live.tick_count, .from = {(tick * 3) % TEST_WIDTH, 12},
+                                  .center = {(tick * 7) % TEST_WIDTH, 5}, .radius = 3,
+                                  .type = tick % 15 == 0 ? ROCK : SAND};
+            journal_apply_event(&live, &live_history, &event);
+            assert(journal_write_event(&journal, &event));
+        }
+        if (tick % 35 == 0 || tick % 55 == 0) {
+            JournalEvent event = {.kind = tick % 35 == 0 ? JOURNAL_EVENT_UNDO : JOURNAL_EVENT_REDO,
+                                  .tick = live.tick_count};
+            journal_apply_event(&live, &live_history, &event);
+            assert(journal_write_event(&journal, &event));
+        }
+        grid_update(&live);
+    }
+    assert(journal_close(&journal, live.tick_count));
+
+    JournalHeader header;
+    assert(journal_open_read(&journal, TEST_JOURNAL_PATH, &header));
+    grid_set_seed(&replayed, header.seed);
+    JournalEvent event;
+    while (journal_read_event(&journal, &event)) {
+        while (replayed.tick_count < event.tick)
+            grid_update(&replayed);
+        if (event.kind == JOURNAL_EVENT_END)
+            break;
+        journal_apply_event(&replayed, &replayed_history, &event);
+    }
+    journal_close(&journal, 0);
+
+    assert(event.kind == JOURNAL_EVENT_END);
+    assert(replayed.tick_count == live.tick_count);
+    assert(grids_equal(&live, &replayed));
+
+    history_destroy(&live_history);
+    history_destroy(&replayed_history);
+    grid_destroy(&live);
+    grid_destroy(&replayed);
+}
+
+static void test_apply_reset(void) {
+    Grid grid;
+    assert(grid_initialize(&grid, TEST_WIDTH, TEST_HEIGHT));
+    grid_place_particle(&grid, (Coordinates){4, 4}, SAND);
+    journal_apply_event(&grid, NULL, &(JournalEvent){.kind = JOURNAL_EVENT_RESET});
+    assert(grid_get_particle_type(&grid, (Coordinates){4, 4}) == EMPTY);
+    journal_apply_event(NULL, NULL, &(JournalEvent){.kind = JOURNAL_EVENT_RESET});
+    grid_destroy(&grid);
+}
+
+static void test_apply_undo_reset(void) {
+    Grid grid;
+    History history;
+    assert(grid_initialize(&grid, TEST_WIDTH, TEST_HEIGHT));
+    assert(history_initialize(&history, &grid, HISTORY_MEMORY_BUDGET, HISTORY_MAX_ENTRIES));
+    grid_place_particle(&grid, (Coordinates){70, 50}, ROCK);
+
+    journal_apply_event(&grid, &history, &(JournalEvent){.kind = JOURNAL_EVENT_RESET});
+    assert(grid_get_particle_type(&grid, (Coordinates){70, 50}) == EMPTY);
+    journal_apply_event(&grid, &history, &(JournalEvent){.kind = JOURNAL_EVENT_UNDO});
+    assert(grid_get_particle_type(&grid, (Coordinates){70, 50}) == ROCK);
+    journal_apply_event(&grid, &history, &(JournalEvent){.kind = JOURNAL_EVENT_REDO});
+    assert(grid_get_particle_type(&grid, (Coordinates){70, 50}) == EMPTY);
+
+    /* Without a history there is nothing to undo */
+    grid_place_particle(&grid, (Coordinates){70, 50}, ROCK);
+    journal_apply_event(&grid, NULL, &(JournalEvent){.kind = JOURNAL_EVENT_RESET});
+    journal_apply_event(&grid, NULL, &(JournalEvent){.kind = JOURNAL_EVENT_UNDO});
+    assert(grid_get_particle_type(&grid, (Coordinates){70, 50}) == EMPTY);
+
+    history_destroy(&history);
+    grid_destroy(&grid);
+}
+
+/* ── Runner ──────────────────────────────────────────────────────────── */
+
+int main(void) {
+    /* Varints */
+    test_varint_round_trip();
+    test_varint_small_values_take_one_byte();
+
+    /* Write / read */
+    test_round_trip();
+    test_write_rejects_going_back_in_time();
+    test_open_rejects_bad_magic();
+    test_open_reads_version_1();
+    test_open_missing_file();
+    test_truncated_event();
+
+    /* Replay */
+    test_replay_reproduces_run();
+    test_apply_reset();
+    test_apply_undo_reset();
+
+    remove(TEST_JOURNAL_PATH);
+    return 0;
+}
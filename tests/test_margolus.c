@@ -0,0 +1,144 @@
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "margolus/margolus.h"
+#include "margolus/margolus.c"
+
+/* ── Helpers ─────────────────────────────────────────────────────────── */
+
+#define WALL 0xFF
+
+static MargolusRules rules;
+
+/* Steps one block given as {top left, top right, bottom left, bottom right} and writes the result back. */
+static void step(Uint8 cells[4]) {
+    Uint8 move = rules.moves[margolus_state(&rules, cells[0], cells[1], cells[2], cells[3])];
+    Uint8 before[4] = {cells[0], cells[1], cells[2], cells[3]};
+    for (int i = 0; i < 4; i++)
+        cells[i] = before[margolus_source(move, i)];
+}
+
+static bool block_is(const Uint8 cells[4], Uint8 top_left, Uint8 top_right, Uint8 bottom_left, Uint8 bottom_right) {
+    return cells[0] == top_left && cells[1] == top_right && cells[2] == bottom_left && cells[3] == bottom_right;
+}
+
+/* ────────────────────────────────────────────────────────────────────── */
+/*  table                                                                */
+/* ────────────────────────────────────────────────────────────────────── */
+
+static void test_classes_fold_unknown_ids_into_walls(void) {
+    for (int id = 0; id < 256; id++)
+        assert(rules.classes[id] == (id < PARTICLE_TYPE_COUNT ? id : MARGOLUS_WALL));
+    assert(margolus_state(&rules, WALL, WALL, WALL, WALL) == MARGOLUS_STATES - 1);
+    assert(margolus_state(&rules, EMPTY, EMPTY, EMPTY, EMPTY) == 0);
+}
+
+/* Every move is a permutation that leaves walls and static materials where they are. */
+static void test_moves_conserve_cells(void) {
+    for (int state = 0; state < MARGOLUS_STATES; state++) {
+        Uint8 move = rules.moves[state];
+        bool taken[4] = {false};
+        int rest = state;
+        for (int cell = 0; cell < 4; cell++) {
+            int class = rest % MARGOLUS_CLASSES;
+            rest /= MARGOLUS_CLASSES;
+            int source = margolus_source(move, cell);
+            assert(!taken[source]);
+            taken[source] = true;
+            if (class == MARGOLUS_WALL || class == ROCK)
+                assert(source == cell);
+        }
+    }
+}
+
+static void test_still_blocks_are_identity(void) {
+    assert(rules.moves[margolus_state(&rules, EMPTY, EMPTY, EMPTY, EMPTY)] == MARGOLUS_IDENTITY);
+    assert(rules.moves[margolus_state(&rules, ROCK, EMPTY, EMPTY, ROCK)] == MARGOLUS_IDENTITY);
+    assert(rules.moves[margolus_state(&rules, SAND, SAND, SAND, SAND)] == MARGOLUS_IDENTITY);
+    assert(rules.moves[margolus_state(&rules, EMPTY, EMPTY, SAND, WATER)] == MARGOLUS_IDENTITY);
+}
+
+/* ────────────────────────────────────────────────────────────────────── */
+/*  rules                                                                */
+/* ────────────────────────────────────────────────────────────────────── */
+
+static void test_sand_falls(void) {
+    Uint8 cells[4] = {SAND, SAND, EMPTY, EMPTY};
+    step(cells);
+    assert(block_is(cells, EMPTY, EMPTY, SAND, SAND));
+}
+
+static void test_sand_slides_past_open_side(void) {
+    Uint8 cells[4] = {SAND, EMPTY, SAND, EMPTY};
+    step(cells);
+    assert(block_is(cells, EMPTY, EMPTY, SAND, SAND));
+
+    Uint8 mirrored[4] = {EMPTY, SAND, EMPTY, ROCK};
+    step(mirrored);
+    assert(block_is(mirrored, EMPTY, EMPTY, SAND, ROCK));
+}
+
+static void test_sand_does_not_slide_past_rock(void) {
+    Uint8 cells[4] = {SAND, ROCK, SAND, EMPTY};
+    step(cells);
+    assert(block_is(cells, SAND, ROCK, SAND, EMPTY));
+}
+
+static void test_sand_sinks_through_water(void) {
+    Uint8 cells[4] = {SAND, ROCK, WATER, ROCK};
+    step(cells);
+    assert(block_is(cells, WATER, ROCK, SAND, ROCK));
+
+    /* Water is lighter, so it rests on sand */
+    Uint8 floating[4] = {WATER, ROCK, SAND, ROCK};
+    step(floating);
+    assert(block_is(floating, WATER, ROCK, SAND, ROCK));
+}
+
+static void test_water_flows_along_rows(void) {
+    Uint8 cells[4] = {EMPTY, EMPTY, WATER, EMPTY};
+    step(cells);
+    assert(block_is(cells, EMPTY, EMPTY, EMPTY, WATER));
+
+    Uint8 resting[4] = {EMPTY, WATER, ROCK, ROCK};
+    step(resting);
+    assert(block_is(resting, WATER, EMPTY, ROCK, ROCK));
+}
+
+static void test_walls_never_move_or_give_way(void) {
+    Uint8 cells[4] = {SAND, WATER, WALL, WALL};
+    step(cells);
+    assert(block_is(cells, SAND, WATER, WALL, WALL));
+
+    Uint8 border[4] = {WALL, WALL, WALL, SAND};
+    step(border);
+    assert(block_is(border, WALL, WALL, WALL, SAND));
+}
+
+static void test_build_null(void) {
+    margolus_build_rules(NULL);
+    /* Should not crash */
+}
+
+/* ── Runner ──────────────────────────────────────────────────────────── */
+
+int main(void) {
+    margolus_build_rules(&rules);
+
+    /* Table */
+    test_classes_fold_unknown_ids_into_walls();
+    test_moves_conserve_cells();
+    test_still_blocks_are_identity();
+
+    /* Rules */
+    test_sand_falls();
+    test_sand_slides_past_open_side();
+    test_sand_does_not_slide_past_rock();
+    test_sand_sinks_through_water();
+    test_water_flows_along_rows();
+    test_walls_never_move_or_give_way();
+    test_build_null();
+
+    return 0;
+}
@@ -6,13 +6,13 @@
 
 /* ── Mock redirections ───────────────────────────────────────────────── */
 
-#define SDL_rand                    fake_SDL_rand
+#define random_below                fake_random_below
 #define SDL_Log                     fake_SDL_Log
 
 #include "particle/particle.h"
 #include "particle/particle.c"
 
-#undef SDL_rand
+#undef random_below
 #undef SDL_Log
 
 /* ── Fake state ──────────────────────────────────────────────────────── */
@@ -23,7 +23,7 @@ typedef struct FakeState {
     int log_calls;
     int rand_calls;
 
-    /* Controllable SDL_rand return queue */
+    /* Controllable random_below return queue */
     Sint32 rand_queue[RAND_QUEUE_SIZE];
     int    rand_queue_len;
     int    rand_queue_pos;
@@ -35,7 +35,7 @@ static void reset_fake_state(void) {
     memset(&fake_state, 0, sizeof(fake_state));
 }
 
-/* Push a sequence of values that fake_SDL_rand will return. */
+/* Push a sequence of values that fake_random_below will return. */
 static void push_rand_values(const Sint32 *values, int count) {
     assert(count <= RAND_QUEUE_SIZE);
     memcpy(fake_state.rand_queue, values, (size_t)count * sizeof(Sint32));
@@ -53,11 +53,12 @@ void fake_SDL_Log(const char *fmt, ...) {
     fake_state.log_calls++;
 }
 
-Sint32 fake_SDL_rand(Sint32 n) {
+Sint32 fake_random_below(Random *random, Sint32 n) {
+    (void)random;
     fake_state.rand_calls++;
     if (fake_state.rand_queue_pos < fake_state.rand_queue_len) {
         Sint32 val = fake_state.rand_queue[fake_state.rand_queue_pos++];
-        /* Clamp to valid range [0, n) just like real SDL_rand */
+        /* Clamp to valid range [0, n) just like the real random_below */
         if (n > 0) { val = val % n; }
         return val;
     }
@@ -97,14 +98,14 @@ static void test_clamp_overflow(void) {
 
 static void test_random_sand_color_center(void) {
     reset_fake_state();
-    /* SDL_rand called 3 times (r, g, b).
+    /* random_below called 3 times (r, g, b).
      * Range = SAND_COLOR_VARIATION * 2 + 1 = 25
      * Returning SAND_COLOR_VARIATION (=12) gives offset 0 */
     Sint32 vals[] = {SAND_COLOR_VARIATION, SAND_COLOR_VARIATION,
                      SAND_COLOR_VARIATION};
     push_rand_values(vals, 3);
 
-    SDL_Color c = particle_get_random_color_by_type(SAND);
+    SDL_Color c = particle_get_random_color_by_type(SAND, NULL);
     assert(c.r == SAND_COLOR_BASE_R);
     assert(c.g == SAND_COLOR_BASE_G);
     assert(c.b == SAND_COLOR_BASE_B);
@@ -119,7 +120,7 @@ static void test_random_sand_color_max_positive(void) {
                      SAND_COLOR_VARIATION * 2};
     push_rand_values(vals, 3);
 
-    SDL_Color c = particle_get_random_color_by_type(SAND);
+    SDL_Color c = particle_get_random_color_by_type(SAND, NULL);
     assert(c.r == clamp_color_component(SAND_COLOR_BASE_R + SAND_COLOR_VARIATION));
     assert(c.g == clamp_color_component(SAND_COLOR_BASE_G + SAND_COLOR_VARIATION));
     assert(c.b == clamp_color_component(SAND_COLOR_BASE_B + SAND_COLOR_VARIATION));
@@ -131,7 +132,7 @@ static void test_random_sand_color_max_negative(void) {
     Sint32 vals[] = {0, 0, 0};
     push_rand_values(vals, 3);
 
-    SDL_Color c = particle_get_random_color_by_type(SAND);
+    SDL_Color c = particle_get_random_color_by_type(SAND, NULL);
     assert(c.r == clamp_color_component(SAND_COLOR_BASE_R - SAND_COLOR_VARIATION));
     assert(c.g == clamp_color_component(SAND_COLOR_BASE_G - SAND_COLOR_VARIATION));
     assert(c.b == clamp_color_component(SAND_COLOR_BASE_B - SAND_COLOR_VARIATION));
@@ -143,7 +144,7 @@ static void test_random_rock_color_center(void) {
                      ROCK_COLOR_VARIATION};
     push_rand_values(vals, 3);
 
-    SDL_Color c = particle_get_random_color_by_type(ROCK);
+    SDL_Color c = particle_get_random_color_by_type(ROCK, NULL);
     assert(c.r == ROCK_COLOR_BASE_R);
     assert(c.g == ROCK_COLOR_BASE_G);
     assert(c.b == ROCK_COLOR_BASE_B);
@@ -186,7 +187,7 @@ static void test_random_color_dispatches_sand(void) {
                      SAND_COLOR_VARIATION};
     push_rand_values(vals, 3);
 
-    SDL_Color c = particle_get_random_color_by_type(SAND);
+    SDL_Color c = particle_get_random_color_by_type(SAND, NULL);
     assert(c.r == SAND_COLOR_BASE_R);
     assert(c.g == SAND_COLOR_BASE_G);
     assert(fake_state.rand_calls == 3);
@@ -198,7 +199,7 @@ static void test_random_color_dispatches_rock(void) {
                      ROCK_COLOR_VARIATION};
     push_rand_values(vals, 3);
 
-    SDL_Color c = particle_get_random_color_by_type(ROCK);
+    SDL_Color c = particle_get_random_color_by_type(ROCK, NULL);
     assert(c.r == ROCK_COLOR_BASE_R);
     assert(c.g == ROCK_COLOR_BASE_G);
     assert(fake_state.rand_calls == 3);
@@ -206,11 +207,37 @@ static void test_random_color_dispatches_rock(void) {
 
 static void test_random_color_empty_no_rand(void) {
     reset_fake_state();
-    SDL_Color c = particle_get_random_color_by_type(EMPTY);
+    SDL_Color c = particle_get_random_color_by_type(EMPTY, NULL);
     assert(c.r == EMPTY_COLOR_BASE_R);
     assert(fake_state.rand_calls == 0);
 }
 
+static void test_fill_colors_draws_like_single_colors(void) {
+    Sint32 vals[] = {0, 1, 2, 3, 4, 5, 6, 7, 8};
+    SDL_Color expected[3];
+    reset_fake_state();
+    push_rand_values(vals, 9);
+    for (int i = 0; i < 3; i++)
+        expected[i] = particle_get_random_color_by_type(SAND, NULL);
+
+    SDL_Color colors[3];
+    reset_fake_state();
+    push_rand_values(vals, 9);
+    particle_fill_random_colors(SAND, colors, 3, NULL);
+    assert(memcmp(colors, expected, sizeof(colors)) == 0);
+    assert(fake_state.rand_calls == 9);
+}
+
+static void test_fill_colors_without_variation(void) {
+    reset_fake_state();
+    SDL_Color colors[4];
+    particle_fill_random_colors(EMPTY, colors, 4, NULL);
+    particle_fill_random_colors(PARTICLE_TYPE_COUNT, colors + 2, 2, NULL);
+    for (int i = 0; i < 4; i++)
+        assert(colors[i].r == EMPTY_COLOR_BASE_R && colors[i].a == EMPTY_COLOR_BASE_A);
+    assert(fake_state.rand_calls == 0);
+}
+
 /* ────────────────────────────────────────────────────────────────────── */
 /*  particle_is_empty                                                    */
 /* ────────────────────────────────────────────────────────────────────── */
@@ -235,6 +262,12 @@ static void test_is_empty_false_rock(void) {
     assert(!particle_is_empty(&p));
 }
 
+static void test_is_type_empty(void) {
+    assert(particle_is_type_empty(EMPTY));
+    assert(!particle_is_type_empty(SAND));
+    assert(!particle_is_type_empty(ROCK));
+}
+
 /* ────────────────────────────────────────────────────────────────────── */
 /*  particle_is_solid / particle_is_type_solid                           */
 /* ────────────────────────────────────────────────────────────────────── */
@@ -270,6 +303,52 @@ static void test_is_type_solid_empty(void) {
     assert(!particle_is_type_solid(EMPTY));
 }
 
+/* ────────────────────────────────────────────────────────────────────── */
+/*  material table                                                       */
+/* ────────────────────────────────────────────────────────────────────── */
+
+/* The row kernel classifies cells by id range; the flags must agree for every byte. */
+static void test_material_flags_match_id_ranges(void) {
+    for (int id = 0; id < 256; id++) {
+        const Material *material = &PARTICLE_MATERIALS[id];
+        bool moving = id >= PARTICLE_FIRST_MOVING && id < PARTICLE_TYPE_COUNT;
+        bool powder = id >= PARTICLE_FIRST_MOVING && id <= PARTICLE_LAST_POWDER;
+        bool liquid = id >= PARTICLE_FIRST_LIQUID && id <= PARTICLE_LAST_LIQUID;
+        bool solid = id > EMPTY && id <= PARTICLE_LAST_SOLID;
+        assert(particle_type_has((Uint8)id, MATERIAL_EMPTY) == (id == EMPTY));
+        assert(particle_type_has((Uint8)id, MATERIAL_SOLID) == solid);
+        assert(particle_type_has((Uint8)id, MATERIAL_MOVES) == moving);
+        assert(particle_type_has((Uint8)id, MATERIAL_POWDER) == powder);
+        assert(particle_type_has((Uint8)id, MATERIAL_LIQUID) == liquid);
+        assert(material->dispersion <= MATERIAL_MAX_DISPERSION);
+        assert((material->kernel != MATERIAL_KERNEL_NONE) == moving);
+        assert(material->kernel < MATERIAL_KERNEL_COUNT);
+        assert((material->name != NULL) == (id < PARTICLE_TYPE_COUNT));
+    }
+}
+
+static void test_material_properties(void) {
+    assert(particle_get_material(ROCK)->priority > particle_get_material(SAND)->priority);
+    assert(particle_get_material(SAND)->priority > particle_get_material(EMPTY)->priority);
+    assert(particle_get_material(ROCK)->density > particle_get_material(SAND)->density);
+    assert(particle_get_material(SAND)->density > particle_get_material(EMPTY)->density);
+    assert(particle_get_material(SAND)->density > particle_get_material(WATER)->density);
+    assert(particle_get_material(WATER)->dispersion == WATER_DISPERSION);
+    assert(particle_get_material(SAND)->color_variation == SAND_COLOR_VARIATION);
+    assert(strcmp(particle_get_material(SAND)->name, "sand") == 0);
+}
+
+static void test_unknown_type_draws_empty(void) {
+    reset_fake_state();
+    SDL_Color c = particle_get_random_color_by_type(PARTICLE_TYPE_COUNT, NULL);
+    assert(c.r == EMPTY_COLOR_BASE_R && c.g == EMPTY_COLOR_BASE_G && c.b == EMPTY_COLOR_BASE_B);
+    assert(fake_state.rand_calls == 0);
+    c = particle_get_default_color_by_type((ParticleType)0xFF);
+    assert(c.r == EMPTY_COLOR_BASE_R && c.a == EMPTY_COLOR_BASE_A);
+    assert(!particle_is_type_empty((ParticleType)0xFF));
+    assert(!particle_is_type_solid((ParticleType)0xFF));
+}
+
 /* ── Runner ──────────────────────────────────────────────────────────── */
 
 int main(void) {
@@ -293,12 +372,15 @@ int main(void) {
     test_random_color_dispatches_sand();
     test_random_color_dispatches_rock();
     test_random_color_empty_no_rand();
+    test_fill_colors_draws_like_single_colors();
+    test_fill_colors_without_variation();
 
     /* particle_is_empty */
     test_is_empty_null();
     test_is_empty_true();
     test_is_empty_false_sand();
     test_is_empty_false_rock();
+    test_is_type_empty();
 
     /* particle_is_solid / particle_is_type_solid */
     test_is_solid_null();
@@ -309,5 +391,10 @@ int main(void) {
     test_is_type_solid_sand();
     test_is_type_solid_empty();
 
+    /* Material table */
+    test_material_flags_match_id_ranges();
+    test_material_properties();
+    test_unknown_type_draws_empty();
+
     return 0;
 }
@@ -0,0 +1,152 @@
+#include <assert.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+/* Test the enabled build whatever the configuration */
+#ifndef FALLING_SAND_PROFILE
+#define FALLING_SAND_PROFILE
+#endif
+
+#include "profiler/profiler.h"
+#include "profiler/profiler.c"
+
+/* ── Helpers ─────────────────────────────────────────────────────────── */
+
+#define TEST_TRACE_PATH "test_profiler_trace.json"
+
+static bool is_ticks(double ms, Uint64 ticks) {
+    double expected = (double)ticks * 1e3 / (double)SDL_GetPerformanceFrequency();
+    return SDL_fabs(ms - expected) <= expected * 1e-9;
+}
+
+static size_t read_trace(char *text, size_t capacity) {
+    FILE *file = fopen(TEST_TRACE_PATH, "rb");
+    assert(file);
+    size_t size = fread(text, 1, capacity - 1, file);
+    fclose(file);
+    text[size] = '\0';
+    return size;
+}
+
+static int count_occurrences(const char *text, const char *needle) {
+    int count = 0;
+    for (const char *at = strstr(text, needle); at; at = strstr(at + 1, needle))
+        count++;
+    return count;
+}
+
+/* ────────────────────────────────────────────────────────────────────── */
+/*  recording / stats                                                    */
+/* ────────────────────────────────────────────────────────────────────── */
+
+static void test_stats_of_known_samples(void) {
+    profiler_initialize();
+    /* Durations 1..100 */
+    for (Uint64 i = 1; i <= 100; i++)
+        profiler_record(PROFILE_ZONE_TICK, 1000 * i, 1000 * i + i);
+
+    ProfilerStats stats;
+    assert(profiler_get_stats(PROFILE_ZONE_TICK, &stats));
+    assert(stats.count == 100);
+    assert(is_ticks(stats.min_ms, 1));
+    assert(is_ticks(stats.max_ms, 100));
+    assert(is_ticks(stats.p99_ms, 99));
+    assert(SDL_fabs(stats.avg_ms / stats.min_ms - 50.5) < 1e-9);
+}
+
+static void test_zones_are_separate(void) {
+    profiler_initialize();
+    profiler_record(PROFILE_ZONE_UPLOAD, 0, 10);
+
+    ProfilerStats stats;
+    assert(profiler_get_stats(PROFILE_ZONE_PRESENT, &stats));
+    assert(stats.count == 0);
+    assert(profiler_get_stats(PROFILE_ZONE_UPLOAD, &stats));
+    assert(stats.count == 1);
+    assert(stats.p99_ms == stats.min_ms);
+}
+
+static void test_ring_keeps_newest_samples(void) {
+    profiler_initialize();
+    for (Uint64 i = 0; i < PROFILER_RING_SIZE + 10; i++)
+        profiler_record(PROFILE_ZONE_PUBLISH, i, i + (i < 10 ? 1000000 : 1));
+
+    ProfilerStats stats;
+    assert(profiler_get_stats(PROFILE_ZONE_PUBLISH, &stats));
+    assert(stats.count == PROFILER_RING_SIZE);
+    assert(is_ticks(stats.max_ms, 1));
+
+    ProfilerSample samples[PROFILER_RING_SIZE];
+    assert(profiler_copy_samples(PROFILE_ZONE_PUBLISH, samples) == PROFILER_RING_SIZE);
+    assert(samples[0].start == 10);
+    assert(samples[PROFILER_RING_SIZE - 1].start == PROFILER_RING_SIZE + 9);
+}
+
+static void test_invalid_zone(void) {
+    profiler_record(PROFILE_ZONE_COUNT, 0, 1);
+    ProfilerStats stats;
+    assert(!profiler_get_stats(PROFILE_ZONE_COUNT, &stats));
+    assert(!profiler_get_stats(PROFILE_ZONE_TICK, NULL));
+    assert(profiler_get_zone_name(PROFILE_ZONE_COUNT) == NULL);
+    assert(strcmp(profiler_get_zone_name(PROFILE_ZONE_TICK), "tick") == 0);
+}
+
+static void test_macros_record_a_zone(void) {
+    profiler_initialize();
+    {
+        PROFILE_BEGIN(PROFILE_ZONE_COMMANDS);
+        PROFILE_END(PROFILE_ZONE_COMMANDS);
+    }
+    ProfilerStats stats;
+    assert(profiler_get_stats(PROFILE_ZONE_COMMANDS, &stats));
+    assert(stats.count == 1);
+}
+
+/* ────────────────────────────────────────────────────────────────────── */
+/*  trace export                                                         */
+/* ────────────────────────────────────────────────────────────────────── */
+
+static void test_export_trace(void) {
+    profiler_initialize();
+    Uint64 now = SDL_GetPerformanceCounter();
+    profiler_record(PROFILE_ZONE_TICK, now, now + 5);
+    profiler_record(PROFILE_ZONE_TICK, now + 10, now + 20);
+    profiler_record(PROFILE_ZONE_PRESENT, now + 20, now + 30);
+    assert(profiler_export_trace(TEST_TRACE_PATH));
+
+    static char text[1 << 16];
+    size_t size = read_trace(text, sizeof(text));
+    assert(size > 0);
+    assert(strncmp(text, "{\"traceEvents\":[", 16) == 0);
+    assert(strcmp(text + size - 4, "\n]}\n") == 0);
+    assert(count_occurrences(text, "\"ph\":\"M\"") == 2);
+    assert(count_occurrences(text, "\"name\":\"tick\",\"ph\":\"X\"") == 2);
+    assert(count_occurrences(text, "\"name\":\"present\",\"ph\":\"X\",\"pid\":1,\"tid\":0") == 1);
+
+    /* Every event but the first follows a comma */
+    assert(count_occurrences(text, "\n{\"name\"") == count_occurrences(text, ",\n{") + 1);
+}
+
+static void test_export_to_bad_path(void) {
+    assert(!profiler_export_trace("does/not/exist/trace.json"));
+    assert(!profiler_export_trace(NULL));
+}
+
+/* ── Runner ──────────────────────────────────────────────────────────── */
+
+int main(void) {
+    /* Recording / stats */
+    test_stats_of_known_samples();
+    test_zones_are_separate();
+    test_ring_keeps_newest_samples();
+    test_invalid_zone();
+    test_macros_record_a_zone();
+
+    /* Trace export */
+    test_export_trace();
+    test_export_to_bad_path();
+
+    remove(TEST_TRACE_PATH);
+    return 0;
+}
@@ -0,0 +1,174 @@
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "random/random.h"
+#include "random/random.c"
+
+/* ────────────────────────────────────────────────────────────────────── */
+/*  random_seed / random_seed_stream                                     */
+/* ────────────────────────────────────────────────────────────────────── */
+
+static void test_same_seed_same_sequence(void) {
+    Random a, b;
+    random_seed(&a, 42);
+    random_seed(&b, 42);
+    for (int i = 0; i < 1000; i++)
+        assert(random_next(&a) == random_next(&b));
+}
+
+static void test_different_seeds_differ(void) {
+    Random a, b;
+    random_seed(&a, 1);
+    random_seed(&b, 2);
+    assert(random_next(&a) != random_next(&b));
+}
+
+static void test_zero_seed_is_usable(void) {
+    Random random;
+    random_seed(&random, 0);
+    assert(random.state[0] | random.state[1] | random.state[2] | random.state[3]);
+    assert(random_next(&random) != random_next(&random));
+}
+
+static void test_seed_null(void) {
+    random_seed(NULL, 1);
+    random_seed_stream(NULL, 1, 2);
+    /* Should not crash */
+}
+
+static void test_streams_differ(void) {
+    Random a, b;
+    random_seed_stream(&a, 7, 0);
+    random_seed_stream(&b, 7, 1);
+    assert(random_next(&a) != random_next(&b));
+
+    Random c;
+    random_seed_stream(&c, 7, 0);
+    random_seed_stream(&a, 7, 0);
+    assert(random_next(&a) == random_next(&c));
+}
+
+static void test_reseed_clears_buffered_bits(void) {
+    Random a, b;
+    random_seed(&a, 3);
+    random_bit(&a);
+    random_seed(&a, 5);
+    random_seed(&b, 5);
+    for (int i = 0; i < 100; i++)
+        assert(random_bit(&a) == random_bit(&b));
+}
+
+/* ────────────────────────────────────────────────────────────────────── */
+/*  random_bit                                                           */
+/* ────────────────────────────────────────────────────────────────────── */
+
+static void test_bits_come_from_one_draw(void) {
+    Random bits, words;
+    random_seed(&bits, 9);
+    random_seed(&words, 9);
+
+    Uint64 word = random_next(&words);
+    for (int i = 0; i < 64; i++)
+        assert(random_bit(&bits) == ((word >> i) & 1));
+
+    /* The 65th bit needs the next draw */
+    word = random_next(&words);
+    assert(random_bit(&bits) == (word & 1));
+}
+
+static void test_bits_are_balanced(void) {
+    Random random;
+    random_seed(&random, 11);
+    int ones = 0;
+    for (int i = 0; i < 100000; i++)
+        ones += random_bit(&random);
+    assert(ones > 49000 && ones < 51000);
+}
+
+/* ────────────────────────────────────────────────────────────────────── */
+/*  random_below                                                         */
+/* ────────────────────────────────────────────────────────────────────── */
+
+static void test_below_in_range(void) {
+    Random random;
+    random_seed(&random, 13);
+    int seen[25] = {0};
+    for (int i = 0; i < 10000; i++) {
+        Sint32 value = random_below(&random, 25);
+        assert(value >= 0 && value < 25);
+        seen[value]++;
+    }
+    for (int i = 0; i < 25; i++)
+        assert(seen[i] > 0);
+}
+
+static void test_below_non_positive(void) {
+    Random random;
+    random_seed(&random, 13);
+    assert(random_below(&random, 0) == 0);
+    assert(random_below(&random, -5) == 0);
+    assert(random_below(NULL, 10) == 0);
+}
+
+static void test_below_one(void) {
+    Random random;
+    random_seed(&random, 17);
+    for (int i = 0; i < 100; i++)
+        assert(random_below(&random, 1) == 0);
+}
+
+/* ────────────────────────────────────────────────────────────────────── */
+/*  random_hash                                                          */
+/* ────────────────────────────────────────────────────────────────────── */
+
+static void test_hash_depends_only_on_inputs(void) {
+    Uint64 first = random_hash(7, 3, 100);
+    for (int i = 0; i < 1000; i++)
+        random_hash(7, 3, (Uint64)i);
+    assert(random_hash(7, 3, 100) == first);
+
+    assert(random_hash(8, 3, 100) != first);
+    assert(random_hash(7, 4, 100) != first);
+    assert(random_hash(7, 3, 101) != first);
+}
+
+/* Neighboring indexes and streams must not give correlated low bits. */
+static void test_hash_bits_are_balanced(void) {
+    int ones = 0;
+    int agree = 0;
+    for (Uint64 i = 0; i < 100000; i++) {
+        ones += (int)(random_hash(0, 1, i) & 1);
+        agree += (random_hash(0, 1, i) & 1) == (random_hash(0, 2, i) & 1);
+    }
+    assert(ones > 49000 && ones < 51000);
+    assert(agree > 49000 && agree < 51000);
+}
+
+/* ── Runner ──────────────────────────────────────────────────────────── */
+
+int main(void) {
+    /* Seeding */
+    test_same_seed_same_sequence();
+    test_different_seeds_differ();
+    test_zero_seed_is_usable();
+    test_seed_null();
+    test_streams_differ();
+    test_reseed_clears_buffered_bits();
+
+    /* Bits */
+    test_bits_come_from_one_draw();
+    test_bits_are_balanced();
+
+    /* Bounded draws */
+    test_below_in_range();
+    test_below_non_positive();
+    test_below_one();
+
+    /* Hashes */
+    test_hash_depends_only_on_inputs();
+    test_hash_bits_are_balanced();
+
+    return 0;
+}
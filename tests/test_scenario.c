@@ -0,0 +1,148 @@
+#include <assert.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "scenario/scenario.h"
+#include "scenario/scenario.c"
+#include "test_grid_helpers.h"
+
+/* ── Helpers ─────────────────────────────────────────────────────────── */
+
+static int count_type(Grid* grid, ParticleType type) {
+    int count = 0;
+    for (int y = 0; y < grid->height; y++)
+        for (int x = 0; x < grid->width; x++)
+            if (grid->types[grid_index(grid, x, y)] == type)
+                count++;
+    return count;
+}
+
+/* ────────────────────────────────────────────────────────────────────── */
+/*  scenario_get_name / scenario_find                                    */
+/* ────────────────────────────────────────────────────────────────────── */
+
+static void test_names_round_trip(void) {
+    for (int i = 0; i < SCENARIO_COUNT; i++) {
+        ScenarioKind kind = SCENARIO_COUNT;
+        assert(scenario_find(scenario_get_name((ScenarioKind)i), &kind));
+        assert(kind == (ScenarioKind)i);
+    }
+}
+
+static void test_find_unknown(void) {
+    ScenarioKind kind = SCENARIO_PILE;
+    assert(!scenario_find("lava", &kind));
+    assert(!scenario_find(NULL, &kind));
+    assert(kind == SCENARIO_PILE);
+}
+
+static void test_get_name_out_of_range(void) {
+    assert(scenario_get_name(SCENARIO_COUNT) == NULL);
+}
+
+/* ────────────────────────────────────────────────────────────────────── */
+/*  scenario_generate                                                    */
+/* ────────────────────────────────────────────────────────────────────── */
+
+static void test_generate_empty(void) {
+    Grid grid;
+    assert(grid_initialize(&grid, TEST_WIDTH, TEST_HEIGHT));
+    grid_place_particle(&grid, (Coordinates){3, 3}, SAND);
+
+    assert(scenario_generate(&grid, SCENARIO_EMPTY, 1));
+    assert(count_type(&grid, EMPTY) == TEST_WIDTH * TEST_HEIGHT);
+    grid_destroy(&grid);
+}
+
+static void test_generate_settled_does_not_move(void) {
+    Grid grid;
+    assert(grid_initialize(&grid, TEST_WIDTH, TEST_HEIGHT));
+    assert(scenario_generate(&grid, SCENARIO_SETTLED, 1));
+    assert(count_type(&grid, SAND) == TEST_WIDTH * (TEST_HEIGHT - TEST_HEIGHT / 2));
+
+    Grid before;
+    copy_grid(&before, &grid);
+
+    for (int i = 0; i < 4; i++)
+        grid_update(&grid);
+    assert(grid_types_equal(&grid, &before));
+
+    grid_destroy(&before);
+    grid_destroy(&grid);
+}
+
+static void test_generate_avalanche_has_rock_and_sand(void) {
+    Grid grid;
+    assert(grid_initialize(&grid, TEST_WIDTH, TEST_HEIGHT));
+    assert(scenario_generate(&grid, SCENARIO_AVALANCHE, 1));
+    assert(count_type(&grid, SAND) > 0);
+    assert(count_type(&grid, ROCK) > 0);
+    grid_destroy(&grid);
+}
+
+static void test_generate_flood_has_rock_and_water(void) {
+    Grid grid;
+    assert(grid_initialize(&grid, TEST_WIDTH, TEST_HEIGHT));
+    assert(scenario_generate(&grid, SCENARIO_FLOOD, 1));
+    int water = count_type(&grid, WATER);
+    assert(water == TEST_WIDTH * (TEST_HEIGHT / 3 + 1));
+    assert(count_type(&grid, ROCK) > 0);
+
+    for (int tick = 0; tick < 200; tick++)
+        grid_update(&grid);
+    assert(count_type(&grid, WATER) == water);
+    grid_destroy(&grid);
+}
+
+static void test_generate_same_seed_same_scene(void) {
+    Grid a, b;
+    assert(grid_initialize(&a, TEST_WIDTH, TEST_HEIGHT));
+    assert(grid_initialize(&b, TEST_WIDTH, TEST_HEIGHT));
+
+    assert(scenario_generate(&a, SCENARIO_NOISE, 42));
+    assert(scenario_generate(&b, SCENARIO_NOISE, 42));
+    assert(grid_types_equal(&a, &b));
+
+    assert(scenario_generate(&b, SCENARIO_NOISE, 43));
+    assert(!grid_types_equal(&a, &b));
+
+    grid_destroy(&a);
+    grid_destroy(&b);
+}
+
+static void test_generate_sets_grid_seed(void) {
+    Grid grid;
+    assert(grid_initialize(&grid, TEST_WIDTH, TEST_HEIGHT));
+    assert(scenario_generate(&grid, SCENARIO_PILE, 7));
+    assert(grid.seed == 7);
+    assert(grid.tick_count == 0);
+    grid_destroy(&grid);
+}
+
+static void test_generate_invalid(void) {
+    Grid grid;
+    assert(grid_initialize(&grid, TEST_WIDTH, TEST_HEIGHT));
+    assert(!scenario_generate(&grid, SCENARIO_COUNT, 1));
+    assert(!scenario_generate(NULL, SCENARIO_PILE, 1));
+    grid_destroy(&grid);
+}
+
+/* ── Runner ──────────────────────────────────────────────────────────── */
+
+int main(void) {
+    /* Names */
+    test_names_round_trip();
+    test_find_unknown();
+    test_get_name_out_of_range();
+
+    /* Generation */
+    test_generate_empty();
+    test_generate_settled_does_not_move();
+    test_generate_avalanche_has_rock_and_sand();
+    test_generate_flood_has_rock_and_water();
+    test_generate_same_seed_same_scene();
+    test_generate_sets_grid_seed();
+    test_generate_invalid();
+
+    return 0;
+}
@@ -0,0 +1,147 @@
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "scheduler/scheduler.h"
+#include "scheduler/scheduler.c"
+
+/* ── Helpers ─────────────────────────────────────────────────────────── */
+
+#define TICK 0.25 /* exact in binary, so sums of it don't drift */
+#define BUDGET 0.010
+
+static Scheduler make_scheduler(int max_ticks, int max_backlog) {
+    Scheduler scheduler;
+    scheduler_initialize(&scheduler, TICK, max_ticks, BUDGET, max_backlog);
+    return scheduler;
+}
+
+/* Runs one frame with free ticks and returns how many it ran. */
+static int run_frame(Scheduler *scheduler, double elapsed) {
+    scheduler_begin_frame(scheduler, elapsed);
+    int ticks = 0;
+    while (scheduler_next_tick(scheduler, 0.0))
+        ticks++;
+    return ticks;
+}
+
+/* ────────────────────────────────────────────────────────────────────── */
+/*  steady state                                                         */
+/* ────────────────────────────────────────────────────────────────────── */
+
+static void test_one_tick_per_tick_of_time(void) {
+    Scheduler scheduler = make_scheduler(4, 10);
+    for (int i = 0; i < 20; i++)
+        assert(run_frame(&scheduler, TICK) == 1);
+    assert(scheduler.shed_ticks == 0);
+}
+
+static void test_short_frames_accumulate(void) {
+    Scheduler scheduler = make_scheduler(4, 10);
+    int ticks = 0;
+    for (int i = 0; i < 8; i++)
+        ticks += run_frame(&scheduler, TICK / 2);
+    assert(ticks == 4);
+    assert(run_frame(&scheduler, 0.0) == 0);
+}
+
+static void test_idle_time(void) {
+    Scheduler scheduler = make_scheduler(4, 10);
+    run_frame(&scheduler, TICK / 4);
+    assert(scheduler_idle_time(&scheduler) == TICK * 3 / 4);
+
+    scheduler_begin_frame(&scheduler, 10 * TICK);
+    assert(scheduler_idle_time(&scheduler) == 0.0);
+}
+
+/* ────────────────────────────────────────────────────────────────────── */
+/*  catch-up                                                             */
+/* ────────────────────────────────────────────────────────────────────── */
+
+static void test_frame_runs_at_most_max_ticks(void) {
+    Scheduler scheduler = make_scheduler(2, 10);
+    assert(run_frame(&scheduler, 5 * TICK) == 2);
+    assert(scheduler_backlog(&scheduler) == 3);
+
+    /* The rest is spread over the following frames */
+    assert(run_frame(&scheduler, 0.0) == 2);
+    assert(run_frame(&scheduler, 0.0) == 1);
+    assert(scheduler_backlog(&scheduler) == 0);
+    assert(scheduler.shed_ticks == 0);
+}
+
+static void test_budget_stops_further_ticks(void) {
+    Scheduler scheduler = make_scheduler(4, 10);
+    scheduler_begin_frame(&scheduler, 3 * TICK);
+
+    /* The first tick runs even when the frame is already over budget */
+    assert(scheduler_next_tick(&scheduler, BUDGET * 2));
+    assert(!scheduler_next_tick(&scheduler, BUDGET));
+    assert(scheduler_next_tick(&scheduler, 0.0));
+    assert(scheduler_backlog(&scheduler) == 1);
+}
+
+static void test_backlog_beyond_limit_is_shed(void) {
+    Scheduler scheduler = make_scheduler(4, 10);
+    assert(scheduler_begin_frame(&scheduler, 100 * TICK) == 86);
+    assert(scheduler.shed_ticks == 86);
+    assert(scheduler_backlog(&scheduler) == 14);
+
+    int frames = 0;
+    while (scheduler_backlog(&scheduler) > 0) {
+        assert(run_frame(&scheduler, 0.0) <= 4);
+        frames++;
+    }
+    assert(frames == 4);
+}
+
+static void test_sustained_overload_slows_time(void) {
+    /* Every frame takes three ticks of wall time but may only run one */
+    Scheduler scheduler = make_scheduler(1, 2);
+    int ticks = 0;
+    for (int i = 0; i < 50; i++)
+        ticks += run_frame(&scheduler, 3 * TICK);
+    assert(ticks == 50);
+    assert(scheduler_backlog(&scheduler) <= 2);
+    assert(scheduler.shed_ticks == 150 - 50 - (Uint64)scheduler_backlog(&scheduler));
+}
+
+/* ────────────────────────────────────────────────────────────────────── */
+/*  edge cases                                                           */
+/* ────────────────────────────────────────────────────────────────────── */
+
+static void test_invalid_arguments(void) {
+    scheduler_initialize(NULL, TICK, 1, BUDGET, 0);
+    assert(scheduler_begin_frame(NULL, 1.0) == 0);
+    assert(!scheduler_next_tick(NULL, 0.0));
+    assert(scheduler_backlog(NULL) == 0);
+
+    Scheduler scheduler;
+    scheduler_initialize(&scheduler, 0.0, 4, BUDGET, 10);
+    assert(run_frame(&scheduler, 1.0) == 0);
+
+    /* Time never runs backwards */
+    scheduler = make_scheduler(4, 10);
+    assert(run_frame(&scheduler, -5.0) == 0);
+    assert(run_frame(&scheduler, TICK) == 1);
+}
+
+/* ── Runner ──────────────────────────────────────────────────────────── */
+
+int main(void) {
+    /* Steady state */
+    test_one_tick_per_tick_of_time();
+    test_short_frames_accumulate();
+    test_idle_time();
+
+    /* Catch-up */
+    test_frame_runs_at_most_max_ticks();
+    test_budget_stops_further_ticks();
+    test_backlog_beyond_limit_is_shed();
+    test_sustained_overload_slows_time();
+
+    /* Edge cases */
+    test_invalid_arguments();
+
+    return 0;
+}
@@ -0,0 +1,253 @@
+#include <assert.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "simulation/simulation.h"
+#include "simulation/simulation.c"
+#include "test_grid_helpers.h"
+
+/* ── Helpers ─────────────────────────────────────────────────────────── */
+
+/* Stands in for the texture: frames are applied to it the way simulation_render uploads them. */
+static SDL_Color texture[TEST_HEIGHT][TEST_WIDTH];
+
+static void apply_frame(const Simulation *simulation, const SimulationFrame *frame) {
+    const Grid *grid = &simulation->grid;
+    for (int i = 0; i < grid->chunks_x * grid->chunks_y; i++) {
+        GridRect rect = frame->paint[i];
+        for (int y = rect.min_y; y <= rect.max_y; y++) {
+            for (int x = rect.min_x; x <= rect.max_x; x++)
+                texture[y][x] = frame->colors[grid_index(grid, x, y)];
+        }
+    }
+}
+
+static bool texture_matches_grid(const Grid *grid) {
+    for (int y = 0; y < grid->height; y++) {
+        if (memcmp(texture[y], &grid->colors[grid_index(grid, 0, y)], sizeof(texture[y])) != 0)
+            return false;
+    }
+    return true;
+}
+
+static int painted_chunks(const Simulation *simulation, const SimulationFrame *frame) {
+    int count = 0;
+    for (int i = 0; i < simulation->grid.chunks_x * simulation->grid.chunks_y; i++)
+        count += !grid_rect_is_empty(frame->paint[i]);
+    return count;
+}
+
+static void place(Simulation *simulation, int x, int y, ParticleType type) {
+    assert(grid_place_particle(&simulation->grid, (Coordinates){x, y}, type));
+}
+
+/* ────────────────────────────────────────────────────────────────────── */
+/*  command queue                                                        */
+/* ────────────────────────────────────────────────────────────────────── */
+
+static void test_queue_keeps_order(void) {
+    static SimulationQueue queue;
+    JournalEvent event;
+    assert(!simulation_queue_pop(&queue, &event));
+
+    for (int i = 0; i < 5; i++)
+        assert(simulation_queue_push(&queue, &(JournalEvent){.kind = JOURNAL_EVENT_BRUSH, .radius = i}));
+    for (int i = 0; i < 5; i++) {
+        assert(simulation_queue_pop(&queue, &event));
+        assert(event.radius == i);
+    }
+    assert(!simulation_queue_pop(&queue, &event));
+}
+
+static void test_queue_full(void) {
+    static SimulationQueue queue;
+    JournalEvent event = {.kind = JOURNAL_EVENT_RESET};
+    for (int i = 0; i < SIMULATION_COMMAND_QUEUE_SIZE; i++)
+        assert(simulation_queue_push(&queue, &event));
+    assert(!simulation_queue_push(&queue, &event));
+
+    assert(simulation_queue_pop(&queue, &event));
+    assert(simulation_queue_push(&queue, &event));
+}
+
+static void test_queue_wraps(void) {
+    static SimulationQueue queue;
+    SDL_SetAtomicU32(&queue.head, 0xFFFFFFF0u);
+    SDL_SetAtomicU32(&queue.tail, 0xFFFFFFF0u);
+
+    JournalEvent event;
+    for (int i = 0; i < 40; i++) {
+        assert(simulation_queue_push(&queue, &(JournalEvent){.radius = i}));
+        assert(simulation_queue_pop(&queue, &event));
+        assert(event.radius == i);
+    }
+    assert(!simulation_queue_pop(&queue, &event));
+}
+
+static void test_commands_are_applied_and_stamped(void) {
+    static Simulation simulation;
+    assert(simulation_initialize(&simulation, TEST_WIDTH, TEST_HEIGHT));
+    grid_update(&simulation.grid);
+
+    assert(simulation_send(&simulation, &(JournalEvent){.kind = JOURNAL_EVENT_BRUSH, .center = {50, 20},
+                                                        .radius = 1, .type = ROCK}));
+    assert(grid_get_particle_type(&simulation.grid, (Coordinates){50, 20}) == EMPTY);
+    simulation_apply_commands(&simulation);
+    assert(grid_get_particle_type(&simulation.grid, (Coordinates){50, 20}) == ROCK);
+
+    JournalEvent event;
+    assert(!simulation_queue_pop(&simulation.queue, &event));
+    simulation_destroy(&simulation);
+}
+
+/* ────────────────────────────────────────────────────────────────────── */
+/*  frames                                                               */
+/* ────────────────────────────────────────────────────────────────────── */
+
+static void test_no_frame_before_publish(void) {
+    static Simulation simulation;
+    assert(simulation_initialize(&simulation, TEST_WIDTH, TEST_HEIGHT));
+    assert(simulation_take_frame(&simulation) == NULL);
+
+    simulation_publish(&simulation);
+    assert(simulation_take_frame(&simulation) != NULL);
+    assert(simulation_take_frame(&simulation) == NULL);
+    simulation_destroy(&simulation);
+}
+
+static void test_frame_paint_covers_changes_only(void) {
+    static Simulation simulation;
+    assert(simulation_initialize(&simulation, TEST_WIDTH, TEST_HEIGHT));
+    simulation_publish(&simulation);
+    const SimulationFrame *frame = simulation_take_frame(&simulation);
+    apply_frame(&simulation, frame);
+    assert(texture_matches_grid(&simulation.grid));
+
+    place(&simulation, 40, 40, SAND);
+    simulation_publish(&simulation);
+    frame = simulation_take_frame(&simulation);
+    assert(painted_chunks(&simulation, frame) == 1);
+    assert(!simulation.grid.dirty);
+
+    apply_frame(&simulation, frame);
+    assert(texture_matches_grid(&simulation.grid));
+    simulation_destroy(&simulation);
+}
+
+static void test_skipped_frames_carry_their_changes(void) {
+    static Simulation simulation;
+    assert(simulation_initialize(&simulation, TEST_WIDTH, TEST_HEIGHT));
+    simulation_publish(&simulation);
+    apply_frame(&simulation, simulation_take_frame(&simulation));
+
+    /* Two frames go by without the render thread looking */
+    place(&simulation, 5, 5, SAND);
+    simulation_publish(&simulation);
+    place(&simulation, TEST_WIDTH - 10, TEST_HEIGHT - 10, ROCK);
+    simulation_publish(&simulation);
+
+    const SimulationFrame *frame = simulation_take_frame(&simulation);
+    assert(painted_chunks(&simulation, frame) == 2);
+    apply_frame(&simulation, frame);
+    assert(texture_matches_grid(&simulation.grid));
+    simulation_destroy(&simulation);
+}
+
+static void test_taken_frames_stop_being_repainted(void) {
+    static Simulation simulation;
+    assert(simulation_initialize(&simulation, TEST_WIDTH, TEST_HEIGHT));
+    simulation_publish(&simulation);
+    apply_frame(&simulation, simulation_take_frame(&simulation));
+
+    place(&simulation, 5, 5, SAND);
+    simulation_publish(&simulation);
+    apply_frame(&simulation, simulation_take_frame(&simulation));
+
+    /* The (5, 5) frame was taken, so its changes aren't sent again */
+    place(&simulation, 60, 60, SAND);
+    simulation_publish(&simulation);
+    place(&simulation, 90, 10, SAND);
+    simulation_publish(&simulation);
+    const SimulationFrame *frame = simulation_take_frame(&simulation);
+    assert(painted_chunks(&simulation, frame) == 2);
+    assert(grid_rect_is_empty(frame->paint[0]));
+    apply_frame(&simulation, frame);
+    assert(texture_matches_grid(&simulation.grid));
+    simulation_destroy(&simulation);
+}
+
+static void test_texture_tracks_grid_under_any_schedule(void) {
+    static Simulation simulation;
+    assert(simulation_initialize(&simulation, TEST_WIDTH, TEST_HEIGHT));
+    grid_set_seed(&simulation.grid, 5);
+
+    Random schedule;
+    random_seed(&schedule, 77);
+    for (int step = 0; step < 400; step++) {
+        if (step % 3 == 0)
+            grid_apply_brush(&simulation.grid, (Coordinates){random_below(&schedule, TEST_WIDTH), 3}, 2, SAND);
+        grid_update(&simulation.grid);
+
+        if (random_below(&schedule, 3) != 0)
+            simulation_publish(&simulation);
+
+        const SimulationFrame *frame = random_below(&schedule, 3) == 0 ? simulation_take_frame(&simulation) : NULL;
+        if (frame) {
+            apply_frame(&simulation, frame);
+            if (!simulation.grid.dirty)
+                assert(texture_matches_grid(&simulation.grid));
+        }
+    }
+    simulation_destroy(&simulation);
+}
+
+/* ────────────────────────────────────────────────────────────────────── */
+/*  thread                                                               */
+/* ────────────────────────────────────────────────────────────────────── */
+
+static void test_thread_applies_commands_and_publishes(void) {
+    static Simulation simulation;
+    assert(simulation_initialize(&simulation, TEST_WIDTH, TEST_HEIGHT));
+    assert(simulation_start(&simulation));
+    assert(!simulation_start(&simulation));
+
+    assert(simulation_send(&simulation, &(JournalEvent){.kind = JOURNAL_EVENT_BRUSH, .center = {50, 69},
+                                                        .radius = 0, .type = ROCK}));
+
+    bool seen = false;
+    Uint64 deadline = SDL_GetTicks() + 2000;
+    while (!seen && SDL_GetTicks() < deadline) {
+        const SimulationFrame *frame = simulation_take_frame(&simulation);
+        if (frame)
+            apply_frame(&simulation, frame);
+        seen = memcmp(&texture[69][50], &texture[69][49], sizeof(SDL_Color)) != 0;
+        SDL_Delay(1);
+    }
+    assert(seen);
+
+    simulation_destroy(&simulation);
+    assert(simulation.thread == NULL);
+}
+
+/* ── Runner ──────────────────────────────────────────────────────────── */
+
+int main(void) {
+    /* Command queue */
+    test_queue_keeps_order();
+    test_queue_full();
+    test_queue_wraps();
+    test_commands_are_applied_and_stamped();
+
+    /* Frames */
+    test_no_frame_before_publish();
+    test_frame_paint_covers_changes_only();
+    test_skipped_frames_carry_their_changes();
+    test_taken_frames_stop_being_repainted();
+    test_texture_tracks_grid_under_any_schedule();
+
+    /* Thread */
+    test_thread_applies_commands_and_publishes();
+
+    return 0;
+}
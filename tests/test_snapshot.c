@@ -0,0 +1,394 @@
+#include <assert.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "config/color_config.h"
+#include "snapshot/snapshot.h"
+#include "snapshot/snapshot.c"
+#include "test_grid_helpers.h"
+
+/* ── Helpers ─────────────────────────────────────────────────────────── */
+
+#define TEST_SNAPSHOT_PATH "test_snapshot.fssn"
+
+static void write_bytes(const void *bytes, size_t size) {
+    FILE *file = fopen(TEST_SNAPSHOT_PATH, "wb");
+    assert(file);
+    assert(fwrite(bytes, 1, size, file) == size);
+    fclose(file);
+}
+
+static size_t read_bytes(Uint8 *bytes, size_t capacity) {
+    FILE *file = fopen(TEST_SNAPSHOT_PATH, "rb");
+    assert(file);
+    size_t size = fread(bytes, 1, capacity, file);
+    fclose(file);
+    return size;
+}
+
+/* A half-settled world: rock shelves and sand still falling onto them. */
+static void build_world(Grid *grid) {
+    assert(grid_initialize(grid, TEST_WIDTH, TEST_HEIGHT));
+    grid_set_seed(grid, 1234);
+    for (int x = 10; x < 60; x++)
+        grid_place_particle(grid, (Coordinates){x, 50}, ROCK);
+    for (int tick = 0; tick < 60; tick++) {
+        if (tick < 40)
+            grid_apply_brush(grid, (Coordinates){(tick * 13) % TEST_WIDTH, 4}, 3, SAND);
+        grid_update(grid);
+    }
+}
+
+/* Rewrites the saved file the way version 1 laid it out, with a gen stream after every chunk. */
+static void downgrade_to_version_1(const Grid *grid) {
+    static Uint8 bytes[1 << 16];
+    size_t size = read_bytes(bytes, sizeof(bytes));
+    assert(size < sizeof(bytes));
+
+    SnapshotBuffer buffer = {0};
+    int chunk_count = grid->chunks_x * grid->chunks_y;
+    size_t table_size = (size_t)chunk_count * SNAPSHOT_TABLE_ENTRY_SIZE;
+    snapshot_put_bytes(&buffer, bytes, SNAPSHOT_HEADER_SIZE + table_size);
+    snapshot_set_u32(buffer.data + 4, 1);
+    buffer.data[36] = 200; /* the old current gen */
+
+    for (int i = 0; i < chunk_count; i++) {
+        const Uint8 *entry = bytes + SNAPSHOT_HEADER_SIZE + (size_t)i * SNAPSHOT_TABLE_ENTRY_SIZE;
+        Uint64 offset = snapshot_get_u64(entry);
+        Uint32 chunk_size = snapshot_get_u32(entry + 8);
+        size_t moved_to = buffer.size;
+        snapshot_put_bytes(&buffer, bytes + offset, chunk_size);
+
+        GridRect bounds = snapshot_chunk_bounds(grid->width, grid->height, i % grid->chunks_x, i / grid->chunks_x);
+        Uint8 gens[SNAPSHOT_CHUNK_CELLS];
+        int occupied = 0;
+        for (int y = bounds.min_y; y <= bounds.max_y; y++) {
+            for (int x = bounds.min_x; x <= bounds.max_x; x++) {
+                if (grid->types[grid_index(grid, x, y)] != EMPTY)
+                    gens[occupied++] = (Uint8)(x + y);
+            }
+        }
+        snapshot_pack(&buffer, gens, occupied, 1);
+        assert(!buffer.failed);
+
+        Uint8 *moved = buffer.data + SNAPSHOT_HEADER_SIZE + (size_t)i * SNAPSHOT_TABLE_ENTRY_SIZE;
+        snapshot_set_u64(moved, moved_to);
+        snapshot_set_u32(moved + 8, (Uint32)(buffer.size - moved_to));
+    }
+
+    write_bytes(buffer.data, buffer.size);
+    SDL_free(buffer.data);
+}
+
+static void pack_round_trip(const Uint8 *elements, int count, int size) {
+    SnapshotBuffer buffer = {0};
+    snapshot_pack(&buffer, elements, count, size);
+    assert(!buffer.failed);
+
+    Uint8 unpacked[4096];
+    SnapshotReader reader = {.data = buffer.data, .size = buffer.size};
+    assert(snapshot_unpack(&reader, unpacked, count, size));
+    assert(reader.offset == buffer.size);
+    assert(memcmp(unpacked, elements, (size_t)(count * size)) == 0);
+    SDL_free(buffer.data);
+}
+
+/* ────────────────────────────────────────────────────────────────────── */
+/*  packing                                                              */
+/* ────────────────────────────────────────────────────────────────────── */
+
+static void test_pack_round_trip(void) {
+    Uint8 bytes[1024];
+
+    memset(bytes, 7, sizeof(bytes));
+    pack_round_trip(bytes, 1024, 1);
+
+    for (int i = 0; i < 1024; i++)
+        bytes[i] = (Uint8)(i * 31);
+    pack_round_trip(bytes, 1024, 1);
+
+    /* Runs of every length around the cut-off, between literals */
+    int n = 0;
+    for (int run = 1; run < 6; run++) {
+        for (int i = 0; i < run; i++)
+            bytes[n++] = (Uint8)run;
+        bytes[n++] = 200;
+        bytes[n++] = 201;
+    }
+    pack_round_trip(bytes, n, 1);
+    pack_round_trip(bytes, 1, 1);
+    pack_round_trip(bytes, 0, 1);
+
+    SDL_Color colors[256];
+    for (int i = 0; i < 256; i++)
+        colors[i] = i < 100 ? EMPTY_BASE_COLOR : (SDL_Color){(Uint8)i, 0, 0, 255};
+    pack_round_trip((const Uint8 *)colors, 256, (int)sizeof(SDL_Color));
+}
+
+static void test_pack_run_is_compact(void) {
+    Uint8 bytes[1024];
+    memset(bytes, EMPTY, sizeof(bytes));
+
+    SnapshotBuffer buffer = {0};
+    snapshot_pack(&buffer, bytes, 1024, 1);
+    assert(buffer.size == 3); /* two varint bytes and the element */
+    SDL_free(buffer.data);
+}
+
+static void test_unpack_rejects_bad_streams(void) {
+    Uint8 out[16];
+
+    /* Run longer than the cells left */
+    Uint8 overlong[] = {17 << 1, EMPTY};
+    SnapshotReader reader = {.data = overlong, .size = sizeof(overlong)};
+    assert(!snapshot_unpack(&reader, out, 16, 1));
+
+    /* Literal missing its last element */
+    Uint8 truncated[] = {3 << 1 | 1, 1, 2};
+    reader = (SnapshotReader){.data = truncated, .size = sizeof(truncated)};
+    assert(!snapshot_unpack(&reader, out, 3, 1));
+
+    /* Zero-length token */
+    Uint8 zero[] = {0, EMPTY};
+    reader = (SnapshotReader){.data = zero, .size = sizeof(zero)};
+    assert(!snapshot_unpack(&reader, out, 1, 1));
+
+    /* Stream ends early */
+    Uint8 short_stream[] = {4 << 1, EMPTY};
+    reader = (SnapshotReader){.data = short_stream, .size = sizeof(short_stream)};
+    assert(!snapshot_unpack(&reader, out, 8, 1));
+}
+
+/* ────────────────────────────────────────────────────────────────────── */
+/*  save / load                                                          */
+/* ────────────────────────────────────────────────────────────────────── */
+
+static void test_round_trip(void) {
+    Grid saved, loaded;
+    build_world(&saved);
+    assert(snapshot_save(&saved, TEST_SNAPSHOT_PATH));
+
+    Snapshot snapshot;
+    assert(snapshot_open(&snapshot, TEST_SNAPSHOT_PATH));
+    assert(snapshot.header.width == TEST_WIDTH && snapshot.header.height == TEST_HEIGHT);
+    assert(snapshot.header.seed == 1234);
+    assert(snapshot.header.tick_count == saved.tick_count);
+
+    assert(grid_initialize(&loaded, TEST_WIDTH, TEST_HEIGHT));
+    assert(snapshot_load(&snapshot, &loaded, NULL));
+    snapshot_close(&snapshot);
+    assert(snapshot.data == NULL);
+
+    assert(grids_equal(&saved, &loaded));
+    assert(loaded.seed == saved.seed);
+    assert(loaded.tick_count == saved.tick_count);
+    assert(loaded.update_left_to_right == saved.update_left_to_right);
+    assert(memcmp(&loaded.random, &saved.random, sizeof(Random)) == 0);
+    assert(loaded.dirty);
+
+    grid_destroy(&saved);
+    grid_destroy(&loaded);
+}
+
+static void test_loaded_world_continues_the_run(void) {
+    Grid saved, loaded;
+    build_world(&saved);
+    assert(snapshot_save(&saved, TEST_SNAPSHOT_PATH));
+
+    Snapshot snapshot;
+    assert(snapshot_open(&snapshot, TEST_SNAPSHOT_PATH));
+    assert(grid_initialize(&loaded, TEST_WIDTH, TEST_HEIGHT));
+    assert(snapshot_load(&snapshot, &loaded, NULL));
+    snapshot_close(&snapshot);
+
+    for (int tick = 0; tick < 120; tick++) {
+        if (tick == 30) {
+            grid_apply_brush(&saved, (Coordinates){50, 10}, 4, SAND);
+            grid_apply_brush(&loaded, (Coordinates){50, 10}, 4, SAND);
+        }
+        grid_update(&saved);
+        grid_update(&loaded);
+    }
+    assert(grids_equal(&saved, &loaded));
+
+    grid_destroy(&saved);
+    grid_destroy(&loaded);
+}
+
+static void test_load_on_worker_pool(void) {
+    Grid saved, loaded;
+    WorkerPool workers;
+    build_world(&saved);
+    assert(snapshot_save(&saved, TEST_SNAPSHOT_PATH));
+    assert(workers_initialize(&workers, 3));
+
+    Snapshot snapshot;
+    assert(snapshot_open(&snapshot, TEST_SNAPSHOT_PATH));
+    assert(grid_initialize(&loaded, TEST_WIDTH, TEST_HEIGHT));
+    assert(snapshot_load(&snapshot, &loaded, &workers));
+    snapshot_close(&snapshot);
+    assert(grids_equal(&saved, &loaded));
+
+    workers_destroy(&workers);
+    grid_destroy(&saved);
+    grid_destroy(&loaded);
+}
+
+static void test_empty_world_is_small(void) {
+    Grid grid;
+    assert(grid_initialize(&grid, TEST_WIDTH, TEST_HEIGHT));
+    assert(snapshot_save(&grid, TEST_SNAPSHOT_PATH));
+
+    /* Each chunk is one type run and one color run */
+    Uint8 bytes[4096];
+    size_t size = read_bytes(bytes, sizeof(bytes));
+    int chunks = grid.chunks_x * grid.chunks_y;
+    assert(size <= SNAPSHOT_HEADER_SIZE + (size_t)chunks * (SNAPSHOT_TABLE_ENTRY_SIZE + 3 + 6));
+
+    grid_destroy(&grid);
+}
+
+/* Chunks are packed on their own, so one decodes without the others. */
+static void test_decode_single_chunk(void) {
+    Grid saved, loaded;
+    build_world(&saved);
+    assert(snapshot_save(&saved, TEST_SNAPSHOT_PATH));
+
+    Snapshot snapshot;
+    assert(snapshot_open(&snapshot, TEST_SNAPSHOT_PATH));
+    assert(grid_initialize(&loaded, TEST_WIDTH, TEST_HEIGHT));
+    assert(snapshot_decode_chunk(&snapshot, &loaded, 1, 1));
+    snapshot_close(&snapshot);
+
+    for (int y = 0; y < TEST_HEIGHT; y++) {
+        for (int x = 0; x < TEST_WIDTH; x++) {
+            Coordinates at = {x, y};
+            bool in_chunk = x / GRID_CHUNK_SIZE == 1 && y / GRID_CHUNK_SIZE == 1;
+            ParticleType expected = in_chunk ? grid_get_particle_type(&saved, at) : EMPTY;
+            assert(grid_get_particle_type(&loaded, at) == expected);
+        }
+    }
+
+    grid_destroy(&saved);
+    grid_destroy(&loaded);
+}
+
+static void test_load_rejects_other_size(void) {
+    Grid saved, other;
+    build_world(&saved);
+    assert(snapshot_save(&saved, TEST_SNAPSHOT_PATH));
+
+    Snapshot snapshot;
+    assert(snapshot_open(&snapshot, TEST_SNAPSHOT_PATH));
+    assert(grid_initialize(&other, TEST_WIDTH + 1, TEST_HEIGHT));
+    assert(!snapshot_load(&snapshot, &other, NULL));
+    snapshot_close(&snapshot);
+
+    grid_destroy(&saved);
+    grid_destroy(&other);
+}
+
+static void test_load_version_1(void) {
+    Grid saved, loaded;
+    build_world(&saved);
+    assert(snapshot_save(&saved, TEST_SNAPSHOT_PATH));
+    downgrade_to_version_1(&saved);
+
+    Snapshot snapshot;
+    assert(snapshot_open(&snapshot, TEST_SNAPSHOT_PATH));
+    assert(snapshot.version == 1);
+    assert(grid_initialize(&loaded, TEST_WIDTH, TEST_HEIGHT));
+    assert(snapshot_load(&snapshot, &loaded, NULL));
+    snapshot_close(&snapshot);
+    assert(grids_equal(&saved, &loaded));
+    assert(loaded.tick_count == saved.tick_count);
+
+    /* Versions newer than this build are still refused */
+    assert(snapshot_save(&saved, TEST_SNAPSHOT_PATH));
+    static Uint8 bytes[1 << 16];
+    size_t size = read_bytes(bytes, sizeof(bytes));
+    snapshot_set_u32(bytes + 4, SNAPSHOT_VERSION + 1);
+    write_bytes(bytes, size);
+    assert(!snapshot_open(&snapshot, TEST_SNAPSHOT_PATH));
+
+    grid_destroy(&saved);
+    grid_destroy(&loaded);
+}
+
+/* ────────────────────────────────────────────────────────────────────── */
+/*  damaged files                                                        */
+/* ────────────────────────────────────────────────────────────────────── */
+
+static void test_open_rejects_bad_files(void) {
+    Snapshot snapshot;
+    assert(!snapshot_open(&snapshot, "does/not/exist.fssn"));
+
+    write_bytes("NOPE\1\0\0\0", 8);
+    assert(!snapshot_open(&snapshot, TEST_SNAPSHOT_PATH));
+    assert(snapshot.data == NULL);
+
+    assert(!snapshot_open(NULL, TEST_SNAPSHOT_PATH));
+}
+
+static void test_open_rejects_truncated_file(void) {
+    Grid grid;
+    build_world(&grid);
+    assert(snapshot_save(&grid, TEST_SNAPSHOT_PATH));
+
+    static Uint8 bytes[1 << 16];
+    size_t size = read_bytes(bytes, sizeof(bytes));
+    assert(size < sizeof(bytes));
+    write_bytes(bytes, size - 1);
+
+    Snapshot snapshot;
+    assert(!snapshot_open(&snapshot, TEST_SNAPSHOT_PATH));
+
+    grid_destroy(&grid);
+}
+
+static void test_load_rejects_corrupt_chunk(void) {
+    Grid grid;
+    assert(grid_initialize(&grid, TEST_WIDTH, TEST_HEIGHT));
+    assert(snapshot_save(&grid, TEST_SNAPSHOT_PATH));
+
+    /* Turn the first chunk's type run into a run of border cells */
+    static Uint8 bytes[1 << 16];
+    size_t size = read_bytes(bytes, sizeof(bytes));
+    Uint64 offset = snapshot_get_u64(bytes + SNAPSHOT_HEADER_SIZE);
+    bytes[offset + 2] = GRID_BORDER_TYPE;
+    write_bytes(bytes, size);
+
+    Snapshot snapshot;
+    assert(snapshot_open(&snapshot, TEST_SNAPSHOT_PATH));
+    assert(!snapshot_load(&snapshot, &grid, NULL));
+    snapshot_close(&snapshot);
+
+    grid_destroy(&grid);
+}
+
+/* ── Runner ──────────────────────────────────────────────────────────── */
+
+int main(void) {
+    /* Packing */
+    test_pack_round_trip();
+    test_pack_run_is_compact();
+    test_unpack_rejects_bad_streams();
+
+    /* Save / load */
+    test_round_trip();
+    test_loaded_world_continues_the_run();
+    test_load_on_worker_pool();
+    test_empty_world_is_small();
+    test_decode_single_chunk();
+    test_load_rejects_other_size();
+    test_load_version_1();
+
+    /* Damaged files */
+    test_open_rejects_bad_files();
+    test_open_rejects_truncated_file();
+    test_load_rejects_corrupt_chunk();
+
+    remove(TEST_SNAPSHOT_PATH);
+    return 0;
+}
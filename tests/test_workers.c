@@ -0,0 +1,143 @@
+#include <assert.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "workers/workers.h"
+#include "workers/workers.c"
+
+/* ── Job fixtures ────────────────────────────────────────────────────── */
+
+#define JOB_COUNT 1000
+
+typedef struct JobState {
+    SDL_AtomicInt runs[JOB_COUNT];
+    SDL_AtomicInt total;
+} JobState;
+
+static JobState job_state;
+
+static void reset_job_state(void) {
+    memset(&job_state, 0, sizeof(job_state));
+}
+
+static void count_job(void *data, int index) {
+    assert(data == &job_state);
+    SDL_AddAtomicInt(&job_state.runs[index], 1);
+    SDL_AddAtomicInt(&job_state.total, 1);
+}
+
+static void assert_each_index_ran_once(int count) {
+    assert(SDL_GetAtomicInt(&job_state.total) == count);
+    for (int i = 0; i < count; i++)
+        assert(SDL_GetAtomicInt(&job_state.runs[i]) == 1);
+}
+
+/* ────────────────────────────────────────────────────────────────────── */
+/*  workers_initialize / workers_destroy                                 */
+/* ────────────────────────────────────────────────────────────────────── */
+
+static void test_initialize_null(void) {
+    assert(!workers_initialize(NULL, 2));
+}
+
+static void test_initialize_rejects_bad_count(void) {
+    WorkerPool pool;
+    assert(!workers_initialize(&pool, -1));
+    assert(!workers_initialize(&pool, WORKERS_MAX_THREADS + 1));
+}
+
+static void test_initialize_without_threads(void) {
+    WorkerPool pool;
+    assert(workers_initialize(&pool, 0));
+    assert(pool.thread_count == 0);
+    assert(pool.mutex == NULL);
+    workers_destroy(&pool);
+}
+
+static void test_initialize_with_threads(void) {
+    WorkerPool pool;
+    assert(workers_initialize(&pool, 3));
+    assert(pool.thread_count == 3);
+    workers_destroy(&pool);
+    assert(pool.thread_count == 0);
+    assert(pool.mutex == NULL);
+}
+
+static void test_destroy_null(void) {
+    workers_destroy(NULL);
+    /* Should not crash */
+}
+
+/* ────────────────────────────────────────────────────────────────────── */
+/*  workers_run                                                          */
+/* ────────────────────────────────────────────────────────────────────── */
+
+static void test_run_null_pool_runs_inline(void) {
+    reset_job_state();
+    workers_run(NULL, count_job, &job_state, 10);
+    assert_each_index_ran_once(10);
+}
+
+static void test_run_without_threads(void) {
+    WorkerPool pool;
+    workers_initialize(&pool, 0);
+    reset_job_state();
+
+    workers_run(&pool, count_job, &job_state, JOB_COUNT);
+    assert_each_index_ran_once(JOB_COUNT);
+    workers_destroy(&pool);
+}
+
+static void test_run_with_threads(void) {
+    WorkerPool pool;
+    workers_initialize(&pool, 4);
+    reset_job_state();
+
+    workers_run(&pool, count_job, &job_state, JOB_COUNT);
+    assert_each_index_ran_once(JOB_COUNT);
+    workers_destroy(&pool);
+}
+
+static void test_run_repeated_batches(void) {
+    WorkerPool pool;
+    workers_initialize(&pool, 4);
+
+    for (int batch = 1; batch <= 50; batch++) {
+        reset_job_state();
+        workers_run(&pool, count_job, &job_state, batch);
+        assert_each_index_ran_once(batch);
+    }
+    workers_destroy(&pool);
+}
+
+static void test_run_empty_batch(void) {
+    WorkerPool pool;
+    workers_initialize(&pool, 2);
+    reset_job_state();
+
+    workers_run(&pool, count_job, &job_state, 0);
+    workers_run(&pool, NULL, &job_state, 10);
+    assert(SDL_GetAtomicInt(&job_state.total) == 0);
+    workers_destroy(&pool);
+}
+
+/* ── Runner ──────────────────────────────────────────────────────────── */
+
+int main(void) {
+    /* Initialize / Destroy */
+    test_initialize_null();
+    test_initialize_rejects_bad_count();
+    test_initialize_without_threads();
+    test_initialize_with_threads();
+    test_destroy_null();
+
+    /* Run */
+    test_run_null_pool_runs_inline();
+    test_run_without_threads();
+    test_run_with_threads();
+    test_run_repeated_batches();
+    test_run_empty_batch();
+
+    return 0;
+}